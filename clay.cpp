@@ -0,0 +1,372 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file clay.cpp
+* @brief Clay (coupled-layer) minimum-storage regenerating code over GF(2^8)
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "clay.h"
+#include <string.h>
+
+/*
+ * Node j of the grid has coordinates (x, y) = (j % q, j / q). Layer z has base-q digits z_0...z_(t-1).
+ * In layer z, node (x, y) is unpaired if z_y = x. Otherwise it is paired with node (z_y, y) in layer z',
+ * where z' is z with digit y replaced by x. For a pair the uncoupled and coupled symbols are related by
+ * U = C + gamma*C', U' = gamma*C + C'
+ * and unpaired symbols are simply U = C.
+ * Grid nodes are: real data nodes, virtual (zero) data nodes, real parity nodes.
+ */
+
+/**
+ * @brief Calculate number of virtual nodes needed to fill the grid
+ * @param k Number of data shards
+ * @param m Number of parity shards
+ * @return Number of virtual nodes
+ */
+static uint8_t clayVirtual(uint8_t k, uint8_t m)
+{
+    if(m < 2)
+        return 0;
+    uint16_t n = (uint16_t)k + m;
+    return (uint8_t)((m - (n % m)) % m);
+}
+
+uint8_t ClayCode::digit(uint32_t z, uint8_t y)
+{
+    return (uint8_t)((z / power[y]) % q);
+}
+
+uint32_t ClayCode::replaceDigit(uint32_t z, uint8_t y, uint8_t x)
+{
+    return z - digit(z, y) * power[y] + x * power[y];
+}
+
+int16_t ClayCode::toInternal(uint8_t node)
+{
+    if(node >= ((uint16_t)k + m))
+        return -1;
+    if(node < k)
+        return node;
+    return node + s; //parity nodes come after virtual nodes
+}
+
+/**
+ * @brief Calculate parity shards
+ * @param **data k data shards
+ * @param **parity m output parity shards
+ * @param len Shard length in bytes, must be a multiple of sub-packetization
+ */
+void ClayCode::encode(const uint8_t * const *data, uint8_t * const *parity, size_t len)
+{
+    if(k == 0)
+        return;
+
+    //encoding is just decoding of all parity shards
+    uint16_t n = (uint16_t)k + m;
+    std::vector<uint8_t*> shards(n);
+    std::vector<uint8_t> erased(n, 0);
+    for(uint8_t i = 0; i < k; i++)
+        shards[i] = const_cast<uint8_t*>(data[i]); //data shards are never written to
+    for(uint8_t i = 0; i < m; i++)
+    {
+        shards[k + i] = parity[i];
+        erased[k + i] = 1;
+    }
+    decode(shards.data(), erased.data(), len);
+}
+
+/**
+ * @brief Rebuild erased shards
+ * @param **shards All k+m shards, erased shards are overwritten
+ * @param *erased Erasure flags of all k+m shards, non-zero if shard is erased
+ * @param len Shard length in bytes, must be a multiple of sub-packetization
+ * @return 0 on success, 1 if more than m shards are erased
+ */
+uint8_t ClayCode::decode(uint8_t * const *shards, const uint8_t *erased, size_t len)
+{
+    if((k == 0) || (len % alpha))
+        return 1;
+
+    uint16_t nodes = (uint16_t)q * t;
+    size_t subLen = len / alpha;
+
+    std::vector<uint8_t> zero(s ? len : 0, 0);
+    std::vector<uint8_t*> c(nodes); //coupled symbols of every node
+    std::vector<int16_t> lostIndex(nodes, -1);
+    std::vector<uint8_t> lost;
+    for(uint8_t j = k; j < (k + s); j++)
+        c[j] = zero.data();
+    for(uint16_t i = 0; i < ((uint16_t)k + m); i++)
+    {
+        int16_t j = toInternal((uint8_t)i);
+        c[j] = shards[i];
+        if(erased[i])
+        {
+            lostIndex[j] = (int16_t)lost.size();
+            lost.push_back((uint8_t)j);
+        }
+    }
+    if(lost.size() > m)
+        return 1;
+    if(lost.empty())
+        return 0;
+
+    //layers are decoded in order of intersection score: the number of erased nodes that are unpaired in a layer
+    //then every erased node paired with a known node depends only on layers with lower score
+    std::vector<std::vector<uint32_t>> order(lost.size() + 1);
+    for(uint32_t z = 0; z < alpha; z++)
+    {
+        uint8_t score = 0;
+        for(size_t e = 0; e < lost.size(); e++)
+        {
+            if(digit(z, lost[e] / q) == (lost[e] % q))
+                score++;
+        }
+        order[score].push_back(z);
+    }
+
+    std::vector<uint8_t> u(lost.size() * len); //uncoupled symbols of erased nodes
+    std::vector<uint8_t> layer(nodes * subLen); //uncoupled symbols of known nodes in current layer
+    std::vector<const uint8_t*> ptr(nodes);
+    std::vector<uint8_t*> out(lost.size());
+    uint8_t pairInv = gf.inv(1 ^ gf.mul(CLAY_GAMMA, CLAY_GAMMA)); //1/(1+gamma^2)
+
+    for(size_t score = 0; score < order.size(); score++)
+    {
+        //find uncoupled symbols of known nodes and decode uncoupled symbols of erased nodes
+        for(size_t l = 0; l < order[score].size(); l++)
+        {
+            uint32_t z = order[score][l];
+            for(uint16_t j = 0; j < nodes; j++)
+            {
+                if(lostIndex[j] >= 0)
+                {
+                    ptr[j] = nullptr;
+                    continue;
+                }
+                uint8_t x = j % q, y = j / q;
+                uint8_t zy = digit(z, y);
+                if(zy == x)
+                {
+                    ptr[j] = c[j] + z * subLen;
+                    continue;
+                }
+                //partner symbol is known or already decoded, as its layer has a lower score
+                uint8_t *uj = &layer[j * subLen];
+                memcpy(uj, c[j] + z * subLen, subLen);
+                gf.mulAddRegion(CLAY_GAMMA, c[zy + y * q] + replaceDigit(z, y, x) * subLen, uj, subLen);
+                ptr[j] = uj;
+            }
+            for(size_t e = 0; e < lost.size(); e++)
+                out[e] = &u[e * len + z * subLen];
+            mds.decode(ptr.data(), lost.data(), (uint8_t)lost.size(), out.data(), 0, subLen);
+        }
+        //find coupled symbols of erased nodes
+        for(size_t l = 0; l < order[score].size(); l++)
+        {
+            uint32_t z = order[score][l];
+            for(size_t e = 0; e < lost.size(); e++)
+            {
+                uint8_t j = lost[e];
+                uint8_t x = j % q, y = j / q;
+                uint8_t zy = digit(z, y);
+                uint8_t *cj = c[j] + z * subLen;
+                const uint8_t *uj = &u[e * len + z * subLen];
+                memcpy(cj, uj, subLen);
+                if(zy == x)
+                    continue; //C = U
+                uint16_t p = zy + y * q;
+                uint32_t zp = replaceDigit(z, y, x);
+                if(lostIndex[p] < 0)
+                {
+                    //C = U + gamma*C'
+                    gf.mulAddRegion(CLAY_GAMMA, c[p] + zp * subLen, cj, subLen);
+                }
+                else
+                {
+                    //both nodes of the pair are erased, C = (U + gamma*U')/(1+gamma^2)
+                    gf.mulAddRegion(CLAY_GAMMA, &u[lostIndex[p] * len + zp * subLen], cj, subLen);
+                    gf.mulRegion(pairInv, cj, cj, subLen);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Get sub-chunks that every helper must provide to repair a node
+ * @param failed Failed shard number
+ * @param *layers Output list of alpha/q sub-chunk numbers
+ * @return Number of sub-chunks
+ */
+uint32_t ClayCode::repairLayers(uint8_t failed, uint32_t *layers)
+{
+    int16_t f = toInternal(failed);
+    if((k == 0) || (f < 0))
+        return 0;
+
+    //only layers in which the failed node is unpaired are needed
+    uint32_t count = 0;
+    for(uint32_t z = 0; z < alpha; z++)
+    {
+        if(digit(z, f / q) == (f % q))
+            layers[count++] = z;
+    }
+    return count;
+}
+
+/**
+ * @brief Repair single shard with reduced bandwidth
+ * @param failed Failed shard number
+ * @param **shards All k+m shards, the failed one is ignored
+ * @param *out Output buffer for the repaired shard
+ * @param len Shard length in bytes, must be a multiple of sub-packetization
+ * @return 0 on success
+ */
+uint8_t ClayCode::repair(uint8_t failed, const uint8_t * const *shards, uint8_t *out, size_t len)
+{
+    int16_t f = toInternal(failed);
+    if((k == 0) || (f < 0) || (len % alpha))
+        return 1;
+
+    uint16_t nodes = (uint16_t)q * t;
+    size_t subLen = len / alpha;
+    uint8_t x0 = f % q, y0 = f / q;
+
+    std::vector<uint8_t> zero(s ? len : 0, 0);
+    std::vector<const uint8_t*> c(nodes);
+    for(uint8_t j = k; j < (k + s); j++)
+        c[j] = zero.data();
+    for(uint16_t i = 0; i < ((uint16_t)k + m); i++)
+        c[toInternal((uint8_t)i)] = shards[i];
+
+    //in repair layers the whole column of the failed node is treated as erased, which leaves exactly k+s known nodes
+    std::vector<uint8_t> column(q);
+    for(uint8_t x = 0; x < q; x++)
+        column[x] = x + y0 * q;
+    std::vector<uint8_t> layer(nodes * subLen);
+    std::vector<uint8_t> u(q * subLen);
+    std::vector<const uint8_t*> ptr(nodes);
+    std::vector<uint8_t*> uOut(q);
+    for(uint8_t x = 0; x < q; x++)
+        uOut[x] = &u[x * subLen];
+    uint8_t gammaInv = gf.inv(CLAY_GAMMA);
+
+    for(uint32_t z = 0; z < alpha; z++)
+    {
+        if(digit(z, y0) != x0)
+            continue;
+        for(uint16_t j = 0; j < nodes; j++)
+        {
+            uint8_t x = j % q, y = j / q;
+            if(y == y0)
+            {
+                ptr[j] = nullptr;
+                continue;
+            }
+            uint8_t zy = digit(z, y);
+            if(zy == x)
+            {
+                ptr[j] = c[j] + z * subLen;
+                continue;
+            }
+            //partner layer has the same digit y0, so it is a repair layer too
+            uint8_t *uj = &layer[j * subLen];
+            memcpy(uj, c[j] + z * subLen, subLen);
+            gf.mulAddRegion(CLAY_GAMMA, c[zy + y * q] + replaceDigit(z, y, x) * subLen, uj, subLen);
+            ptr[j] = uj;
+        }
+        if(mds.decode(ptr.data(), column.data(), q, uOut.data(), 0, subLen))
+            return 1;
+
+        //failed node is unpaired in this layer, so C = U
+        memcpy(out + z * subLen, uOut[x0], subLen);
+        //other nodes in the column are paired with the failed node: U_h = C_h + gamma*C_f, so C_f = (U_h + C_h)/gamma
+        for(uint8_t x = 0; x < q; x++)
+        {
+            if(x == x0)
+                continue;
+            uint8_t *cf = out + replaceDigit(z, y0, x) * subLen;
+            memcpy(cf, uOut[x], subLen);
+            gf.mulAddRegion(1, c[column[x]] + z * subLen, cf, subLen);
+            gf.mulRegion(gammaInv, cf, cf, subLen);
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Get sub-packetization level
+ * @return Number of sub-chunks per shard (alpha)
+ */
+uint32_t ClayCode::getSubPacketization(void)
+{
+    return alpha;
+}
+
+/**
+ * @brief Check if object is initialized
+ * @return 0 if initialized
+ */
+uint8_t ClayCode::isInitialized(void)
+{
+    if(k)
+        return 0;
+
+    return 1;
+}
+
+/**
+ * @brief Initializes Clay code
+ * @param &gf GF(2^8) object, copied
+ * @param k Number of data shards
+ * @param m Number of parity shards, at least 2
+ */
+ClayCode::ClayCode(const GF2 &gf, uint8_t k, uint8_t m) : gf(gf), mds(gf, (uint8_t)(k + clayVirtual(k, m)), m)
+{
+    this->k = 0;
+    this->m = 0;
+    q = 0;
+    t = 0;
+    s = 0;
+    alpha = 0;
+
+    uint8_t v = clayVirtual(k, m);
+    if((k == 0) || (m < 2) || (((uint16_t)k + m + v) > 256) || mds.isInitialized())
+        return;
+
+    q = m;
+    t = (uint8_t)(((uint16_t)k + m + v) / q);
+    power.resize(t + 1);
+    power[0] = 1;
+    for(uint8_t y = 0; y < t; y++)
+    {
+        if(((uint64_t)power[y] * q) > CLAY_MAX_ALPHA)
+            return; //sub-packetization too high
+        power[y + 1] = power[y] * q;
+    }
+
+    alpha = power[t];
+    s = v;
+    this->k = k;
+    this->m = m;
+}
@@ -0,0 +1,125 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file clay.h
+* @brief Clay (coupled-layer) minimum-storage regenerating code over GF(2^8)
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef CLAY_H
+#define CLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "gf2.h"
+#include "ec.h"
+
+#define CLAY_GAMMA 2 //coupling coefficient, must not be 0 or 1
+#define CLAY_MAX_ALPHA 65536 //maximum sub-packetization level
+
+/**
+ * @brief This class provides Clay code, a k+m MDS code with optimal repair bandwidth (d = k+m-1 helpers)
+ *
+ * Nodes are arranged in a q x t grid, where q = m and t = ceil((k+m)/q). Missing grid positions are filled with
+ * virtual data nodes containing zeros. Every shard is divided into alpha = q^t sub-chunks (layers).
+ * Each layer of uncoupled symbols U is a codeword of an ordinary k+m Reed-Solomon code (ErasureCode),
+ * and stored symbols C are obtained from U by pairwise coupling transforms between layers.
+ * A failed node is repaired using only alpha/q sub-chunks of every other node,
+ * that is (k+m-1)/m shards in total instead of k shards.
+ */
+class ClayCode
+{
+public:
+	/**
+	 * @brief Calculate parity shards
+	 * @param **data k data shards
+	 * @param **parity m output parity shards
+	 * @param len Shard length in bytes, must be a multiple of sub-packetization
+	 */
+	void encode(const uint8_t * const *data, uint8_t * const *parity, size_t len);
+
+	/**
+	 * @brief Rebuild erased shards
+	 * @param **shards All k+m shards, erased shards are overwritten
+	 * @param *erased Erasure flags of all k+m shards, non-zero if shard is erased
+	 * @param len Shard length in bytes, must be a multiple of sub-packetization
+	 * @return 0 on success, 1 if more than m shards are erased
+	 */
+	uint8_t decode(uint8_t * const *shards, const uint8_t *erased, size_t len);
+
+	/**
+	 * @brief Get sub-chunks that every helper must provide to repair a node
+	 * @param failed Failed shard number
+	 * @param *layers Output list of alpha/q sub-chunk numbers
+	 * @return Number of sub-chunks
+	 * Sub-chunk z occupies bytes z*len/alpha...(z+1)*len/alpha-1 of a shard.
+	 */
+	uint32_t repairLayers(uint8_t failed, uint32_t *layers);
+
+	/**
+	 * @brief Repair single shard with reduced bandwidth
+	 * @param failed Failed shard number
+	 * @param **shards All k+m shards, the failed one is ignored
+	 * @param *out Output buffer for the repaired shard
+	 * @param len Shard length in bytes, must be a multiple of sub-packetization
+	 * @return 0 on success
+	 * Only the sub-chunks returned by repairLayers() are read from other shards.
+	 */
+	uint8_t repair(uint8_t failed, const uint8_t * const *shards, uint8_t *out, size_t len);
+
+	/**
+	 * @brief Get sub-packetization level
+	 * @return Number of sub-chunks per shard (alpha)
+	 */
+	uint32_t getSubPacketization(void);
+
+	/**
+	 * @brief Check if object is initialized
+	 * @return 0 if initialized
+	 */
+	uint8_t isInitialized(void);
+
+	/**
+	 * @brief Initializes Clay code
+	 * @param &gf GF(2^8) object, copied
+	 * @param k Number of data shards
+	 * @param m Number of parity shards, at least 2
+	 * Sub-packetization grows as m^ceil((k+m)/m), so very small m with large k is impractical.
+	 */
+	ClayCode(const GF2 &gf, uint8_t k, uint8_t m);
+
+private:
+	GF2 gf; //field object
+	ErasureCode mds; //layer code over the whole grid
+	uint8_t k; //number of data shards, 0 if not initialized
+	uint8_t m; //number of parity shards
+	uint8_t q; //grid height, q = m
+	uint8_t t; //grid width
+	uint8_t s; //number of virtual (zero) data nodes
+	uint32_t alpha; //sub-packetization level, q^t
+	std::vector<uint32_t> power; //q^y for y = 0...t
+
+	uint8_t digit(uint32_t z, uint8_t y); //y-th base-q digit of layer number
+	uint32_t replaceDigit(uint32_t z, uint8_t y, uint8_t x); //set y-th base-q digit of layer number
+	int16_t toInternal(uint8_t node); //real shard number to grid node number
+};
+
+#endif
@@ -0,0 +1,425 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file crc.cpp
+* @brief Generic CRC engine for any GF(2) polynomial up to degree 64
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "crc.h"
+
+#if defined(__PCLMUL__) && defined(__SSSE3__)
+#include <immintrin.h>
+#define CRC_FOLDING
+#endif
+
+/**
+ * @brief Reflect bits in every byte of a 64-bit word
+ * @param x Input word
+ * @return Word with reflected bytes
+ */
+static inline uint64_t reflectBytes(uint64_t x)
+{
+    x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    return x;
+}
+
+/**
+ * @brief Reflect lowest bits of a word
+ * @param x Input word
+ * @param bits Number of bits to reflect
+ * @return Reflected value
+ */
+static inline uint64_t reflect(uint64_t x, uint8_t bits)
+{
+    uint64_t ret = 0;
+    for(uint8_t i = 0; i < bits; i++)
+    {
+        ret = (ret << 1) | (x & 1);
+        x >>= 1;
+    }
+    return ret;
+}
+
+/**
+ * @brief Load 64-bit big endian word
+ * @param *p Input data
+ * @return Loaded word
+ */
+static inline uint64_t loadBE64(const uint8_t *p)
+{
+    uint64_t ret = 0;
+    for(uint8_t i = 0; i < 8; i++)
+        ret = (ret << 8) | p[i];
+    return ret;
+}
+
+/**
+ * @brief Slow (no lookup table) multiplication modulo CRC polynomial
+ * @param x Multiplicand
+ * @param y Multiplier
+ * @return x*y mod P
+ */
+uint64_t CRC::mulMod(uint64_t x, uint64_t y)
+{
+    uint64_t ret = 0;
+    //same as GF2::slowMul(), but starting from the highest multiplier bit
+    for(int8_t i = width - 1; i >= 0; i--)
+    {
+        uint64_t carry = (ret >> (width - 1)) & 1;
+        ret = (ret << 1) & mask;
+        if(carry)
+            ret ^= poly; //apply modular reduction
+        if((y >> i) & 1)
+            ret ^= x;
+    }
+    return ret;
+}
+
+/**
+ * @brief Calculate x^n mod P using square-and-multiply
+ * @param n Exponent
+ * @return x^n mod P
+ */
+uint64_t CRC::xPowMod(uint64_t n)
+{
+    uint64_t base = (width > 1) ? 2 : poly; //x mod P, which is just x unless P is of degree 1
+    uint64_t ret = 1;
+    while(n)
+    {
+        if(n & 1)
+            ret = mulMod(ret, base);
+        base = mulMod(base, base);
+        n >>= 1;
+    }
+    return ret;
+}
+
+/**
+ * @brief Calculate x^(8n) mod P using square-and-multiply
+ * @param n Exponent in bytes
+ * @return x^(8n) mod P
+ */
+uint64_t CRC::x8PowMod(uint64_t n)
+{
+    uint64_t base = xPowMod(8);
+    uint64_t ret = 1;
+    while(n)
+    {
+        if(n & 1)
+            ret = mulMod(ret, base);
+        base = mulMod(base, base);
+        n >>= 1;
+    }
+    return ret;
+}
+
+/**
+ * @brief Convert final CRC value to the MSB-aligned register
+ * @param crc CRC value
+ * @return Register value
+ */
+uint64_t CRC::toRegister(uint64_t crc)
+{
+    crc = (crc ^ xorOut) & mask;
+    if(refOut)
+        crc = reflect(crc, width);
+    return crc << (64 - width);
+}
+
+/**
+ * @brief Convert MSB-aligned register to the final CRC value
+ * @param reg Register value
+ * @return CRC value
+ */
+uint64_t CRC::fromRegister(uint64_t reg)
+{
+    reg >>= (64 - width);
+    if(refOut)
+        reg = reflect(reg, width);
+    return (reg ^ xorOut) & mask;
+}
+
+/**
+ * @brief Multiply register by x^64 modulo P using slicing tables
+ * @param reg Register value (MSB-aligned)
+ * @return reg*x^64 mod P (MSB-aligned)
+ */
+uint64_t CRC::step(uint64_t reg)
+{
+    const uint64_t *t = table.data();
+    return t[7 * 256 + (reg >> 56)] ^ t[6 * 256 + ((reg >> 48) & 0xFF)]
+         ^ t[5 * 256 + ((reg >> 40) & 0xFF)] ^ t[4 * 256 + ((reg >> 32) & 0xFF)]
+         ^ t[3 * 256 + ((reg >> 24) & 0xFF)] ^ t[2 * 256 + ((reg >> 16) & 0xFF)]
+         ^ t[1 * 256 + ((reg >> 8) & 0xFF)] ^ t[reg & 0xFF];
+}
+
+#ifdef CRC_FOLDING
+/**
+ * @brief Load 16 bytes as a 128-bit polynomial, with the first byte being the most significant
+ * @param *p Input data
+ * @param refIn Reflect input bytes
+ * @return Loaded polynomial
+ */
+static inline __m128i loadFold(const uint8_t *p, bool refIn)
+{
+    const __m128i swap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m128i x = _mm_loadu_si128((const __m128i*)p);
+    if(refIn)
+    {
+        //reverse bits in every byte using nibble lookup
+        const __m128i low = _mm_set_epi8(0xF0, 0x70, 0xB0, 0x30, 0xD0, 0x50, 0x90, 0x10, 0xE0, 0x60, 0xA0, 0x20, 0xC0, 0x40, 0x80, 0x00);
+        const __m128i high = _mm_set_epi8(0x0F, 0x07, 0x0B, 0x03, 0x0D, 0x05, 0x09, 0x01, 0x0E, 0x06, 0x0A, 0x02, 0x0C, 0x04, 0x08, 0x00);
+        const __m128i nibble = _mm_set1_epi8(0x0F);
+        x = _mm_or_si128(_mm_shuffle_epi8(low, _mm_and_si128(x, nibble)),
+                         _mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi16(x, 4), nibble)));
+    }
+    return _mm_shuffle_epi8(x, swap);
+}
+
+/**
+ * @brief Fold 128-bit polynomial by a given distance
+ * @param x Polynomial
+ * @param k Folding constants (high: x^(d+64) mod P, low: x^d mod P)
+ * @return Folded polynomial
+ */
+static inline __m128i foldBy(__m128i x, __m128i k)
+{
+    return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x11), _mm_clmulepi64_si128(x, k, 0x00));
+}
+#endif
+
+/**
+ * @brief Process 64-byte blocks using carry-less multiplication
+ * @param reg Register value (MSB-aligned)
+ * @param *data Input data
+ * @param blocks Number of 64-byte blocks, at least 1
+ * @return New register value
+ *
+ * The message is kept as four independent 128-bit polynomials, which are multiplied by x^512 mod P
+ * and added to the next 64 bytes in every iteration. Finally they are folded into one polynomial and reduced
+ * using slicing tables.
+ */
+uint64_t CRC::fold(uint64_t reg, const uint8_t *data, size_t blocks)
+{
+#ifdef CRC_FOLDING
+    const __m128i k1 = _mm_set_epi64x((long long)fold1[0], (long long)fold1[1]);
+    const __m128i k4 = _mm_set_epi64x((long long)fold4[0], (long long)fold4[1]);
+
+    __m128i x0 = _mm_xor_si128(loadFold(data, refIn), _mm_set_epi64x((long long)reg, 0)); //register is added to the first 8 bytes
+    __m128i x1 = loadFold(data + 16, refIn);
+    __m128i x2 = loadFold(data + 32, refIn);
+    __m128i x3 = loadFold(data + 48, refIn);
+    data += 64;
+
+    for(size_t i = 1; i < blocks; i++)
+    {
+        x0 = _mm_xor_si128(foldBy(x0, k4), loadFold(data, refIn));
+        x1 = _mm_xor_si128(foldBy(x1, k4), loadFold(data + 16, refIn));
+        x2 = _mm_xor_si128(foldBy(x2, k4), loadFold(data + 32, refIn));
+        x3 = _mm_xor_si128(foldBy(x3, k4), loadFold(data + 48, refIn));
+        data += 64;
+    }
+
+    //fold all four polynomials into one
+    x1 = _mm_xor_si128(x1, foldBy(x0, k1));
+    x2 = _mm_xor_si128(x2, foldBy(x1, k1));
+    x3 = _mm_xor_si128(x3, foldBy(x2, k1));
+
+    uint64_t hi = (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(x3, x3)); //SSE2 only, _mm_extract_epi64 would need SSE4.1
+    uint64_t lo = (uint64_t)_mm_cvtsi128_si64(x3);
+    //(hi*x^64+lo)*x^64 mod P
+    return step(step(hi) ^ lo);
+#else
+    return process(reg, data, blocks * 64);
+#endif
+}
+
+/**
+ * @brief Process data using slicing tables
+ * @param reg Register value (MSB-aligned)
+ * @param *data Input data
+ * @param len Data length in bytes
+ * @return New register value
+ */
+uint64_t CRC::process(uint64_t reg, const uint8_t *data, size_t len)
+{
+#ifdef CRC_FOLDING
+    if(len >= 128)
+    {
+        reg = fold(reg, data, len / 64);
+        data += len & ~(size_t)63;
+        len &= 63;
+    }
+#endif
+    while(len >= 8)
+    {
+        uint64_t x = loadBE64(data);
+        if(refIn)
+            x = reflectBytes(x);
+        reg = step(reg ^ x);
+        data += 8;
+        len -= 8;
+    }
+    while(len--)
+    {
+        uint64_t x = *data++;
+        if(refIn)
+            x = reflectBytes(x);
+        reg ^= x << 56;
+        reg = (reg << 8) ^ table[reg >> 56];
+    }
+    return reg;
+}
+
+/**
+ * @brief Calculate CRC of a buffer
+ * @param *data Input data
+ * @param len Data length in bytes
+ * @return CRC value
+ */
+uint64_t CRC::compute(const uint8_t *data, size_t len)
+{
+    if(width == 0)
+        return 0;
+    return fromRegister(process(init << (64 - width), data, len));
+}
+
+/**
+ * @brief Continue CRC calculation with another buffer
+ * @param crc CRC of the preceding data (use compute(nullptr, 0) to start)
+ * @param *data Input data
+ * @param len Data length in bytes
+ * @return CRC of the preceding data followed by this buffer
+ */
+uint64_t CRC::update(uint64_t crc, const uint8_t *data, size_t len)
+{
+    if(width == 0)
+        return 0;
+    return fromRegister(process(toRegister(crc), data, len));
+}
+
+/**
+ * @brief Combine CRCs of two consecutive chunks
+ * @param crc1 CRC of the first chunk
+ * @param crc2 CRC of the second chunk
+ * @param len2 Length of the second chunk in bytes
+ * @return CRC of both chunks concatenated
+ */
+uint64_t CRC::combine(uint64_t crc1, uint64_t crc2, uint64_t len2)
+{
+    if(width == 0)
+        return 0;
+    //the register after both chunks is reg1*x^(8*len2) + CRC of the second chunk with zero initial value
+    //and the register after the second chunk alone is init*x^(8*len2) + the same value, so:
+    uint64_t reg1 = (toRegister(crc1) >> (64 - width)) ^ init;
+    uint64_t reg2 = toRegister(crc2) >> (64 - width);
+    reg2 ^= mulMod(reg1, x8PowMod(len2));
+    return fromRegister(reg2 << (64 - width));
+}
+
+/**
+ * @brief Shift CRC by a number of zero bytes
+ * @param crc CRC of some data
+ * @param len Number of zero bytes appended to the data
+ * @return CRC of the data followed by len zero bytes
+ */
+uint64_t CRC::shift(uint64_t crc, uint64_t len)
+{
+    if(width == 0)
+        return 0;
+    uint64_t reg = toRegister(crc) >> (64 - width);
+    reg = mulMod(reg, x8PowMod(len));
+    return fromRegister(reg << (64 - width));
+}
+
+/**
+ * @brief Check if object is initialized
+ * @return 0 if initialized
+ */
+uint8_t CRC::isInitialized(void)
+{
+    if(width)
+        return 0;
+
+    return 1;
+}
+
+/**
+ * @brief Initializes CRC object
+ * @param width CRC width (polynomial degree), 1 to 64
+ * @param poly Generator polynomial without the x^width term
+ * @param init Initial register value
+ * @param refIn Reflect input bytes
+ * @param refOut Reflect the final register value
+ * @param xorOut Value XORed with the final register value
+ */
+CRC::CRC(uint8_t width, uint64_t poly, uint64_t init, bool refIn, bool refOut, uint64_t xorOut)
+{
+    this->width = 0;
+    fold1[0] = fold1[1] = 0;
+    fold4[0] = fold4[1] = 0;
+
+    if((width == 0) || (width > 64))
+        return; //unsupported width
+
+    mask = (width == 64) ? ~(uint64_t)0 : (((uint64_t)1 << width) - 1);
+    this->width = width;
+    this->poly = poly & mask;
+    this->init = init & mask;
+    this->refIn = refIn;
+    this->refOut = refOut;
+    this->xorOut = xorOut & mask;
+    //the register is kept aligned to the MSB, so that all widths can be processed in the same way
+    //this is equivalent to computing modulo P*x^(64-width), which leaves the CRC in the highest bits
+    poly64 = this->poly << (64 - width);
+
+    table.resize(8 * 256);
+    //first table: byte*x^64 mod P, calculated bit by bit
+    for(uint16_t i = 0; i < 256; i++)
+    {
+        uint64_t x = (uint64_t)i << 56;
+        for(uint8_t k = 0; k < 8; k++)
+        {
+            if(x >> 63)
+                x = (x << 1) ^ poly64;
+            else
+                x <<= 1;
+        }
+        table[i] = x;
+    }
+    //next tables: byte*x^(64+8j) mod P, each obtained by multiplying the previous one by x^8
+    for(uint8_t j = 1; j < 8; j++)
+    {
+        for(uint16_t i = 0; i < 256; i++)
+        {
+            uint64_t x = table[(j - 1) * 256 + i];
+            table[j * 256 + i] = (x << 8) ^ table[x >> 56];
+        }
+    }
+
+    //folding constants, x^n mod P*x^(64-width) = x^(64-width)*(x^(n-64+width) mod P)
+    fold1[0] = xPowMod(192 - 64 + width) << (64 - width);
+    fold1[1] = xPowMod(128 - 64 + width) << (64 - width);
+    fold4[0] = xPowMod(576 - 64 + width) << (64 - width);
+    fold4[1] = xPowMod(512 - 64 + width) << (64 - width);
+}
@@ -0,0 +1,125 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file crc.h
+* @brief Generic CRC engine for any GF(2) polynomial up to degree 64
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef CRC_H
+#define CRC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+//some commonly used CRC polynomials (normal representation, without the x^width term)
+#define CRC32_POLY 0x04C11DB7 //CRC-32 (Ethernet, zlib), width 32
+#define CRC32C_POLY 0x1EDC6F41 //CRC-32C (Castagnoli), width 32
+#define CRC64_ECMA_POLY 0x42F0E1EBA9EA3693ULL //CRC-64/ECMA-182 and CRC-64/XZ, width 64
+
+/**
+ * @brief This class provides CRC calculation for any polynomial of a degree 1 to 64
+ *
+ * The CRC is a remainder of the message polynomial division in GF(2)[x], so it is calculated in the same way
+ * as the reduction in GF2::slowMul(), just with a bigger polynomial. Parameters follow the common Rocksoft model
+ * (width, poly, init, refIn, refOut, xorOut).
+ * Data is processed with slicing-by-8 lookup tables or, when carry-less multiplication is available (PCLMULQDQ),
+ * by folding 64 bytes per iteration with precomputed x^n mod P constants.
+ */
+class CRC
+{
+public:
+	/**
+	 * @brief Calculate CRC of a buffer
+	 * @param *data Input data
+	 * @param len Data length in bytes
+	 * @return CRC value
+	 */
+	uint64_t compute(const uint8_t *data, size_t len);
+
+	/**
+	 * @brief Continue CRC calculation with another buffer
+	 * @param crc CRC of the preceding data (use compute(nullptr, 0) to start)
+	 * @param *data Input data
+	 * @param len Data length in bytes
+	 * @return CRC of the preceding data followed by this buffer
+	 */
+	uint64_t update(uint64_t crc, const uint8_t *data, size_t len);
+
+	/**
+	 * @brief Combine CRCs of two consecutive chunks
+	 * @param crc1 CRC of the first chunk
+	 * @param crc2 CRC of the second chunk
+	 * @param len2 Length of the second chunk in bytes
+	 * @return CRC of both chunks concatenated
+	 * This allows for calculating CRCs of chunks in parallel and merging them afterwards.
+	 */
+	uint64_t combine(uint64_t crc1, uint64_t crc2, uint64_t len2);
+
+	/**
+	 * @brief Shift CRC by a number of zero bytes
+	 * @param crc CRC of some data
+	 * @param len Number of zero bytes appended to the data
+	 * @return CRC of the data followed by len zero bytes
+	 */
+	uint64_t shift(uint64_t crc, uint64_t len);
+
+	/**
+	 * @brief Check if object is initialized
+	 * @return 0 if initialized
+	 */
+	uint8_t isInitialized(void);
+
+	/**
+	 * @brief Initializes CRC object
+	 * @param width CRC width (polynomial degree), 1 to 64
+	 * @param poly Generator polynomial without the x^width term
+	 * @param init Initial register value
+	 * @param refIn Reflect input bytes
+	 * @param refOut Reflect the final register value
+	 * @param xorOut Value XORed with the final register value
+	 */
+	CRC(uint8_t width, uint64_t poly, uint64_t init = 0, bool refIn = false, bool refOut = false, uint64_t xorOut = 0);
+
+private:
+	uint8_t width; //CRC width, 0 if not initialized
+	uint64_t poly; //generator polynomial without the x^width term
+	uint64_t init; //initial register value
+	bool refIn; //input reflection
+	bool refOut; //output reflection
+	uint64_t xorOut; //final XOR value
+	uint64_t mask; //width-bit mask
+	uint64_t poly64; //polynomial aligned to the MSB of 64-bit register
+	std::vector<uint64_t> table; //slicing-by-8 lookup tables, 8x256 entries
+	uint64_t fold1[2]; //x^192 mod P and x^128 mod P constants for folding by 128 bits (MSB-aligned)
+	uint64_t fold4[2]; //x^576 mod P and x^512 mod P constants for folding by 512 bits (MSB-aligned)
+
+	uint64_t mulMod(uint64_t x, uint64_t y); //x*y mod P
+	uint64_t xPowMod(uint64_t n); //x^n mod P
+	uint64_t x8PowMod(uint64_t n); //x^(8n) mod P
+	uint64_t toRegister(uint64_t crc); //convert final CRC value to the MSB-aligned register
+	uint64_t fromRegister(uint64_t reg); //convert MSB-aligned register to the final CRC value
+	uint64_t step(uint64_t reg); //reg*x^64 mod P using slicing tables
+	uint64_t process(uint64_t reg, const uint8_t *data, size_t len); //process data with the MSB-aligned register
+	uint64_t fold(uint64_t reg, const uint8_t *data, size_t blocks); //process 64-byte blocks using carry-less multiplication
+};
+
+#endif
@@ -0,0 +1,681 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file ec.cpp
+* @brief Systematic Reed-Solomon erasure code over GF(2^8)
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "ec.h"
+#include <string.h>
+#include "transpose.h"
+#include "gfstruct.h"
+
+/**
+ * @brief Invert n x n matrix in place using Gauss-Jordan elimination
+ * @param *a Row-major matrix
+ * @param n Matrix size
+ * @return 0 on success, 1 if matrix is singular
+ */
+uint8_t ErasureCode::invert(uint8_t *a, uint8_t n)
+{
+    std::vector<uint8_t> b(n * n, 0); //inverse, starting from identity matrix
+    for(uint8_t i = 0; i < n; i++)
+        b[i * n + i] = 1;
+
+    for(uint8_t col = 0; col < n; col++)
+    {
+        //find pivot
+        uint8_t pivot = col;
+        while((pivot < n) && (a[pivot * n + col] == 0))
+            pivot++;
+        if(pivot == n)
+            return 1; //singular matrix
+        if(pivot != col)
+        {
+            for(uint8_t j = 0; j < n; j++)
+            {
+                uint8_t t = a[col * n + j];
+                a[col * n + j] = a[pivot * n + j];
+                a[pivot * n + j] = t;
+                t = b[col * n + j];
+                b[col * n + j] = b[pivot * n + j];
+                b[pivot * n + j] = t;
+            }
+        }
+        //normalize pivot row
+        uint8_t c = gf.inv(a[col * n + col]);
+        for(uint8_t j = 0; j < n; j++)
+        {
+            a[col * n + j] = gf.mul(a[col * n + j], c);
+            b[col * n + j] = gf.mul(b[col * n + j], c);
+        }
+        //eliminate column from other rows
+        for(uint8_t i = 0; i < n; i++)
+        {
+            uint8_t f = a[i * n + col];
+            if((i == col) || (f == 0))
+                continue;
+            for(uint8_t j = 0; j < n; j++)
+            {
+                a[i * n + j] ^= gf.mul(f, a[col * n + j]);
+                b[i * n + j] ^= gf.mul(f, b[col * n + j]);
+            }
+        }
+    }
+    for(uint16_t i = 0; i < (uint16_t)(n * n); i++)
+        a[i] = b[i];
+    return 0;
+}
+
+/**
+ * @brief Calculate parity shards
+ * @param **data k data shards
+ * @param **parity m output parity shards
+ * @param len Shard length in bytes
+ */
+void ErasureCode::encode(const uint8_t * const *data, uint8_t * const *parity, size_t len)
+{
+    if(k == 0)
+        return;
+
+    std::vector<const uint8_t*> src(k);
+    for(size_t offset = 0; offset < len; offset += EC_CHUNK)
+    {
+        size_t l = ((len - offset) < EC_CHUNK) ? (len - offset) : EC_CHUNK;
+        for(uint8_t j = 0; j < k; j++)
+            src[j] = data[j] + offset;
+        for(uint8_t i = 0; i < m; i++)
+            GF2::dotRegion(&tables[i * k * 32], src.data(), k, parity[i] + offset, l);
+    }
+}
+
+/**
+ * @brief Calculate parity of byte-interleaved codewords
+ * @param *codewords len codewords of k+m bytes each, data bytes first. Parity bytes are filled in
+ * @param len Number of codewords
+ */
+void ErasureCode::encodeInterleaved(uint8_t *codewords, size_t len)
+{
+    if(k == 0)
+        return;
+
+    uint16_t n = k + m;
+    std::vector<uint8_t> shards(n * EC_STRIDE);
+    std::vector<const uint8_t*> src(k);
+    for(uint8_t j = 0; j < k; j++)
+        src[j] = &shards[j * EC_STRIDE];
+    for(size_t offset = 0; offset < len; offset += EC_CHUNK)
+    {
+        size_t l = ((len - offset) < EC_CHUNK) ? (len - offset) : EC_CHUNK;
+        uint8_t *c = codewords + offset * n;
+        //data columns to data shards, then parity shards back to parity columns
+        Transpose::bytes(c, n, shards.data(), EC_STRIDE, l, k);
+        for(uint8_t i = 0; i < m; i++)
+            GF2::dotRegion(&tables[i * k * 32], src.data(), k, &shards[(k + i) * EC_STRIDE], l);
+        Transpose::bytes(&shards[k * EC_STRIDE], EC_STRIDE, c + k, n, m, l);
+    }
+}
+
+/**
+ * @brief Rebuild erased positions of byte-interleaved codewords
+ * @param *codewords len codewords of k+m bytes each. Erased bytes are overwritten
+ * @param *erased Erasure flags of all k+m positions, the same for every codeword
+ * @param len Number of codewords
+ * @return 0 on success, 1 if more than m positions are erased
+ */
+uint8_t ErasureCode::decodeInterleaved(uint8_t *codewords, const uint8_t *erased, size_t len)
+{
+    if(k == 0)
+        return 1;
+
+    uint16_t n = k + m;
+    std::vector<uint8_t> present(n), missing;
+    for(uint16_t i = 0; i < n; i++)
+    {
+        present[i] = !erased[i];
+        if(erased[i])
+            missing.push_back((uint8_t)i);
+    }
+    if(missing.empty())
+        return 0;
+
+    //the decoding matrix is the same for every chunk
+    uint8_t count = (uint8_t)missing.size();
+    std::vector<uint8_t> sources(k), coefficients(count * k);
+    if(decodeMatrix(present.data(), missing.data(), count, sources.data(), coefficients.data()))
+        return 1;
+    std::vector<uint8_t> t(count * k * 32);
+    for(uint16_t i = 0; i < (count * k); i++)
+        gf.regionTable(coefficients[i], &t[i * 32]);
+
+    std::vector<uint8_t> shards(n * EC_STRIDE);
+    std::vector<const uint8_t*> src(k);
+    for(uint8_t j = 0; j < k; j++)
+        src[j] = &shards[sources[j] * EC_STRIDE];
+    for(size_t offset = 0; offset < len; offset += EC_CHUNK)
+    {
+        size_t l = ((len - offset) < EC_CHUNK) ? (len - offset) : EC_CHUNK;
+        uint8_t *c = codewords + offset * n;
+        Transpose::bytes(c, n, shards.data(), EC_STRIDE, l, n);
+        for(uint8_t i = 0; i < count; i++)
+            GF2::dotRegion(&t[i * k * 32], src.data(), k, &shards[missing[i] * EC_STRIDE], l);
+        //present shards are unchanged, so writing all of them back keeps the transposition in full tiles
+        Transpose::bytes(shards.data(), EC_STRIDE, c, n, n, l);
+    }
+    return 0;
+}
+
+/**
+ * @brief Verify parity shards without storing anything
+ * @param **data k data shards
+ * @param **parity m parity shards
+ * @param len Shard length in bytes
+ * @param *failed Output list of failing column ranges, aligned to blocks. If nullptr, verification stops at the first failing block
+ * @param blockSize Verification block size in bytes
+ * @return 0 if all parity shards are consistent with data
+ */
+uint8_t ErasureCode::verify(const uint8_t * const *data, const uint8_t * const *parity, size_t len, std::vector<ECRange> *failed, size_t blockSize)
+{
+    if((k == 0) || (blockSize == 0))
+        return 1;
+
+    uint8_t ret = 0;
+    std::vector<const uint8_t*> src(k);
+    for(size_t offset = 0; offset < len; offset += blockSize)
+    {
+        size_t l = ((len - offset) < blockSize) ? (len - offset) : blockSize;
+        for(uint8_t j = 0; j < k; j++)
+            src[j] = data[j] + offset;
+        //the block is bad if any parity row does not match, there is no need to check the remaining rows
+        uint8_t i = 0;
+        while((i < m) && (GF2::dotCheck(&tables[i * k * 32], src.data(), k, parity[i] + offset, l) == 0))
+            i++;
+        if(i == m)
+            continue;
+
+        ret = 1;
+        if(failed == nullptr)
+            return ret; //only pass/fail result requested
+        if(!failed->empty() && ((failed->back().offset + failed->back().length) == offset))
+            failed->back().length += l; //merge with previous range
+        else
+        {
+            ECRange r;
+            r.offset = offset;
+            r.length = l;
+            failed->push_back(r);
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief Calculate decoding coefficients using the structure of the parity matrix
+ * @param *sources k indexes of available shards used for decoding
+ * @param *wanted Indexes of shards to be rebuilt
+ * @param count Number of wanted shards
+ * @param *coefficients Output count x k matrix, the same as in decodeMatrix()
+ * @return 0 on success, 1 if structured decoding failed and general elimination must be used
+ */
+uint8_t ErasureCode::structuredDecode(const uint8_t *sources, const uint8_t *wanted, uint8_t count, uint8_t *coefficients)
+{
+    if(type == EC_VANDERMONDE)
+    {
+        //the generator matrix is W * T^(-1), where W is the (k+m) x k Vandermonde matrix w_ij = i^j and T is its top part
+        //so shard x = w_x * W_s^(-1) * sources, where W_s are the rows of sources
+        //row c_x solves the transposed Vandermonde system W_s^T * c_x^T = w_x^T, so c_xj = L_j(x), Lagrange basis at x
+        //with barycentric weights calculated once in O(k^2), every wanted shard takes only O(k)
+        std::vector<uint8_t> w(k);
+        if(StructuredMatrix::barycentricWeights(gf, sources, k, w.data()))
+            return 1;
+        for(uint8_t i = 0; i < count; i++)
+        {
+            uint8_t *c = &coefficients[i * k];
+            uint8_t x = wanted[i];
+            uint8_t l = 1; //l(x) = product of (x - s_j)
+            uint8_t j;
+            for(j = 0; j < k; j++)
+            {
+                if(sources[j] == x)
+                    break;
+                l = gf.mul(l, x ^ sources[j]);
+            }
+            memset(c, 0, k);
+            if(j < k)
+            {
+                c[j] = 1; //wanted shard is one of the sources
+                continue;
+            }
+            for(j = 0; j < k; j++)
+                c[j] = gf.div(gf.mul(w[j], l), x ^ sources[j]);
+        }
+        return 0;
+    }
+    else if((type == EC_CAUCHY) && (k >= EC_CAUCHY_STRUCTURED_MIN))
+    {
+        //only the e erased data shards are unknown and the e parity sources give e equations:
+        //parity_q = sum of C[q][l]*data_l over present data shards + M * erased data, where M = C[parity sources][erased]
+        //M is a Cauchy matrix itself, so its closed-form inverse gives the erased data in O(e^2 * k)
+        std::vector<uint8_t> position(k, 0xFF); //position of data shard within sources
+        std::vector<uint8_t> x, y, erased;
+        for(uint8_t j = 0; j < k; j++)
+        {
+            if(sources[j] < k)
+                position[sources[j]] = j;
+            else
+                x.push_back(sources[j] - k);
+        }
+        for(uint8_t j = 0; j < k; j++)
+        {
+            if(position[j] == 0xFF)
+            {
+                erased.push_back(j);
+                y.push_back(m + j);
+            }
+        }
+        uint8_t e = erased.size();
+        uint8_t first = k - e; //parity sources follow data sources
+        std::vector<uint8_t> minv(e * e);
+        if(e && StructuredMatrix::cauchyInverse(gf, x.data(), y.data(), e, minv.data()))
+            return 1;
+
+        //coefficient rows of erased data shards: M^(-1) on parity sources and M^(-1) * C[parity sources][present data] on data sources
+        std::vector<uint8_t> part(e * first);
+        for(uint8_t q = 0; q < e; q++)
+        {
+            for(uint8_t j = 0; j < first; j++)
+                part[q * first + j] = matrix[x[q] * k + sources[j]];
+        }
+        std::vector<uint8_t> rows(e * k, 0);
+        for(uint8_t a = 0; a < e; a++)
+        {
+            uint8_t *r = &rows[a * k];
+            for(uint8_t q = 0; q < e; q++)
+            {
+                uint8_t f = minv[a * e + q];
+                r[first + q] = f;
+                gf.mulAddRegion(f, &part[q * first], r, first);
+            }
+        }
+
+        std::vector<uint8_t> slot(k, 0xFF); //row of erased data shard
+        for(uint8_t a = 0; a < e; a++)
+            slot[erased[a]] = a;
+        for(uint8_t i = 0; i < count; i++)
+        {
+            uint8_t *c = &coefficients[i * k];
+            memset(c, 0, k);
+            uint8_t w = wanted[i];
+            if(w < k)
+            {
+                if(position[w] != 0xFF)
+                    c[position[w]] = 1;
+                else
+                    memcpy(c, &rows[slot[w] * k], k);
+                continue;
+            }
+            const uint8_t *g = &matrix[(w - k) * k];
+            for(uint8_t j = 0; j < k; j++)
+            {
+                if(position[j] != 0xFF)
+                    c[position[j]] ^= g[j];
+                else
+                {
+                    for(uint8_t l = 0; l < k; l++)
+                        c[l] ^= gf.mul(g[j], rows[slot[j] * k + l]);
+                }
+            }
+        }
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Calculate decoding coefficients for chosen shards
+ * @param *present Presence flags of all k+m shards, non-zero if shard is available
+ * @param *wanted Indexes of shards to be rebuilt (0...k-1 for data shards, k...k+m-1 for parity shards)
+ * @param count Number of wanted shards
+ * @param *sources Output k indexes of available shards used for decoding
+ * @param *coefficients Output count x k matrix, wanted shard i = sum of coefficients[i*k+j]*shard sources[j]
+ * @return 0 on success, 1 if there are less than k shards available or a wanted index is out of range
+ */
+uint8_t ErasureCode::decodeMatrix(const uint8_t *present, const uint8_t *wanted, uint8_t count, uint8_t *sources, uint8_t *coefficients)
+{
+    if(k == 0)
+        return 1;
+    for(uint8_t i = 0; i < count; i++)
+    {
+        if(wanted[i] >= ((uint16_t)k + m))
+            return 1; //no such shard, its generator row would be read past the parity matrix
+    }
+
+    //choose k available shards, data shards first, as their generator rows are trivial
+    uint8_t s = 0;
+    for(uint16_t i = 0; (i < ((uint16_t)k + m)) && (s < k); i++)
+    {
+        if(present[i])
+            sources[s++] = (uint8_t)i;
+    }
+    if(s < k)
+        return 1; //not enough shards
+
+    if(structuredDecode(sources, wanted, count, coefficients) == 0)
+        return 0;
+
+    //general path
+    //shard x = g_x * data, where g_x is x-th row of the generator matrix (identity on top of the parity matrix)
+    //sources = A * data, so shard x = g_x * A^(-1) * sources
+    //row c_x = g_x * A^(-1) is the solution of A^T * c_x^T = g_x^T, so only these rows are calculated
+    //by reducing [A^T | g_x^T for every wanted x] to the reduced row echelon form
+    uint16_t width = k + count;
+    std::vector<uint8_t> a(k * width);
+    for(uint8_t i = 0; i < k; i++)
+    {
+        for(uint8_t j = 0; j < k; j++)
+        {
+            //A^T[i][j] = A[j][i] = g_sources[j][i]
+            uint8_t x = sources[j];
+            a[i * width + j] = (x < k) ? (x == i) : matrix[(x - k) * k + i];
+        }
+        for(uint8_t j = 0; j < count; j++)
+        {
+            uint8_t x = wanted[j];
+            a[i * width + k + j] = (x < k) ? (x == i) : matrix[(x - k) * k + i];
+        }
+    }
+
+    for(uint8_t col = 0; col < k; col++)
+    {
+        uint8_t pivot = col;
+        while((pivot < k) && (a[pivot * width + col] == 0))
+            pivot++;
+        if(pivot == k)
+            return 1; //should never happen for an MDS code
+        if(pivot != col)
+        {
+            for(uint16_t j = 0; j < width; j++)
+            {
+                uint8_t t = a[col * width + j];
+                a[col * width + j] = a[pivot * width + j];
+                a[pivot * width + j] = t;
+            }
+        }
+        uint8_t c = gf.inv(a[col * width + col]);
+        for(uint16_t j = col; j < width; j++)
+            a[col * width + j] = gf.mul(a[col * width + j], c);
+        for(uint8_t i = 0; i < k; i++)
+        {
+            uint8_t f = a[i * width + col];
+            if((i == col) || (f == 0))
+                continue;
+            for(uint16_t j = col; j < width; j++)
+                a[i * width + j] ^= gf.mul(f, a[col * width + j]);
+        }
+    }
+
+    for(uint8_t i = 0; i < count; i++)
+    {
+        for(uint8_t j = 0; j < k; j++)
+            coefficients[i * k + j] = a[j * width + k + i];
+    }
+    return 0;
+}
+
+/**
+ * @brief Rebuild a byte range of chosen shards
+ * @param **shards All k+m shards, nullptr for missing shards
+ * @param *wanted Indexes of shards to be rebuilt
+ * @param count Number of wanted shards
+ * @param **out Output buffers for wanted shards, len bytes each
+ * @param offset First column (byte offset within shard)
+ * @param len Number of columns
+ * @return 0 on success, 1 if there are less than k shards available
+ */
+uint8_t ErasureCode::decode(const uint8_t * const *shards, const uint8_t *wanted, uint8_t count, uint8_t * const *out, size_t offset, size_t len)
+{
+    if(k == 0)
+        return 1;
+
+    uint16_t n = k + m;
+    std::vector<uint8_t> present(n);
+    for(uint16_t i = 0; i < n; i++)
+        present[i] = (shards[i] != nullptr);
+
+    //available shards are just copied, the rest is decoded
+    std::vector<uint8_t> missing;
+    std::vector<uint8_t*> missingOut;
+    for(uint8_t i = 0; i < count; i++)
+    {
+        if(wanted[i] >= n)
+            return 1;
+        if(present[wanted[i]])
+            memcpy(out[i], shards[wanted[i]] + offset, len);
+        else
+        {
+            missing.push_back(wanted[i]);
+            missingOut.push_back(out[i]);
+        }
+    }
+    if(missing.empty())
+        return 0;
+
+    uint8_t c = (uint8_t)missing.size();
+    std::vector<uint8_t> sources(k);
+    std::vector<uint8_t> coefficients(c * k);
+    if(decodeMatrix(present.data(), missing.data(), c, sources.data(), coefficients.data()))
+        return 1;
+
+    //skip sources with zero coefficient, they would not contribute anything
+    std::vector<uint8_t> t(k * 32);
+    std::vector<const uint8_t*> src(k);
+    for(uint8_t i = 0; i < c; i++)
+    {
+        uint8_t used = 0;
+        for(uint8_t j = 0; j < k; j++)
+        {
+            uint8_t x = coefficients[i * k + j];
+            if(x == 0)
+                continue;
+            gf.regionTable(x, &t[used * 32]);
+            src[used++] = shards[sources[j]] + offset;
+        }
+        GF2::dotRegion(t.data(), src.data(), used, missingOut[i], len);
+    }
+    return 0;
+}
+
+/**
+ * @brief Split decoding into per-helper terms for partial-sum (chained) repair
+ * @param *present Presence flags of all k+m shards, non-zero if shard is available
+ * @param *wanted Indexes of shards to be rebuilt
+ * @param count Number of wanted shards
+ * @param &helpers Output list of helpers, up to k. Helpers that do not contribute to any wanted shard are omitted
+ * @return 0 on success, 1 if there are less than k shards available or a wanted index is out of range
+ */
+uint8_t ErasureCode::repairHelpers(const uint8_t *present, const uint8_t *wanted, uint8_t count, std::vector<ECHelper> &helpers)
+{
+    helpers.clear();
+    if(k == 0)
+        return 1;
+
+    std::vector<uint8_t> sources(k);
+    std::vector<uint8_t> coefficients(count * k);
+    if(decodeMatrix(present, wanted, count, sources.data(), coefficients.data()))
+        return 1; //also rejects wanted indexes past k+m-1, helpers stay empty
+
+    //helper j needs column j of the decoding matrix
+    for(uint8_t j = 0; j < k; j++)
+    {
+        ECHelper h;
+        h.shard = sources[j];
+        h.coefficients.resize(count);
+        h.tables.resize(count * 32);
+        bool used = false;
+        for(uint8_t i = 0; i < count; i++)
+        {
+            h.coefficients[i] = coefficients[i * k + j];
+            gf.regionTable(h.coefficients[i], &h.tables[i * 32]);
+            if(h.coefficients[i])
+                used = true;
+        }
+        if(used)
+            helpers.push_back(h);
+    }
+    return 0;
+}
+
+/**
+ * @brief Add helper terms to partial sums
+ * @param &helper Helper description from repairHelpers()
+ * @param *shard Helper shard data (or its part)
+ * @param **in Incoming partial sums, one for every wanted shard, nullptr for the first helper in chain
+ * @param **out Outgoing partial sums, may be the same as incoming
+ * @param len Length in bytes
+ */
+void ErasureCode::partialRepair(const ECHelper &helper, const uint8_t *shard, const uint8_t * const *in, uint8_t * const *out, size_t len)
+{
+    for(size_t i = 0; i < helper.coefficients.size(); i++)
+    {
+        const uint8_t *partial = (in != nullptr) ? in[i] : nullptr;
+        if(helper.coefficients[i])
+            GF2::mulXorRegion(&helper.tables[i * 32], shard, partial, out[i], len);
+        else if(partial == nullptr)
+            memset(out[i], 0, len);
+        else if(partial != out[i])
+            memcpy(out[i], partial, len); //nothing to add, just pass the partial sum on
+    }
+}
+
+/**
+ * @brief Get parity matrix coefficient
+ * @param row Parity shard number
+ * @param col Data shard number
+ * @return Coefficient
+ */
+uint8_t ErasureCode::getCoefficient(uint8_t row, uint8_t col)
+{
+    if((row >= m) || (col >= k))
+        return 0;
+    return matrix[row * k + col];
+}
+
+/**
+ * @brief Get number of data shards
+ * @return k
+ */
+uint8_t ErasureCode::getDataShards(void)
+{
+    return k;
+}
+
+/**
+ * @brief Get number of parity shards
+ * @return m
+ */
+uint8_t ErasureCode::getParityShards(void)
+{
+    return m;
+}
+
+/**
+ * @brief Check if object is initialized
+ * @return 0 if initialized
+ */
+uint8_t ErasureCode::isInitialized(void)
+{
+    if(k)
+        return 0;
+
+    return 1;
+}
+
+/**
+ * @brief Initializes erasure code
+ * @param &gf GF(2^8) object, copied, the code is not initialized if the field is not
+ * @param k Number of data shards
+ * @param m Number of parity shards, k+m must not exceed 256
+ * @param type Parity matrix type, EC_VANDERMONDE or EC_CAUCHY
+ */
+ErasureCode::ErasureCode(const GF2 &gf, uint8_t k, uint8_t m, uint8_t type) : gf(gf)
+{
+    this->k = 0;
+    this->m = 0;
+    this->type = type;
+
+    if((k == 0) || (m == 0) || (((uint16_t)k + m) > 256))
+        return;
+    if(this->gf.isInitialized())
+        return; //no lookup tables (non-primitive polynomial or moved-from field object)
+
+    matrix.resize(m * k);
+    if(type == EC_CAUCHY)
+    {
+        //c_ij = 1/(x_i + y_j), where x_i = i and y_j = m + j are all distinct, so every square submatrix is invertible
+        for(uint8_t i = 0; i < m; i++)
+        {
+            for(uint8_t j = 0; j < k; j++)
+                matrix[i * k + j] = this->gf.inv(i ^ (uint8_t)(m + j));
+        }
+    }
+    else if(type == EC_VANDERMONDE)
+    {
+        //(k+m) x k Vandermonde matrix v_ij = i^j has every k rows linearly independent
+        //multiplying it by the inverse of its top k x k part gives an identity matrix on the top and parity matrix on the bottom
+        std::vector<uint8_t> top(k * k);
+        for(uint16_t i = 0; i < ((uint16_t)k + m); i++)
+        {
+            uint8_t x = 1;
+            for(uint8_t j = 0; j < k; j++)
+            {
+                if(i < k)
+                    top[i * k + j] = x;
+                else
+                    matrix[(i - k) * k + j] = x;
+                x = this->gf.mul(x, (uint8_t)i);
+            }
+        }
+        if(invert(top.data(), k))
+            return;
+        std::vector<uint8_t> row(k);
+        for(uint8_t i = 0; i < m; i++)
+        {
+            for(uint8_t j = 0; j < k; j++)
+            {
+                uint8_t acc = 0;
+                for(uint8_t l = 0; l < k; l++)
+                    acc ^= this->gf.mul(matrix[i * k + l], top[l * k + j]);
+                row[j] = acc;
+            }
+            for(uint8_t j = 0; j < k; j++)
+                matrix[i * k + j] = row[j];
+        }
+    }
+    else
+        return; //unknown matrix type
+
+    tables.resize(m * k * 32);
+    for(uint16_t i = 0; i < (uint16_t)(m * k); i++)
+        this->gf.regionTable(matrix[i], &tables[i * 32]);
+
+    this->k = k;
+    this->m = m;
+}
@@ -0,0 +1,203 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file ec.h
+* @brief Systematic Reed-Solomon erasure code over GF(2^8)
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef EC_H
+#define EC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "gf2.h"
+
+#define EC_VANDERMONDE 0 //parity matrix derived from Vandermonde matrix
+#define EC_CAUCHY 1 //Cauchy parity matrix
+
+#define EC_CHUNK 4096 //number of columns processed at once, so that source chunks stay in cache for all parity rows
+#define EC_STRIDE (EC_CHUNK + 64) //row stride of shard-major scratch in interleaved mode, padded to avoid cache set conflicts when transposing
+#define EC_VERIFY_BLOCK 512 //default verification block size
+#define EC_CAUCHY_STRUCTURED_MIN 12 //minimum k for closed-form decoding of Cauchy code, elimination is faster below
+
+/**
+ * @brief Range of columns (byte offsets within a shard)
+ */
+struct ECRange
+{
+	size_t offset; //first column
+	size_t length; //number of columns
+};
+
+/**
+ * @brief Contribution of one helper shard to partial-sum repair
+ */
+struct ECHelper
+{
+	uint8_t shard; //helper shard index
+	std::vector<uint8_t> coefficients; //coefficient for every wanted shard
+	std::vector<uint8_t> tables; //region tables of coefficients, 32 bytes each
+};
+
+/**
+ * @brief This class provides systematic k+m erasure coding over GF(2^8)
+ *
+ * Data is split into k shards and m parity shards are calculated, so that any k shards are enough to recover the data.
+ * Parity shard i is a dot product of i-th row of the m x k parity matrix and the data shards.
+ * The column (byte) j of all shards forms one codeword.
+ */
+class ErasureCode
+{
+public:
+	/**
+	 * @brief Calculate parity shards
+	 * @param **data k data shards
+	 * @param **parity m output parity shards
+	 * @param len Shard length in bytes
+	 */
+	void encode(const uint8_t * const *data, uint8_t * const *parity, size_t len);
+
+	/**
+	 * @brief Calculate parity of byte-interleaved codewords
+	 * @param *codewords len codewords of k+m bytes each, data bytes first. Parity bytes are filled in
+	 * @param len Number of codewords
+	 * Codewords are transposed to shard-major layout in chunks, so that the region kernels can be used.
+	 */
+	void encodeInterleaved(uint8_t *codewords, size_t len);
+
+	/**
+	 * @brief Rebuild erased positions of byte-interleaved codewords
+	 * @param *codewords len codewords of k+m bytes each. Erased bytes are overwritten
+	 * @param *erased Erasure flags of all k+m positions, the same for every codeword
+	 * @param len Number of codewords
+	 * @return 0 on success, 1 if more than m positions are erased
+	 */
+	uint8_t decodeInterleaved(uint8_t *codewords, const uint8_t *erased, size_t len);
+
+	/**
+	 * @brief Verify parity shards without storing anything
+	 * @param **data k data shards
+	 * @param **parity m parity shards
+	 * @param len Shard length in bytes
+	 * @param *failed Output list of failing column ranges, aligned to blocks. If nullptr, verification stops at the first failing block
+	 * @param blockSize Verification block size in bytes
+	 * @return 0 if all parity shards are consistent with data
+	 */
+	uint8_t verify(const uint8_t * const *data, const uint8_t * const *parity, size_t len, std::vector<ECRange> *failed = nullptr, size_t blockSize = EC_VERIFY_BLOCK);
+
+	/**
+	 * @brief Calculate decoding coefficients for chosen shards
+	 * @param *present Presence flags of all k+m shards, non-zero if shard is available
+	 * @param *wanted Indexes of shards to be rebuilt (0...k-1 for data shards, k...k+m-1 for parity shards)
+	 * @param count Number of wanted shards
+	 * @param *sources Output k indexes of available shards used for decoding
+	 * @param *coefficients Output count x k matrix, wanted shard i = sum of coefficients[i*k+j]*shard sources[j]
+	 * @return 0 on success, 1 if there are less than k shards available or a wanted index is out of range
+	 * Only the rows of the inverse matrix needed for the wanted shards are calculated, using the closed-form structure
+	 * of the Vandermonde or Cauchy parity matrix in O(k^2) per wanted shard, with Gauss-Jordan elimination as a fallback.
+	 */
+	uint8_t decodeMatrix(const uint8_t *present, const uint8_t *wanted, uint8_t count, uint8_t *sources, uint8_t *coefficients);
+
+	/**
+	 * @brief Rebuild a byte range of chosen shards
+	 * @param **shards All k+m shards, nullptr for missing shards
+	 * @param *wanted Indexes of shards to be rebuilt
+	 * @param count Number of wanted shards
+	 * @param **out Output buffers for wanted shards, len bytes each
+	 * @param offset First column (byte offset within shard)
+	 * @param len Number of columns
+	 * @return 0 on success, 1 if there are less than k shards available
+	 * Only the given range of k source shards is read, so the cost scales with the range length.
+	 */
+	uint8_t decode(const uint8_t * const *shards, const uint8_t *wanted, uint8_t count, uint8_t * const *out, size_t offset, size_t len);
+
+	/**
+	 * @brief Split decoding into per-helper terms for partial-sum (chained) repair
+	 * @param *present Presence flags of all k+m shards, non-zero if shard is available
+	 * @param *wanted Indexes of shards to be rebuilt
+	 * @param count Number of wanted shards
+	 * @param &helpers Output list of helpers, up to k. Helpers that do not contribute to any wanted shard are omitted
+	 * @return 0 on success, 1 if there are less than k shards available or a wanted index is out of range
+	 * Wanted shard i is the sum of helper.coefficients[i]*shard over all helpers, so the helpers can be chained:
+	 * every helper adds its terms to the partial sums received from the previous one using partialRepair()
+	 * and the last one delivers the rebuilt shards.
+	 */
+	uint8_t repairHelpers(const uint8_t *present, const uint8_t *wanted, uint8_t count, std::vector<ECHelper> &helpers);
+
+	/**
+	 * @brief Add helper terms to partial sums
+	 * @param &helper Helper description from repairHelpers()
+	 * @param *shard Helper shard data (or its part)
+	 * @param **in Incoming partial sums, one for every wanted shard, nullptr for the first helper in chain
+	 * @param **out Outgoing partial sums, may be the same as incoming
+	 * @param len Length in bytes
+	 */
+	static void partialRepair(const ECHelper &helper, const uint8_t *shard, const uint8_t * const *in, uint8_t * const *out, size_t len);
+
+	/**
+	 * @brief Get parity matrix coefficient
+	 * @param row Parity shard number
+	 * @param col Data shard number
+	 * @return Coefficient
+	 */
+	uint8_t getCoefficient(uint8_t row, uint8_t col);
+
+	/**
+	 * @brief Get number of data shards
+	 * @return k
+	 */
+	uint8_t getDataShards(void);
+
+	/**
+	 * @brief Get number of parity shards
+	 * @return m
+	 */
+	uint8_t getParityShards(void);
+
+	/**
+	 * @brief Check if object is initialized
+	 * @return 0 if initialized
+	 */
+	uint8_t isInitialized(void);
+
+	/**
+	 * @brief Initializes erasure code
+	 * @param &gf GF(2^8) object, copied, the code is not initialized if the field is not
+	 * @param k Number of data shards
+	 * @param m Number of parity shards, k+m must not exceed 256
+	 * @param type Parity matrix type, EC_VANDERMONDE or EC_CAUCHY
+	 */
+	ErasureCode(const GF2 &gf, uint8_t k, uint8_t m, uint8_t type = EC_VANDERMONDE);
+
+private:
+	GF2 gf; //field object
+	uint8_t k; //number of data shards, 0 if not initialized
+	uint8_t m; //number of parity shards
+	uint8_t type; //parity matrix type
+	std::vector<uint8_t> matrix; //m x k parity matrix
+	std::vector<uint8_t> tables; //region tables of parity matrix, 32 bytes per coefficient
+
+	uint8_t invert(uint8_t *a, uint8_t n); //invert n x n matrix in place
+	uint8_t structuredDecode(const uint8_t *sources, const uint8_t *wanted, uint8_t count, uint8_t *coefficients); //decoding coefficients in O(k^2) per wanted shard
+};
+
+#endif
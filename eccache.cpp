@@ -0,0 +1,749 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file eccache.cpp
+* @brief In-memory erasure coded object cache
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "eccache.h"
+#include <deque>
+#include <atomic>
+#include <chrono>
+#include <string.h>
+
+#define ECCACHE_STORE 0 //store shard
+#define ECCACHE_LOAD 1 //load shard
+#define ECCACHE_ERASE 2 //erase shard
+#define ECCACHE_WIPE 3 //erase everything
+
+/**
+ * @brief Completion counter of a group of requests
+ */
+struct ECCacheBatch
+{
+    std::mutex lock;
+    std::condition_variable cv;
+    size_t pending = 0;
+
+    void wait(void)
+    {
+        std::unique_lock<std::mutex> l(lock);
+        cv.wait(l, [this]() { return pending == 0; });
+    }
+
+    void done(void)
+    {
+        std::lock_guard<std::mutex> l(lock);
+        if(--pending == 0)
+            cv.notify_all();
+    }
+};
+
+/**
+ * @brief Request sent to a node
+ */
+struct ECCacheRequest
+{
+    uint8_t type; //request type
+    uint64_t key; //object key
+    uint8_t shard; //shard number
+    uint64_t version; //object version
+    std::vector<uint8_t> data; //shard data, input for store, output for load
+    uint8_t result; //0 on success
+    ECCacheBatch *batch; //completion counter
+};
+
+/**
+ * @brief Storage node: a thread serving requests from its queue
+ */
+struct ECCacheNode
+{
+    /**
+     * @brief Stored shard
+     */
+    struct Shard
+    {
+        uint8_t index; //shard number
+        uint64_t version; //object version
+        std::vector<uint8_t> data; //shard data
+    };
+
+    std::thread thread; //node thread
+    std::mutex lock; //protects queue and stop flag
+    std::condition_variable cv; //wakes node thread
+    std::deque<ECCacheRequest*> queue; //pending requests
+    bool stop = false; //stop request
+    bool up = true; //node state, protected by cache lock
+    std::unordered_map<uint64_t, Shard> store; //shards, accessed only by node thread
+    std::atomic<uint64_t> bytes{0}; //size of stored shards
+
+    /**
+     * @brief Queue request
+     * @param *r Request
+     */
+    void submit(ECCacheRequest *r)
+    {
+        std::lock_guard<std::mutex> l(lock);
+        queue.push_back(r);
+        cv.notify_one();
+    }
+
+    /**
+     * @brief Serve requests until stopped
+     */
+    void run(void)
+    {
+        while(true)
+        {
+            ECCacheRequest *r;
+            {
+                std::unique_lock<std::mutex> l(lock);
+                cv.wait(l, [this]() { return stop || !queue.empty(); });
+                if(queue.empty())
+                    return;
+                r = queue.front();
+                queue.pop_front();
+            }
+            r->result = 0;
+            auto it = store.find(r->key);
+            switch(r->type)
+            {
+                case ECCACHE_STORE:
+                    //a late store of an older version (e.g. from repair) must not replace a newer shard
+                    if((it != store.end()) && (it->second.version > r->version))
+                    {
+                        r->result = 1;
+                        break;
+                    }
+                    if(it != store.end())
+                        bytes -= it->second.data.size();
+                    bytes += r->data.size();
+                    //copied here, so that the shard is allocated from the arena of this thread
+                    store[r->key] = Shard{r->shard, r->version, std::vector<uint8_t>(r->data.begin(), r->data.end())};
+                    break;
+                case ECCACHE_LOAD:
+                    if((it == store.end()) || (it->second.index != r->shard) || (it->second.version != r->version))
+                        r->result = 1;
+                    else
+                        r->data = it->second.data; //copy, like a transfer over network would
+                    break;
+                case ECCACHE_ERASE:
+                    if((it != store.end()) && (it->second.index == r->shard) && (it->second.version == r->version))
+                    {
+                        bytes -= it->second.data.size();
+                        store.erase(it);
+                    }
+                    break;
+                case ECCACHE_WIPE:
+                    store.clear();
+                    bytes = 0;
+                    break;
+            }
+            r->batch->done();
+        }
+    }
+};
+
+/**
+ * @brief Hash object key
+ * @param x Key
+ * @return Hash (splitmix64 finalizer)
+ */
+static inline uint64_t hashKey(uint64_t x)
+{
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Store object
+ * @param key Object key, an existing object is replaced
+ * @param *data Object data
+ * @param len Object length in bytes
+ * @return 0 on success, 1 if less than k+m nodes are up
+ */
+uint8_t ECCache::put(uint64_t key, const uint8_t *data, size_t len)
+{
+    if(k == 0)
+        return 1;
+    uint16_t n = k + m;
+    Entry entry;
+    std::vector<uint8_t> stale; //nodes with shards of the replaced object
+    std::vector<uint8_t> staleShard;
+    uint64_t staleVersion = 0;
+    {
+        //consecutive live nodes starting from the key hash
+        std::lock_guard<std::mutex> l(lock);
+        uint8_t start = (uint8_t)(hashKey(key) % nodes.size());
+        for(size_t i = 0; (i < nodes.size()) && (entry.node.size() < n); i++)
+        {
+            uint8_t node = (uint8_t)((start + i) % nodes.size());
+            if(nodes[node]->up)
+                entry.node.push_back(node);
+        }
+        if(entry.node.size() < n)
+            return 1;
+        entry.version = ++version;
+    }
+    entry.length = len;
+    entry.shardLength = (len + k - 1) / k;
+    entry.present.assign(n, 1);
+
+    std::vector<ECCacheRequest> req(n);
+    std::vector<const uint8_t*> dataPtr(k);
+    std::vector<uint8_t*> parityPtr(m);
+    for(uint8_t i = 0; i < k; i++)
+    {
+        req[i].data.assign(entry.shardLength, 0);
+        size_t offset = i * entry.shardLength;
+        if(offset < len)
+            memcpy(req[i].data.data(), data + offset, ((len - offset) < entry.shardLength) ? (len - offset) : entry.shardLength);
+        dataPtr[i] = req[i].data.data();
+    }
+    for(uint8_t i = 0; i < m; i++)
+    {
+        req[k + i].data.resize(entry.shardLength);
+        parityPtr[i] = req[k + i].data.data();
+    }
+    code.encode(dataPtr.data(), parityPtr.data(), entry.shardLength);
+
+    ECCacheBatch batch;
+    batch.pending = n;
+    for(uint16_t i = 0; i < n; i++)
+    {
+        req[i].type = ECCACHE_STORE;
+        req[i].key = key;
+        req[i].shard = (uint8_t)i;
+        req[i].version = entry.version;
+        req[i].batch = &batch;
+        nodes[entry.node[i]]->submit(&req[i]);
+    }
+    batch.wait();
+
+    {
+        std::lock_guard<std::mutex> l(lock);
+        auto it = index.find(key);
+        if(it != index.end())
+        {
+            //shards of the old object on nodes that are not reused must be erased
+            for(uint16_t i = 0; i < n; i++)
+            {
+                uint8_t node = it->second.node[i];
+                bool reused = false;
+                for(uint16_t j = 0; j < n; j++)
+                    reused |= (entry.node[j] == node);
+                if(it->second.present[i] && !reused)
+                {
+                    stale.push_back(node);
+                    staleShard.push_back((uint8_t)i);
+                }
+            }
+            staleVersion = it->second.version;
+            stats.logicalBytes -= it->second.length;
+            stats.objects--;
+        }
+        //a node that failed during the transfer has lost its shard
+        for(uint16_t i = 0; i < n; i++)
+            entry.present[i] = nodes[entry.node[i]]->up;
+        index[key] = entry;
+        stats.logicalBytes += len;
+        stats.objects++;
+    }
+
+    if(!stale.empty())
+    {
+        std::vector<ECCacheRequest> erase(stale.size());
+        batch.pending = stale.size();
+        for(size_t i = 0; i < stale.size(); i++)
+        {
+            erase[i].type = ECCACHE_ERASE;
+            erase[i].key = key;
+            erase[i].shard = staleShard[i];
+            erase[i].version = staleVersion;
+            erase[i].batch = &batch;
+            nodes[stale[i]]->submit(&erase[i]);
+        }
+        batch.wait();
+    }
+    return 0;
+}
+
+/**
+ * @brief Fetch k shards of an object and decode missing data shards
+ * @param key Object key
+ * @param &entry Object placement
+ * @param &shards Output k+m shards, data shards are always filled in on success
+ * @param &degraded Output flag, set if some data shards had to be decoded
+ * @return 0 on success, 2 if less than k shards are available
+ */
+uint8_t ECCache::fetch(uint64_t key, const Entry &entry, std::vector<std::vector<uint8_t>> &shards, bool &degraded)
+{
+    uint16_t n = k + m;
+    shards.assign(n, std::vector<uint8_t>());
+    std::vector<uint8_t> tried(n, 0), loaded(n, 0);
+    uint8_t count = 0;
+    degraded = false;
+
+    //data shards first, so that nothing needs to be decoded if all of them are there
+    while(count < k)
+    {
+        std::vector<uint8_t> pick;
+        {
+            std::lock_guard<std::mutex> l(lock);
+            for(uint16_t i = 0; (i < n) && ((count + pick.size()) < k); i++)
+            {
+                if(!tried[i] && entry.present[i] && nodes[entry.node[i]]->up)
+                    pick.push_back((uint8_t)i);
+            }
+        }
+        if(pick.empty())
+            return 2;
+
+        std::vector<ECCacheRequest> req(pick.size());
+        ECCacheBatch batch;
+        batch.pending = pick.size();
+        for(size_t i = 0; i < pick.size(); i++)
+        {
+            tried[pick[i]] = 1;
+            req[i].type = ECCACHE_LOAD;
+            req[i].key = key;
+            req[i].shard = pick[i];
+            req[i].version = entry.version;
+            req[i].batch = &batch;
+            nodes[entry.node[pick[i]]]->submit(&req[i]);
+        }
+        batch.wait();
+        for(size_t i = 0; i < pick.size(); i++)
+        {
+            if((req[i].result == 0) && (req[i].data.size() == entry.shardLength))
+            {
+                shards[pick[i]] = std::move(req[i].data);
+                loaded[pick[i]] = 1;
+                count++;
+            }
+        }
+    }
+
+    std::vector<uint8_t> wanted;
+    for(uint8_t i = 0; i < k; i++)
+    {
+        if(!loaded[i])
+            wanted.push_back(i);
+    }
+    if(!wanted.empty())
+    {
+        degraded = true;
+        std::vector<const uint8_t*> src(n);
+        std::vector<uint8_t*> out(wanted.size());
+        for(uint16_t i = 0; i < n; i++)
+            src[i] = loaded[i] ? shards[i].data() : nullptr;
+        for(size_t i = 0; i < wanted.size(); i++)
+        {
+            shards[wanted[i]].resize(entry.shardLength);
+            out[i] = shards[wanted[i]].data();
+        }
+        if(code.decode(src.data(), wanted.data(), (uint8_t)wanted.size(), out.data(), 0, entry.shardLength))
+            return 2;
+    }
+    return 0;
+}
+
+/**
+ * @brief Retrieve object
+ * @param key Object key
+ * @param &data Output object data
+ * @return 0 on success, 1 if there is no such object, 2 if less than k shards are available
+ */
+uint8_t ECCache::get(uint64_t key, std::vector<uint8_t> &data)
+{
+    if(k == 0)
+        return 1;
+    Entry entry;
+    {
+        std::lock_guard<std::mutex> l(lock);
+        auto it = index.find(key);
+        if(it == index.end())
+            return 1;
+        entry = it->second;
+    }
+    std::vector<std::vector<uint8_t>> shards;
+    bool degraded;
+    uint8_t ret = fetch(key, entry, shards, degraded);
+    {
+        std::lock_guard<std::mutex> l(lock);
+        if(ret)
+            stats.failedGets++;
+        else if(degraded)
+            stats.degradedGets++;
+    }
+    if(ret)
+        return 2;
+    data.resize(entry.length);
+    for(uint8_t i = 0; i < k; i++)
+    {
+        size_t offset = i * entry.shardLength;
+        if(offset < entry.length)
+            memcpy(data.data() + offset, shards[i].data(), ((entry.length - offset) < entry.shardLength) ? (entry.length - offset) : entry.shardLength);
+    }
+    return 0;
+}
+
+/**
+ * @brief Remove object
+ * @param key Object key
+ * @return 0 on success, 1 if there is no such object
+ */
+uint8_t ECCache::remove(uint64_t key)
+{
+    if(k == 0)
+        return 1;
+    Entry entry;
+    {
+        std::lock_guard<std::mutex> l(lock);
+        auto it = index.find(key);
+        if(it == index.end())
+            return 1;
+        entry = it->second;
+        stats.logicalBytes -= entry.length;
+        stats.objects--;
+        index.erase(it);
+    }
+    uint16_t n = k + m;
+    std::vector<ECCacheRequest> req(n);
+    ECCacheBatch batch;
+    batch.pending = n;
+    for(uint16_t i = 0; i < n; i++)
+    {
+        req[i].type = ECCACHE_ERASE;
+        req[i].key = key;
+        req[i].shard = (uint8_t)i;
+        req[i].version = entry.version;
+        req[i].batch = &batch;
+        nodes[entry.node[i]]->submit(&req[i]);
+    }
+    batch.wait();
+    return 0;
+}
+
+/**
+ * @brief Fail node, its shards are lost
+ * @param node Node number
+ */
+void ECCache::failNode(uint8_t node)
+{
+    if(node >= nodes.size())
+        return;
+    {
+        std::lock_guard<std::mutex> l(lock);
+        nodes[node]->up = false;
+        for(auto &it : index)
+        {
+            for(size_t i = 0; i < it.second.node.size(); i++)
+            {
+                if(it.second.node[i] == node)
+                    it.second.present[i] = 0;
+            }
+        }
+    }
+    ECCacheRequest req;
+    ECCacheBatch batch;
+    batch.pending = 1;
+    req.type = ECCACHE_WIPE;
+    req.batch = &batch;
+    nodes[node]->submit(&req);
+    batch.wait();
+}
+
+/**
+ * @brief Bring failed node back, empty
+ * @param node Node number
+ */
+void ECCache::restoreNode(uint8_t node)
+{
+    if(node >= nodes.size())
+        return;
+    {
+        //the shards of a node that is up are indexed as present, so it must not be wiped
+        std::lock_guard<std::mutex> l(lock);
+        if(nodes[node]->up)
+            return;
+    }
+    //drop anything stored by requests that were in flight when the node failed
+    ECCacheRequest req;
+    ECCacheBatch batch;
+    batch.pending = 1;
+    req.type = ECCACHE_WIPE;
+    req.batch = &batch;
+    nodes[node]->submit(&req);
+    batch.wait();
+    {
+        std::lock_guard<std::mutex> l(lock);
+        nodes[node]->up = true;
+    }
+    repairWake.notify_all();
+}
+
+/**
+ * @brief Rebuild missing shards
+ * @return Number of rebuilt shards
+ */
+size_t ECCache::repair(void)
+{
+    if(k == 0)
+        return 0;
+    uint16_t n = k + m;
+    std::vector<std::pair<uint64_t, Entry>> damaged;
+    {
+        std::lock_guard<std::mutex> l(lock);
+        for(auto &it : index)
+        {
+            for(uint16_t i = 0; i < n; i++)
+            {
+                if(!it.second.present[i])
+                {
+                    damaged.push_back(it);
+                    break;
+                }
+            }
+        }
+    }
+
+    size_t repaired = 0;
+    for(size_t d = 0; d < damaged.size(); d++)
+    {
+        uint64_t key = damaged[d].first;
+        Entry &entry = damaged[d].second;
+
+        //pick a live node for every missing shard: the original one if it is back, otherwise one not used by this object
+        std::vector<uint8_t> wanted, target;
+        {
+            std::lock_guard<std::mutex> l(lock);
+            std::vector<uint8_t> used(nodes.size(), 0);
+            for(uint16_t i = 0; i < n; i++)
+                used[entry.node[i]] = 1;
+            for(uint16_t i = 0; i < n; i++)
+            {
+                if(entry.present[i])
+                    continue;
+                int16_t t = -1;
+                if(nodes[entry.node[i]]->up)
+                    t = entry.node[i];
+                else
+                {
+                    for(size_t j = 0; j < nodes.size(); j++)
+                    {
+                        if(!used[j] && nodes[j]->up)
+                        {
+                            t = (int16_t)j;
+                            used[j] = 1;
+                            break;
+                        }
+                    }
+                }
+                if(t >= 0)
+                {
+                    wanted.push_back((uint8_t)i);
+                    target.push_back((uint8_t)t);
+                }
+            }
+        }
+        if(wanted.empty())
+            continue;
+
+        std::vector<std::vector<uint8_t>> shards;
+        bool degraded;
+        if(fetch(key, entry, shards, degraded))
+            continue;
+        //data shards are complete now, parity is rebuilt from them
+        std::vector<const uint8_t*> src(n, nullptr);
+        for(uint8_t i = 0; i < k; i++)
+            src[i] = shards[i].data();
+        std::vector<ECCacheRequest> req(wanted.size());
+        std::vector<uint8_t*> out(wanted.size());
+        for(size_t i = 0; i < wanted.size(); i++)
+        {
+            req[i].data.resize(entry.shardLength);
+            out[i] = req[i].data.data();
+        }
+        if(code.decode(src.data(), wanted.data(), (uint8_t)wanted.size(), out.data(), 0, entry.shardLength))
+            continue;
+
+        ECCacheBatch batch;
+        batch.pending = wanted.size();
+        for(size_t i = 0; i < wanted.size(); i++)
+        {
+            req[i].type = ECCACHE_STORE;
+            req[i].key = key;
+            req[i].shard = wanted[i];
+            req[i].version = entry.version;
+            req[i].batch = &batch;
+            nodes[target[i]]->submit(&req[i]);
+        }
+        batch.wait();
+
+        bool stale = false;
+        size_t rebuilt = 0;
+        {
+            std::lock_guard<std::mutex> l(lock);
+            auto it = index.find(key);
+            if((it != index.end()) && (it->second.version == entry.version))
+            {
+                for(size_t i = 0; i < wanted.size(); i++)
+                {
+                    //the target may have failed in the meantime
+                    if(nodes[target[i]]->up)
+                    {
+                        it->second.node[wanted[i]] = target[i];
+                        it->second.present[wanted[i]] = 1;
+                        rebuilt++;
+                    }
+                }
+                stats.repairedShards += rebuilt;
+                repaired += rebuilt;
+            }
+            else
+                stale = true;
+        }
+        if(stale)
+        {
+            //object was replaced or removed while repairing, drop rebuilt shards (newer shards do not match the version)
+            batch.pending = wanted.size();
+            for(size_t i = 0; i < wanted.size(); i++)
+            {
+                req[i].type = ECCACHE_ERASE;
+                nodes[target[i]]->submit(&req[i]);
+            }
+            batch.wait();
+        }
+    }
+    return repaired;
+}
+
+/**
+ * @brief Stop background repair thread
+ */
+void ECCache::stopRepair(void)
+{
+    if(!repairThread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> l(repairLock);
+        repairStop = true;
+    }
+    repairWake.notify_all();
+    repairThread.join();
+}
+
+/**
+ * @brief Enable or disable background repair
+ * @param interval Time between repair passes in seconds, 0 to disable
+ */
+void ECCache::setBackgroundRepair(double interval)
+{
+    stopRepair();
+    repairInterval = interval;
+    if((interval <= 0.0) || (k == 0))
+        return;
+    repairStop = false;
+    repairThread = std::thread([this]()
+    {
+        std::unique_lock<std::mutex> l(repairLock);
+        while(!repairStop)
+        {
+            repairWake.wait_for(l, std::chrono::duration<double>(repairInterval));
+            if(repairStop)
+                break;
+            l.unlock();
+            repair();
+            l.lock();
+        }
+    });
+}
+
+/**
+ * @brief Get cache statistics
+ * @return Statistics
+ */
+ECCacheStats ECCache::getStats(void)
+{
+    std::lock_guard<std::mutex> l(lock);
+    ECCacheStats ret = stats;
+    ret.storedBytes = 0;
+    for(size_t i = 0; i < nodes.size(); i++)
+        ret.storedBytes += nodes[i]->bytes;
+    ret.missingShards = 0;
+    for(auto &it : index)
+    {
+        for(size_t i = 0; i < it.second.present.size(); i++)
+            ret.missingShards += !it.second.present[i];
+    }
+    return ret;
+}
+
+/**
+ * @brief Check if object is initialized
+ * @return 0 if initialized
+ */
+uint8_t ECCache::isInitialized(void)
+{
+    return (k == 0);
+}
+
+/**
+ * @brief Initializes cache and starts node threads
+ * @param &gf GF(2^8) object, copied
+ * @param k Number of data shards
+ * @param m Number of parity shards
+ * @param nodes Number of nodes, at least k+m
+ */
+ECCache::ECCache(const GF2 &gf, uint8_t k, uint8_t m, uint8_t nodes) : code(gf, k, m)
+{
+    this->k = 0;
+    this->m = m;
+    version = 0;
+    memset(&stats, 0, sizeof(stats));
+    repairInterval = 0.0;
+    repairStop = false;
+    if(code.isInitialized() || (m == 0) || (nodes < ((uint16_t)k + m)))
+        return;
+    this->k = k;
+    for(uint8_t i = 0; i < nodes; i++)
+    {
+        this->nodes.emplace_back(new ECCacheNode);
+        ECCacheNode *node = this->nodes.back().get();
+        node->thread = std::thread([node]() { node->run(); });
+    }
+}
+
+ECCache::~ECCache()
+{
+    stopRepair();
+    for(size_t i = 0; i < nodes.size(); i++)
+    {
+        {
+            std::lock_guard<std::mutex> l(nodes[i]->lock);
+            nodes[i]->stop = true;
+        }
+        nodes[i]->cv.notify_one();
+        nodes[i]->thread.join();
+    }
+}
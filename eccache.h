@@ -0,0 +1,178 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file eccache.h
+* @brief In-memory erasure coded object cache
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef ECCACHE_H
+#define ECCACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "gf2.h"
+#include "ec.h"
+
+#define ECCACHE_MAX_NODES 255 //maximum number of nodes
+
+/**
+ * @brief Cache statistics
+ */
+struct ECCacheStats
+{
+	uint64_t objects; //number of objects
+	uint64_t logicalBytes; //total size of objects
+	uint64_t storedBytes; //total size of shards held by all nodes
+	uint64_t degradedGets; //number of gets that needed decoding
+	uint64_t failedGets; //number of gets of existing objects that could not be served
+	uint64_t repairedShards; //number of shards rebuilt by repair
+	uint64_t missingShards; //number of shards currently missing
+};
+
+struct ECCacheNode;
+struct ECCacheBatch;
+
+/**
+ * @brief This class provides an in-memory object cache striped k+m across N in-process nodes
+ *
+ * Every node is a thread with its own shard store, so it allocates from its own malloc arena, and it is
+ * accessed only through its request queue, like a remote node would be. An object is split into k data shards
+ * (the last one padded with zeros) and m parity shards, placed on k+m different nodes.
+ * A get reads the data shards in parallel and falls back to decoding from any k shards when some nodes are down.
+ * Shards lost with failed nodes are rebuilt by repair, either called directly or running in the background,
+ * onto the original node if it is back or onto another live node otherwise.
+ * Every shard carries the version of its object, so a late store of a rebuilt shard never replaces a newer one
+ * and loads never mix shards of different versions.
+ * Replication can be modelled with k = 1, where every parity shard is a (scaled) copy of the object.
+ */
+class ECCache
+{
+public:
+	/**
+	 * @brief Store object
+	 * @param key Object key, an existing object is replaced
+	 * @param *data Object data
+	 * @param len Object length in bytes
+	 * @return 0 on success, 1 if less than k+m nodes are up
+	 */
+	uint8_t put(uint64_t key, const uint8_t *data, size_t len);
+
+	/**
+	 * @brief Retrieve object
+	 * @param key Object key
+	 * @param &data Output object data
+	 * @return 0 on success, 1 if there is no such object, 2 if less than k shards are available
+	 */
+	uint8_t get(uint64_t key, std::vector<uint8_t> &data);
+
+	/**
+	 * @brief Remove object
+	 * @param key Object key
+	 * @return 0 on success, 1 if there is no such object
+	 */
+	uint8_t remove(uint64_t key);
+
+	/**
+	 * @brief Fail node, its shards are lost
+	 * @param node Node number
+	 */
+	void failNode(uint8_t node);
+
+	/**
+	 * @brief Bring failed node back, empty
+	 * @param node Node number
+	 */
+	void restoreNode(uint8_t node);
+
+	/**
+	 * @brief Rebuild missing shards
+	 * @return Number of rebuilt shards
+	 */
+	size_t repair(void);
+
+	/**
+	 * @brief Enable or disable background repair
+	 * @param interval Time between repair passes in seconds, 0 to disable
+	 */
+	void setBackgroundRepair(double interval);
+
+	/**
+	 * @brief Get cache statistics
+	 * @return Statistics
+	 */
+	ECCacheStats getStats(void);
+
+	/**
+	 * @brief Check if object is initialized
+	 * @return 0 if initialized
+	 */
+	uint8_t isInitialized(void);
+
+	/**
+	 * @brief Initializes cache and starts node threads
+	 * @param &gf GF(2^8) object, copied
+	 * @param k Number of data shards
+	 * @param m Number of parity shards
+	 * @param nodes Number of nodes, at least k+m
+	 */
+	ECCache(const GF2 &gf, uint8_t k, uint8_t m, uint8_t nodes);
+	ECCache(const ECCache &other) = delete;
+	ECCache &operator=(const ECCache &other) = delete;
+	~ECCache();
+
+private:
+	/**
+	 * @brief Object placement
+	 */
+	struct Entry
+	{
+		size_t length; //object length
+		size_t shardLength; //shard length
+		uint64_t version; //incremented on every put
+		std::vector<uint8_t> node; //node of every shard
+		std::vector<uint8_t> present; //non-zero if shard is stored
+	};
+
+	ErasureCode code; //erasure code
+	uint8_t k; //number of data shards, 0 if not initialized
+	uint8_t m; //number of parity shards
+	std::vector<std::unique_ptr<ECCacheNode>> nodes; //storage nodes
+	std::unordered_map<uint64_t, Entry> index; //object placement
+	std::mutex lock; //protects index, node states and statistics
+	uint64_t version; //last object version
+	ECCacheStats stats; //statistics
+	std::thread repairThread; //background repair thread
+	std::mutex repairLock; //protects repair thread state
+	std::condition_variable repairWake; //wakes background repair thread
+	double repairInterval; //background repair interval, 0 if disabled
+	bool repairStop; //repair thread stop request
+
+	uint8_t fetch(uint64_t key, const Entry &entry, std::vector<std::vector<uint8_t>> &shards, bool &degraded); //fetch k shards, decode missing data shards
+	void stopRepair(void); //stop background repair thread
+};
+
+#endif
@@ -24,6 +24,15 @@
 **/
 
 #include "gf2.h"
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GF2_AVX2
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define GF2_SSSE3
+#endif
 
 
 uint8_t GF2::add(uint8_t x, uint8_t y)
@@ -103,7 +112,696 @@ uint8_t GF2::slowMul(uint8_t x, uint8_t y)
             ret ^= x_; //add multiplicand to the result
         y >>= 1; //divide y by 2
         x_ <<= 1; //multiply x_ by 2
-        if(x_ & 256) x_ ^= GF2_POLY; //if there is a carry bit, apply modular reduction
+        if(x_ & 256) x_ ^= poly; //if there is a carry bit, apply modular reduction
+    }
+    return ret;
+}
+
+/**
+ * @brief Prepare region multiplication table for a constant
+ * @param c Constant
+ * @param *table Output table of 32 bytes: c*x for x=0...15, then c*(x<<4) for x=0...15
+ */
+void GF2::regionTable(uint8_t c, uint8_t *table)
+{
+    //multiplication is distributive, so c*x = c*(x & 0x0F) + c*(x & 0xF0)
+    for(uint8_t i = 0; i < 16; i++)
+    {
+        table[i] = mul(c, i);
+        table[16 + i] = mul(c, i << 4);
+    }
+}
+
+/**
+ * @brief Multiply region by a constant
+ * @param c Constant
+ * @param *src Source region
+ * @param *dst Destination region, may be the same as source
+ * @param len Region length in bytes
+ */
+void GF2::mulRegion(uint8_t c, const uint8_t *src, uint8_t *dst, size_t len)
+{
+    uint8_t table[32];
+    regionTable(c, table);
+    dotRegion(table, &src, 1, dst, len);
+}
+
+/**
+ * @brief Multiply region by a constant and add it to the destination region
+ * @param c Constant
+ * @param *src Source region
+ * @param *dst Destination region
+ * @param len Region length in bytes
+ */
+void GF2::mulAddRegion(uint8_t c, const uint8_t *src, uint8_t *dst, size_t len)
+{
+    if(c == 0)
+        return;
+    uint8_t table[32];
+    regionTable(c, table);
+    mulXorRegion(table, src, dst, dst, len);
+}
+
+#ifdef GF2_AVX2
+/**
+ * @brief Multiply 32 bytes by a constant using its region table
+ * @param *table Region table
+ * @param x Input bytes
+ * @return Products
+ */
+static inline __m256i mulVector(const uint8_t *table, __m256i x)
+{
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)table));
+    __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(table + 16)));
+    return _mm256_xor_si256(_mm256_shuffle_epi8(lo, _mm256_and_si256(x, mask)),
+                            _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(x, 4), mask)));
+}
+#define GF2_VECTOR 32
+#endif
+
+#ifdef GF2_SSSE3
+/**
+ * @brief Multiply 16 bytes by a constant using its region table
+ * @param *table Region table
+ * @param x Input bytes
+ * @return Products
+ */
+static inline __m128i mulVector(const uint8_t *table, __m128i x)
+{
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    __m128i lo = _mm_loadu_si128((const __m128i*)table);
+    __m128i hi = _mm_loadu_si128((const __m128i*)(table + 16));
+    return _mm_xor_si128(_mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+                         _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(x, 4), mask)));
+}
+#define GF2_VECTOR 16
+#endif
+
+/**
+ * @brief Calculate dot product of constants and regions
+ * @param *tables Region tables of constants (32 bytes each, see regionTable())
+ * @param **src Source regions
+ * @param n Number of source regions
+ * @param *dst Destination region, dst = sum of c_i*src_i
+ * @param len Region length in bytes
+ */
+void GF2::dotRegion(const uint8_t *tables, const uint8_t * const *src, uint16_t n, uint8_t *dst, size_t len)
+{
+    size_t i = 0;
+#if defined(GF2_AVX2)
+    for(; (i + GF2_VECTOR) <= len; i += GF2_VECTOR)
+    {
+        __m256i acc = _mm256_setzero_si256();
+        for(uint16_t j = 0; j < n; j++)
+            acc = _mm256_xor_si256(acc, mulVector(tables + (j << 5), _mm256_loadu_si256((const __m256i*)(src[j] + i))));
+        _mm256_storeu_si256((__m256i*)(dst + i), acc);
+    }
+#elif defined(GF2_SSSE3)
+    for(; (i + GF2_VECTOR) <= len; i += GF2_VECTOR)
+    {
+        __m128i acc = _mm_setzero_si128();
+        for(uint16_t j = 0; j < n; j++)
+            acc = _mm_xor_si128(acc, mulVector(tables + (j << 5), _mm_loadu_si128((const __m128i*)(src[j] + i))));
+        _mm_storeu_si128((__m128i*)(dst + i), acc);
+    }
+#endif
+    for(; i < len; i++)
+    {
+        uint8_t acc = 0;
+        for(uint16_t j = 0; j < n; j++)
+        {
+            uint8_t x = src[j][i];
+            acc ^= tables[(j << 5) + (x & 0x0F)] ^ tables[(j << 5) + 16 + (x >> 4)];
+        }
+        dst[i] = acc;
+    }
+}
+
+/**
+ * @brief Multiply region by a constant and add another region
+ * @param *table Region table of the constant (see regionTable())
+ * @param *src Source region
+ * @param *in Region to be added, nullptr if none
+ * @param *out Output region, out = in + c*src, may be the same as in
+ * @param len Region length in bytes
+ */
+void GF2::mulXorRegion(const uint8_t *table, const uint8_t *src, const uint8_t *in, uint8_t *out, size_t len)
+{
+    if(in == nullptr)
+    {
+        dotRegion(table, &src, 1, out, len);
+        return;
+    }
+
+    size_t i = 0;
+#if defined(GF2_AVX2)
+    for(; (i + GF2_VECTOR) <= len; i += GF2_VECTOR)
+    {
+        __m256i x = mulVector(table, _mm256_loadu_si256((const __m256i*)(src + i)));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_xor_si256(x, _mm256_loadu_si256((const __m256i*)(in + i))));
+    }
+#elif defined(GF2_SSSE3)
+    for(; (i + GF2_VECTOR) <= len; i += GF2_VECTOR)
+    {
+        __m128i x = mulVector(table, _mm_loadu_si128((const __m128i*)(src + i)));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_xor_si128(x, _mm_loadu_si128((const __m128i*)(in + i))));
+    }
+#endif
+    for(; i < len; i++)
+        out[i] = in[i] ^ table[src[i] & 0x0F] ^ table[16 + (src[i] >> 4)];
+}
+
+/**
+ * @brief Evaluate polynomials with region coefficients at a constant point
+ * @param *table Region table of the point (see regionTable())
+ * @param *src n coefficient regions, the highest degree first
+ * @param stride Distance between coefficient regions in bytes
+ * @param n Number of coefficients
+ * @param *dst Destination region, dst = sum of src_i*c^(n-1-i)
+ * @param len Region length in bytes
+ */
+void GF2::evalRegion(const uint8_t *table, const uint8_t *src, size_t stride, uint16_t n, uint8_t *dst, size_t len)
+{
+    size_t i = 0;
+#if defined(GF2_AVX2)
+    //Horner's scheme is a dependency chain, so two independent vectors are interleaved
+    for(; (i + 2 * GF2_VECTOR) <= len; i += 2 * GF2_VECTOR)
+    {
+        __m256i acc0 = _mm256_setzero_si256(), acc1 = _mm256_setzero_si256();
+        for(uint16_t j = 0; j < n; j++)
+        {
+            acc0 = _mm256_xor_si256(mulVector(table, acc0), _mm256_loadu_si256((const __m256i*)(src + j * stride + i)));
+            acc1 = _mm256_xor_si256(mulVector(table, acc1), _mm256_loadu_si256((const __m256i*)(src + j * stride + i + GF2_VECTOR)));
+        }
+        _mm256_storeu_si256((__m256i*)(dst + i), acc0);
+        _mm256_storeu_si256((__m256i*)(dst + i + GF2_VECTOR), acc1);
+    }
+    for(; (i + GF2_VECTOR) <= len; i += GF2_VECTOR)
+    {
+        __m256i acc = _mm256_setzero_si256();
+        for(uint16_t j = 0; j < n; j++)
+            acc = _mm256_xor_si256(mulVector(table, acc), _mm256_loadu_si256((const __m256i*)(src + j * stride + i)));
+        _mm256_storeu_si256((__m256i*)(dst + i), acc);
+    }
+#elif defined(GF2_SSSE3)
+    for(; (i + GF2_VECTOR) <= len; i += GF2_VECTOR)
+    {
+        __m128i acc = _mm_setzero_si128();
+        for(uint16_t j = 0; j < n; j++)
+            acc = _mm_xor_si128(mulVector(table, acc), _mm_loadu_si128((const __m128i*)(src + j * stride + i)));
+        _mm_storeu_si128((__m128i*)(dst + i), acc);
+    }
+#endif
+    //remaining columns are independent, so they are advanced together to avoid a single dependency chain
+    if(i < len)
+        memset(dst + i, 0, len - i);
+    for(uint16_t j = 0; j < n; j++)
+    {
+        for(size_t k = i; k < len; k++)
+        {
+            uint8_t acc = dst[k];
+            dst[k] = table[acc & 0x0F] ^ table[16 + (acc >> 4)] ^ src[j * stride + k];
+        }
+    }
+}
+
+/**
+ * @brief Check dot product of constants and regions against expected region
+ * @param *tables Region tables of constants (32 bytes each, see regionTable())
+ * @param **src Source regions
+ * @param n Number of source regions
+ * @param *expected Expected dot product
+ * @param len Region length in bytes
+ * @return 0 if sum of c_i*src_i is equal to the expected region
+ */
+uint8_t GF2::dotCheck(const uint8_t *tables, const uint8_t * const *src, uint16_t n, const uint8_t *expected, size_t len)
+{
+    size_t i = 0;
+#if defined(GF2_AVX2)
+    for(; (i + GF2_VECTOR) <= len; i += GF2_VECTOR)
+    {
+        __m256i acc = _mm256_loadu_si256((const __m256i*)(expected + i));
+        for(uint16_t j = 0; j < n; j++)
+            acc = _mm256_xor_si256(acc, mulVector(tables + (j << 5), _mm256_loadu_si256((const __m256i*)(src[j] + i))));
+        if(!_mm256_testz_si256(acc, acc))
+            return 1;
+    }
+#elif defined(GF2_SSSE3)
+    for(; (i + GF2_VECTOR) <= len; i += GF2_VECTOR)
+    {
+        __m128i acc = _mm_loadu_si128((const __m128i*)(expected + i));
+        for(uint16_t j = 0; j < n; j++)
+            acc = _mm_xor_si128(acc, mulVector(tables + (j << 5), _mm_loadu_si128((const __m128i*)(src[j] + i))));
+        if(_mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) != 0xFFFF)
+            return 1;
+    }
+#endif
+    for(; i < len; i++)
+    {
+        uint8_t acc = expected[i];
+        for(uint16_t j = 0; j < n; j++)
+        {
+            uint8_t x = src[j][i];
+            acc ^= tables[(j << 5) + (x & 0x0F)] ^ tables[(j << 5) + 16 + (x >> 4)];
+        }
+        if(acc)
+            return 1;
+    }
+    return 0;
+}
+
+/*
+ * Element-wise multiplication and division of two regions. The best kernel is selected at run time,
+ * so that a generic build still uses the instruction set extensions of the machine it runs on:
+ * - GFNI multiplies modulo 0x11B (the AES polynomial), so operands are mapped to that field with GF2P8AFFINEQB
+ *   using field isomorphism matrices stored with lookup tables, multiplied there and mapped back,
+ * - AVX-512 VBMI looks up logarithms and exponents in 256-entry tables held in registers with two VPERMI2B,
+ * - AVX2 multiplies by shift-and-add over the bits of the multiplier, like invertBatch() does,
+ * - otherwise (and for division without GFNI or VBMI) the scalar log/exp lookup is used.
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define GF2_DISPATCH
+#endif
+
+typedef void (*GF2RegionsKernel)(const uint8_t *tables, const uint8_t *x, const uint8_t *y, uint8_t *dst, size_t len, bool divide);
+
+/**
+ * @brief Multiply or divide regions element-wise using log/exp lookup
+ * @param *tables Field tables: 512 exponents, 256 logarithms
+ * @param *x Multiplicands or dividends
+ * @param *y Multipliers or divisors
+ * @param *dst Destination region
+ * @param len Region length in bytes
+ * @param divide Divide instead of multiply
+ */
+static void regionsScalar(const uint8_t *tables, const uint8_t *x, const uint8_t *y, uint8_t *dst, size_t len, bool divide)
+{
+    const uint8_t *exp = tables, *log = tables + 512;
+    for(size_t i = 0; i < len; i++)
+    {
+        uint8_t a = x[i], b = y[i];
+        if((a == 0) || (b == 0))
+            dst[i] = 0;
+        else
+            dst[i] = divide ? exp[log[a] + 255 - log[b]] : exp[log[a] + log[b]];
+    }
+}
+
+#ifdef GF2_DISPATCH
+/**
+ * @brief Multiply or divide regions element-wise using GFNI with 512-bit vectors
+ */
+__attribute__((target("avx512f,avx512bw,gfni")))
+static void regionsGFNI512(const uint8_t *tables, const uint8_t *x, const uint8_t *y, uint8_t *dst, size_t len, bool divide)
+{
+    uint64_t m[2];
+    memcpy(m, tables + 768, 16);
+    const __m512i to = _mm512_set1_epi64((long long)m[0]);
+    const __m512i from = _mm512_set1_epi64((long long)m[1]);
+    const __m512i identity = _mm512_set1_epi64(0x0102040810204080LL);
+    for(size_t i = 0; i < len; i += 64)
+    {
+        __mmask64 k = ((len - i) >= 64) ? ~(__mmask64)0 : (((__mmask64)1 << (len - i)) - 1);
+        __m512i a = _mm512_gf2p8affine_epi64_epi8(_mm512_maskz_loadu_epi8(k, x + i), to, 0);
+        __m512i b = _mm512_gf2p8affine_epi64_epi8(_mm512_maskz_loadu_epi8(k, y + i), to, 0);
+        if(divide)
+            b = _mm512_gf2p8affineinv_epi64_epi8(b, identity, 0); //inverse of 0 is 0
+        __m512i r = _mm512_gf2p8affine_epi64_epi8(_mm512_gf2p8mul_epi8(a, b), from, 0);
+        _mm512_mask_storeu_epi8(dst + i, k, r);
+    }
+}
+
+/**
+ * @brief Multiply or divide regions element-wise using GFNI with 256-bit vectors
+ */
+__attribute__((target("avx2,gfni")))
+static void regionsGFNI256(const uint8_t *tables, const uint8_t *x, const uint8_t *y, uint8_t *dst, size_t len, bool divide)
+{
+    uint64_t m[2];
+    memcpy(m, tables + 768, 16);
+    const __m256i to = _mm256_set1_epi64x((long long)m[0]);
+    const __m256i from = _mm256_set1_epi64x((long long)m[1]);
+    const __m256i identity = _mm256_set1_epi64x(0x0102040810204080LL);
+    size_t i = 0;
+    for(; (i + 32) <= len; i += 32)
+    {
+        __m256i a = _mm256_gf2p8affine_epi64_epi8(_mm256_loadu_si256((const __m256i*)(x + i)), to, 0);
+        __m256i b = _mm256_gf2p8affine_epi64_epi8(_mm256_loadu_si256((const __m256i*)(y + i)), to, 0);
+        if(divide)
+            b = _mm256_gf2p8affineinv_epi64_epi8(b, identity, 0);
+        __m256i r = _mm256_gf2p8affine_epi64_epi8(_mm256_gf2p8mul_epi8(a, b), from, 0);
+        _mm256_storeu_si256((__m256i*)(dst + i), r);
+    }
+    regionsScalar(tables, x + i, y + i, dst + i, len - i, divide);
+}
+
+/**
+ * @brief Look up 64 bytes in a 256-entry table held in four registers
+ * @param *t Table registers
+ * @param idx Indexes
+ * @return Table entries
+ */
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+static inline __m512i lookup256(const __m512i *t, __m512i idx)
+{
+    //VPERMI2B selects from 128 entries by the low 7 bits, the highest bit selects the table half
+    __m512i lo = _mm512_permutex2var_epi8(t[0], idx, t[1]);
+    __m512i hi = _mm512_permutex2var_epi8(t[2], idx, t[3]);
+    return _mm512_mask_blend_epi8(_mm512_movepi8_mask(idx), lo, hi);
+}
+
+/**
+ * @brief Multiply or divide regions element-wise using log/exp lookup with AVX-512 VBMI
+ */
+__attribute__((target("avx512f,avx512bw,avx512vbmi")))
+static void regionsVBMI(const uint8_t *tables, const uint8_t *x, const uint8_t *y, uint8_t *dst, size_t len, bool divide)
+{
+    __m512i exp[4], log[4];
+    for(uint8_t j = 0; j < 4; j++)
+    {
+        exp[j] = _mm512_loadu_si512(tables + 64 * j);
+        log[j] = _mm512_loadu_si512(tables + 512 + 64 * j);
+    }
+    const __m512i one = _mm512_set1_epi8(1);
+    for(size_t i = 0; i < len; i += 64)
+    {
+        __mmask64 k = ((len - i) >= 64) ? ~(__mmask64)0 : (((__mmask64)1 << (len - i)) - 1);
+        __m512i a = _mm512_maskz_loadu_epi8(k, x + i);
+        __m512i b = _mm512_maskz_loadu_epi8(k, y + i);
+        __mmask64 nonZero = _mm512_test_epi8_mask(a, a) & _mm512_test_epi8_mask(b, b);
+        __m512i la = lookup256(log, a), lb = lookup256(log, b), s;
+        //logarithms are added (subtracted) modulo 255: a carry (borrow) out of 8 bits is worth 256 = 1 (mod 255)
+        if(divide)
+        {
+            s = _mm512_sub_epi8(la, lb);
+            s = _mm512_mask_sub_epi8(s, _mm512_cmplt_epu8_mask(la, lb), s, one);
+        }
+        else
+        {
+            s = _mm512_add_epi8(la, lb);
+            s = _mm512_mask_add_epi8(s, _mm512_cmplt_epu8_mask(s, la), s, one);
+        }
+        __m512i r = _mm512_maskz_mov_epi8(nonZero, lookup256(exp, s)); //exp[255] = exp[0]
+        _mm512_mask_storeu_epi8(dst + i, k, r);
+    }
+}
+
+/**
+ * @brief Multiply regions element-wise using shift-and-add with AVX2, divide using scalar lookup
+ */
+__attribute__((target("avx2")))
+static void regionsAVX2(const uint8_t *tables, const uint8_t *x, const uint8_t *y, uint8_t *dst, size_t len, bool divide)
+{
+    if(divide)
+    {
+        regionsScalar(tables, x, y, dst, len, divide);
+        return;
+    }
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i poly = _mm256_set1_epi8((char)tables[8]); //x^8 = poly without the x^8 term
+    size_t i = 0;
+    for(; (i + 32) <= len; i += 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(x + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(y + i));
+        __m256i r = zero;
+        //Horner's scheme from the highest multiplier bit: r = r*x + a*b_j
+        for(uint8_t j = 0; j < 8; j++)
+        {
+            __m256i carry = _mm256_cmpgt_epi8(zero, r);
+            r = _mm256_xor_si256(_mm256_add_epi8(r, r), _mm256_and_si256(carry, poly));
+            r = _mm256_xor_si256(r, _mm256_and_si256(a, _mm256_cmpgt_epi8(zero, b)));
+            b = _mm256_add_epi8(b, b);
+        }
+        _mm256_storeu_si256((__m256i*)(dst + i), r);
+    }
+    regionsScalar(tables, x + i, y + i, dst + i, len - i, divide);
+}
+#endif
+
+/**
+ * @brief Select the best element-wise kernel for this machine
+ * @return Kernel
+ */
+static GF2RegionsKernel selectRegionsKernel(void)
+{
+#ifdef GF2_DISPATCH
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("gfni") && __builtin_cpu_supports("avx512bw"))
+        return regionsGFNI512;
+    if(__builtin_cpu_supports("avx512vbmi"))
+        return regionsVBMI;
+    if(__builtin_cpu_supports("gfni") && __builtin_cpu_supports("avx2"))
+        return regionsGFNI256;
+    if(__builtin_cpu_supports("avx2"))
+        return regionsAVX2;
+#endif
+    return regionsScalar;
+}
+
+/**
+ * @brief Multiply two regions element by element
+ * @param *x Multiplicands
+ * @param *y Multipliers
+ * @param *dst Destination region, dst_i = x_i*y_i, may be the same as x or y
+ * @param len Region length in bytes
+ */
+void GF2::mulRegions(const uint8_t *x, const uint8_t *y, uint8_t *dst, size_t len)
+{
+    static const GF2RegionsKernel kernel = selectRegionsKernel();
+    kernel(exp, x, y, dst, len, false);
+}
+
+/**
+ * @brief Divide two regions element by element
+ * @param *x Dividends
+ * @param *y Divisors
+ * @param *dst Destination region, dst_i = x_i/y_i (0 if y_i is 0), may be the same as x or y
+ * @param len Region length in bytes
+ */
+void GF2::divRegions(const uint8_t *x, const uint8_t *y, uint8_t *dst, size_t len)
+{
+    static const GF2RegionsKernel kernel = selectRegionsKernel();
+    kernel(exp, x, y, dst, len, true);
+}
+
+/*
+ * Lane-wise arithmetic for batched matrix inversion. Every byte lane holds an element of a different system,
+ * so multiplication cannot use constant tables and is done by shift-and-add over the bits of the multiplier.
+ * The multiplier is expanded to 8 lane masks first, as it is reused for a whole matrix row.
+ */
+#if defined(GF2_AVX2)
+struct GF2Lanes
+{
+    typedef __m256i type;
+    static const size_t lanes = 32;
+    static inline type load(const uint8_t *p) {return _mm256_loadu_si256((const __m256i*)p);}
+    static inline void store(uint8_t *p, type x) {_mm256_storeu_si256((__m256i*)p, x);}
+    static inline type zero(void) {return _mm256_setzero_si256();}
+    static inline type one(void) {return _mm256_set1_epi8(1);}
+    static inline type bxor(type x, type y) {return _mm256_xor_si256(x, y);}
+    static inline type band(type x, type y) {return _mm256_and_si256(x, y);}
+    static inline type bor(type x, type y) {return _mm256_or_si256(x, y);}
+    static inline type andNot(type x, type y) {return _mm256_andnot_si256(x, y);} //~x & y
+    static inline type isZero(type x) {return _mm256_cmpeq_epi8(x, _mm256_setzero_si256());}
+    static inline bool any(type x) {return !_mm256_testz_si256(x, x);}
+    static inline type top(type x) {return _mm256_cmpgt_epi8(_mm256_setzero_si256(), x);} //0xFF where bit 7 is set
+    static inline type shift(type x) {return _mm256_add_epi8(x, x);}
+    static inline type xtime(type x) {return _mm256_xor_si256(_mm256_add_epi8(x, x), _mm256_and_si256(top(x), _mm256_set1_epi8(GF2_POLY & 0xFF)));}
+};
+#elif defined(GF2_SSSE3)
+struct GF2Lanes
+{
+    typedef __m128i type;
+    static const size_t lanes = 16;
+    static inline type load(const uint8_t *p) {return _mm_loadu_si128((const __m128i*)p);}
+    static inline void store(uint8_t *p, type x) {_mm_storeu_si128((__m128i*)p, x);}
+    static inline type zero(void) {return _mm_setzero_si128();}
+    static inline type one(void) {return _mm_set1_epi8(1);}
+    static inline type bxor(type x, type y) {return _mm_xor_si128(x, y);}
+    static inline type band(type x, type y) {return _mm_and_si128(x, y);}
+    static inline type bor(type x, type y) {return _mm_or_si128(x, y);}
+    static inline type andNot(type x, type y) {return _mm_andnot_si128(x, y);}
+    static inline type isZero(type x) {return _mm_cmpeq_epi8(x, _mm_setzero_si128());}
+    static inline bool any(type x) {return _mm_movemask_epi8(_mm_cmpeq_epi8(x, _mm_setzero_si128())) != 0xFFFF;}
+    static inline type top(type x) {return _mm_cmpgt_epi8(_mm_setzero_si128(), x);}
+    static inline type shift(type x) {return _mm_add_epi8(x, x);}
+    static inline type xtime(type x) {return _mm_xor_si128(_mm_add_epi8(x, x), _mm_and_si128(top(x), _mm_set1_epi8(GF2_POLY & 0xFF)));}
+};
+#else
+//portable fallback, 8 lanes in a 64-bit word
+struct GF2Lanes
+{
+    typedef uint64_t type;
+    static const size_t lanes = 8;
+    static inline type load(const uint8_t *p) {type x; memcpy(&x, p, 8); return x;}
+    static inline void store(uint8_t *p, type x) {memcpy(p, &x, 8);}
+    static inline type zero(void) {return 0;}
+    static inline type one(void) {return 0x0101010101010101ULL;}
+    static inline type bxor(type x, type y) {return x ^ y;}
+    static inline type band(type x, type y) {return x & y;}
+    static inline type bor(type x, type y) {return x | y;}
+    static inline type andNot(type x, type y) {return ~x & y;}
+    static inline type isZero(type x)
+    {
+        //bit 7 of every lane is set if the lane is non-zero
+        type t = (x | ((x & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL)) & 0x8080808080808080ULL;
+        return ((~t & 0x8080808080808080ULL) >> 7) * 0xFF;
+    }
+    static inline bool any(type x) {return x != 0;}
+    static inline type top(type x) {return ((x >> 7) & 0x0101010101010101ULL) * 0xFF;}
+    static inline type shift(type x) {return (x & 0x7F7F7F7F7F7F7F7FULL) << 1;}
+    static inline type xtime(type x) {return shift(x) ^ (top(x) & (0x0101010101010101ULL * (GF2_POLY & 0xFF)));}
+};
+#endif
+
+/**
+ * @brief Expand lane multipliers to bit masks
+ * @param x Multipliers
+ * @param *mask Output 8 masks, from the most significant bit
+ */
+static inline void expandLanes(GF2Lanes::type x, GF2Lanes::type *mask)
+{
+    for(uint8_t i = 0; i < 8; i++)
+    {
+        mask[i] = GF2Lanes::top(x);
+        x = GF2Lanes::shift(x);
+    }
+}
+
+/**
+ * @brief Multiply lanes by expanded multipliers
+ * @param *mask Multiplier masks from expandLanes()
+ * @param x Multiplicands
+ * @return Products
+ */
+static inline GF2Lanes::type mulLanes(const GF2Lanes::type *mask, GF2Lanes::type x)
+{
+    //Horner's scheme from the most significant bit
+    GF2Lanes::type acc = GF2Lanes::band(mask[0], x);
+    for(uint8_t i = 1; i < 8; i++)
+        acc = GF2Lanes::bxor(GF2Lanes::xtime(acc), GF2Lanes::band(mask[i], x));
+    return acc;
+}
+
+/**
+ * @brief Invert lanes
+ * @param x Lanes
+ * @return x^254, which is the inverse for non-zero lanes and 0 for zero lanes
+ */
+static inline GF2Lanes::type invLanes(GF2Lanes::type x)
+{
+    GF2Lanes::type mask[8], y = x, r;
+    //x^(2^i - 1) for i = 2...7, then squared
+    for(uint8_t i = 0; i < 6; i++)
+    {
+        expandLanes(y, mask);
+        r = mulLanes(mask, y); //y^2
+        expandLanes(r, mask);
+        y = mulLanes(mask, x); //y^2 * x
+    }
+    expandLanes(y, mask);
+    return mulLanes(mask, y);
+}
+
+/**
+ * @brief Invert many small matrices at once
+ * @param *a Matrices in structure-of-arrays layout: element (r, c) of matrix b is a[(r*n + c)*count + b]. Replaced with inverses
+ * @param n Matrix size, 1...GF2_BATCH_MAX
+ * @param count Number of matrices
+ * @param *singular Output flags, non-zero if matrix b is singular (its output is undefined), may be nullptr
+ * @return Number of singular matrices
+ */
+size_t GF2::invertBatch(uint8_t *a, uint8_t n, size_t count, uint8_t *singular)
+{
+    if((n == 0) || (n > GF2_BATCH_MAX))
+    {
+        if(singular != nullptr)
+            memset(singular, 1, count);
+        return count;
+    }
+
+    typedef GF2Lanes V;
+    const size_t L = V::lanes;
+    uint16_t nn = (uint16_t)n * n;
+    V::type m[GF2_BATCH_MAX * GF2_BATCH_MAX], x[GF2_BATCH_MAX * GF2_BATCH_MAX], mask[8];
+    uint8_t lanes[GF2_BATCH_MAX * GF2_BATCH_MAX * V::lanes];
+    size_t ret = 0;
+
+    for(size_t b = 0; b < count; b += L)
+    {
+        size_t used = ((count - b) < L) ? (count - b) : L;
+        //load L systems, a partial group is padded with identity matrices
+        for(uint16_t e = 0; e < nn; e++)
+        {
+            if(used == L)
+                m[e] = V::load(a + e * count + b);
+            else
+            {
+                memset(lanes, ((e / n) == (e % n)) ? 1 : 0, L);
+                memcpy(lanes, a + e * count + b, used);
+                m[e] = V::load(lanes);
+            }
+            x[e] = ((e / n) == (e % n)) ? V::one() : V::zero();
+        }
+
+        V::type sing = V::zero();
+        for(uint8_t c = 0; c < n; c++)
+        {
+            //lanes with zero pivot add the first following row with non-zero entry in this column
+            for(uint8_t r = c + 1; r < n; r++)
+            {
+                V::type zero = V::isZero(m[c * n + c]);
+                if(!V::any(zero))
+                    break; //all pivots are non-zero
+                V::type need = V::andNot(V::isZero(m[r * n + c]), zero);
+                for(uint8_t j = c; j < n; j++)
+                    m[c * n + j] = V::bxor(m[c * n + j], V::band(need, m[r * n + j]));
+                for(uint8_t j = 0; j < n; j++)
+                    x[c * n + j] = V::bxor(x[c * n + j], V::band(need, x[r * n + j]));
+            }
+            sing = V::bor(sing, V::isZero(m[c * n + c]));
+
+            //normalize pivot row
+            expandLanes(invLanes(m[c * n + c]), mask);
+            for(uint8_t j = c; j < n; j++)
+                m[c * n + j] = mulLanes(mask, m[c * n + j]);
+            for(uint8_t j = 0; j < n; j++)
+                x[c * n + j] = mulLanes(mask, x[c * n + j]);
+
+            //eliminate column from other rows
+            for(uint8_t r = 0; r < n; r++)
+            {
+                if((r == c) || !V::any(m[r * n + c]))
+                    continue;
+                expandLanes(m[r * n + c], mask);
+                for(uint8_t j = c; j < n; j++)
+                    m[r * n + j] = V::bxor(m[r * n + j], mulLanes(mask, m[c * n + j]));
+                for(uint8_t j = 0; j < n; j++)
+                    x[r * n + j] = V::bxor(x[r * n + j], mulLanes(mask, x[c * n + j]));
+            }
+        }
+
+        for(uint16_t e = 0; e < nn; e++)
+        {
+            if(used == L)
+                V::store(a + e * count + b, x[e]);
+            else
+            {
+                V::store(lanes, x[e]);
+                memcpy(a + e * count + b, lanes, used);
+            }
+        }
+        V::store(lanes, sing);
+        for(size_t i = 0; i < used; i++)
+        {
+            if(lanes[i])
+                ret++;
+            if(singular != nullptr)
+                singular[b + i] = (lanes[i] != 0);
+        }
     }
     return ret;
 }
@@ -112,35 +810,174 @@ uint8_t GF2::slowMul(uint8_t x, uint8_t y)
  * @brief Check if object is initialized
  * @return 0 if initialized
  */
-uint8_t isInitialized(void)
+uint8_t GF2::isInitialized(void)
+{
+    if(exp != nullptr) //tables are missing if the polynomial is not primitive or the object was moved from
+        return 0;
+
+    return 1;
+}
+
+/**
+ * @brief Multiply modulo the AES polynomial, which is used by GFNI
+ * @param x Multiplicand
+ * @param y Multiplier
+ * @return Product modulo 0x11B
+ */
+static uint8_t mulAES(uint8_t x, uint8_t y)
 {
-	return 0; //it must be initialized if the constructor was called
+    uint8_t ret = 0;
+    uint16_t x_ = x;
+    while(y)
+    {
+        if(y & 1)
+            ret ^= x_;
+        y >>= 1;
+        x_ <<= 1;
+        if(x_ & 256) x_ ^= 0x11B;
+    }
+    return ret;
 }
 
+/**
+ * @brief Build GF2P8AFFINEQB matrix of a linear map
+ * @param *columns Images of bits 0...7
+ * @return Matrix, byte 7-i selects input bits of output bit i
+ */
+static uint64_t affineMatrix(const uint8_t *columns)
+{
+    uint64_t ret = 0;
+    for(uint8_t i = 0; i < 8; i++)
+    {
+        uint8_t row = 0;
+        for(uint8_t j = 0; j < 8; j++)
+            row |= ((columns[j] >> i) & 1) << j;
+        ret |= (uint64_t)row << (8 * (7 - i));
+    }
+    return ret;
+}
 
-GF2::GF2()
+/**
+ * @brief Build lookup tables
+ * @param poly Field polynomial
+ * @return Tables: 512 exponent entries, 256 logarithm entries and isomorphism matrices to and from
+ * the AES field (8 bytes each), empty if polynomial is not primitive
+ */
+static std::shared_ptr<const uint8_t> buildTables(uint16_t poly)
 {
-    exp = new uint8_t[512];
-    log = new uint8_t[256];
+    uint8_t *t = new uint8_t[512 + 256 + 16]();
+    uint8_t *exp = t;
+    uint8_t *log = t + 512;
 
-    uint8_t x = 1;
+    uint16_t x = 1;
     //fill logarithm and exponential f. lookup tables for all possible values
     for(uint16_t i = 0; i < 256; i++)
     {
-        exp[i] = x;
-        log[x] = i;
-        x = slowMul(x, 2);
+        if((x == 0) || ((i > 0) && (i < 255) && (x == 1)) || ((i == 255) && (x != 1)))
+        {
+            delete[] t; //x is not a generator, so the polynomial is not primitive
+            return std::shared_ptr<const uint8_t>();
+        }
+        exp[i] = (uint8_t)x;
+        log[x] = (uint8_t)i;
+        x <<= 1; //multiply x by 2
+        if(x & 256) x ^= poly; //apply modular reduction, the same as in slowMul()
     }
     for(uint16_t i = 256; i < 512; i++)
     {
         exp[i] = exp[i - 255]; //this is not necessary, but it will make things easier
     }
+
+    //the isomorphism to the AES field maps x to a root r of the field polynomial, so x^i goes to r^i
+    uint8_t to[8], from[8], map[256];
+    for(uint16_t r = 2; r < 256; r++)
+    {
+        uint8_t acc = 0, p = 1;
+        for(uint8_t i = 0; i <= 8; i++)
+        {
+            if((poly >> i) & 1)
+                acc ^= p;
+            p = mulAES(p, (uint8_t)r);
+        }
+        if(acc == 0)
+        {
+            p = 1;
+            for(uint8_t i = 0; i < 8; i++)
+            {
+                to[i] = p;
+                p = mulAES(p, (uint8_t)r);
+            }
+            break;
+        }
+    }
+    for(uint16_t v = 0; v < 256; v++)
+    {
+        uint8_t y = 0;
+        for(uint8_t i = 0; i < 8; i++)
+        {
+            if((v >> i) & 1)
+                y ^= to[i];
+        }
+        map[y] = (uint8_t)v;
+    }
+    for(uint8_t i = 0; i < 8; i++)
+        from[i] = map[1 << i];
+    uint64_t m[2] = {affineMatrix(to), affineMatrix(from)};
+    memcpy(t + 768, m, 16);
+    return std::shared_ptr<const uint8_t>(t, std::default_delete<const uint8_t[]>());
+}
+
+/**
+ * @brief Initializes GF(2^8) object
+ * @param poly Primitive field polynomial of degree 8
+ */
+GF2::GF2(uint16_t poly)
+{
+    this->poly = poly;
+    exp = nullptr;
+    log = nullptr;
+    if((poly & 0xFF00) != 0x100)
+        return;
+
+    if(poly == GF2_POLY)
+    {
+        //default tables are built only once, thread-safe since C++11
+        static const std::shared_ptr<const uint8_t> shared = buildTables(GF2_POLY);
+        tables = shared;
+    }
+    else
+        tables = buildTables(poly); //shared only by copies of this object
+    if(tables == nullptr)
+        return;
+    exp = tables.get();
+    log = exp + 512;
+}
+
+/**
+ * @brief Get field polynomial
+ * @return Polynomial
+ */
+uint16_t GF2::getPoly(void)
+{
+    return poly;
 }
 
-GF2::~GF2()
+GF2::GF2(GF2 &&other) noexcept : tables(std::move(other.tables)), exp(other.exp), log(other.log), poly(other.poly)
 {
-	if(exp != nullptr)
-		delete [] exp;
-	if(log != nullptr)
-		delete [] log;
+    other.exp = nullptr;
+    other.log = nullptr;
+}
+
+GF2 &GF2::operator=(GF2 &&other) noexcept
+{
+    if(this != &other)
+    {
+        tables = std::move(other.tables);
+        exp = other.exp;
+        log = other.log;
+        poly = other.poly;
+        other.exp = nullptr;
+        other.log = nullptr;
+    }
+    return *this;
 }
@@ -27,9 +27,18 @@
 #define GF2_H
 
 #include <stdint.h>
+#include <stddef.h>
+#include <memory>
 
-#define GF2_POLY 0x11d //primitive polynomial for division within the GF(2^8)
+#define GF2_POLY 0x11d //default primitive polynomial for division within the GF(2^8)
+#define GF2_BATCH_MAX 16 //maximum matrix size for batched inversion
 
+/**
+ * @brief This class provides handling of GF(2^8) field
+ *
+ * Lookup tables are immutable and shared by all GF2 objects using the default polynomial (and by copies of objects
+ * using other polynomials), so objects can be copied and moved freely without any allocation.
+ */
 class GF2
 {
 public:
@@ -87,21 +96,137 @@ public:
 	 */
 	uint8_t slowMul(uint8_t x, uint8_t y);
 
+	/**
+	 * @brief Prepare region multiplication table for a constant
+	 * @param c Constant
+	 * @param *table Output table of 32 bytes: c*x for x=0...15, then c*(x<<4) for x=0...15
+	 * Every byte is multiplied by looking up its low and high nibble separately, which maps directly to SIMD shuffles.
+	 */
+	void regionTable(uint8_t c, uint8_t *table);
+
+	/**
+	 * @brief Multiply region by a constant
+	 * @param c Constant
+	 * @param *src Source region
+	 * @param *dst Destination region, may be the same as source
+	 * @param len Region length in bytes
+	 */
+	void mulRegion(uint8_t c, const uint8_t *src, uint8_t *dst, size_t len);
+
+	/**
+	 * @brief Multiply region by a constant and add it to the destination region
+	 * @param c Constant
+	 * @param *src Source region
+	 * @param *dst Destination region
+	 * @param len Region length in bytes
+	 */
+	void mulAddRegion(uint8_t c, const uint8_t *src, uint8_t *dst, size_t len);
+
+	/**
+	 * @brief Multiply region by a constant and add another region
+	 * @param *table Region table of the constant (see regionTable())
+	 * @param *src Source region
+	 * @param *in Region to be added, nullptr if none
+	 * @param *out Output region, out = in + c*src, may be the same as in
+	 * @param len Region length in bytes
+	 * Every byte is loaded and stored once, so this is the kernel for accumulating partial sums.
+	 */
+	static void mulXorRegion(const uint8_t *table, const uint8_t *src, const uint8_t *in, uint8_t *out, size_t len);
+
+	/**
+	 * @brief Evaluate polynomials with region coefficients at a constant point
+	 * @param *table Region table of the point (see regionTable())
+	 * @param *src n coefficient regions, the highest degree first
+	 * @param stride Distance between coefficient regions in bytes
+	 * @param n Number of coefficients
+	 * @param *dst Destination region, dst = sum of src_i*c^(n-1-i)
+	 * @param len Region length in bytes
+	 * Every byte column is a separate polynomial evaluated with Horner's scheme, with the point table kept in registers.
+	 */
+	static void evalRegion(const uint8_t *table, const uint8_t *src, size_t stride, uint16_t n, uint8_t *dst, size_t len);
+
+	/**
+	 * @brief Calculate dot product of constants and regions
+	 * @param *tables Region tables of constants (32 bytes each, see regionTable())
+	 * @param **src Source regions
+	 * @param n Number of source regions
+	 * @param *dst Destination region, dst = sum of c_i*src_i
+	 * @param len Region length in bytes
+	 * The sum is accumulated in registers and stored once.
+	 */
+	static void dotRegion(const uint8_t *tables, const uint8_t * const *src, uint16_t n, uint8_t *dst, size_t len);
+
+	/**
+	 * @brief Check dot product of constants and regions against expected region
+	 * @param *tables Region tables of constants (32 bytes each, see regionTable())
+	 * @param **src Source regions
+	 * @param n Number of source regions
+	 * @param *expected Expected dot product
+	 * @param len Region length in bytes
+	 * @return 0 if sum of c_i*src_i is equal to the expected region
+	 * Nothing is stored and the calculation stops at the first mismatch.
+	 */
+	static uint8_t dotCheck(const uint8_t *tables, const uint8_t * const *src, uint16_t n, const uint8_t *expected, size_t len);
+
+	/**
+	 * @brief Multiply two regions element by element
+	 * @param *x Multiplicands
+	 * @param *y Multipliers
+	 * @param *dst Destination region, dst_i = x_i*y_i, may be the same as x or y
+	 * @param len Region length in bytes
+	 * The kernel (GFNI, AVX-512 VBMI, AVX2 or scalar) is selected at run time.
+	 */
+	void mulRegions(const uint8_t *x, const uint8_t *y, uint8_t *dst, size_t len);
+
+	/**
+	 * @brief Divide two regions element by element
+	 * @param *x Dividends
+	 * @param *y Divisors
+	 * @param *dst Destination region, dst_i = x_i/y_i (0 if y_i is 0), may be the same as x or y
+	 * @param len Region length in bytes
+	 * The kernel (GFNI, AVX-512 VBMI or scalar) is selected at run time.
+	 */
+	void divRegions(const uint8_t *x, const uint8_t *y, uint8_t *dst, size_t len);
+
+	/**
+	 * @brief Invert many small matrices at once
+	 * @param *a Matrices in structure-of-arrays layout: element (r, c) of matrix b is a[(r*n + c)*count + b]. Replaced with inverses
+	 * @param n Matrix size, 1...GF2_BATCH_MAX
+	 * @param count Number of matrices
+	 * @param *singular Output flags, non-zero if matrix b is singular (its output is undefined), may be nullptr
+	 * @return Number of singular matrices
+	 * Every SIMD byte lane runs Gauss-Jordan elimination of a different matrix, with its own pivoting.
+	 * The field is always the one defined by GF2_POLY.
+	 */
+	static size_t invertBatch(uint8_t *a, uint8_t n, size_t count, uint8_t *singular = nullptr);
+
 	/**
 	 * @brief Check if object is initialized
 	 * @return 0 if initialized
 	 */
 	uint8_t isInitialized(void);
 
+	/**
+	 * @brief Get field polynomial
+	 * @return Polynomial
+	 */
+	uint16_t getPoly(void);
+
 	/**
 	 * @brief Initializes GF(2^8) object
+	 * @param poly Primitive field polynomial of degree 8, object is not initialized if it is not primitive
 	 */
-	GF2();
-	~GF2();
+	explicit GF2(uint16_t poly = GF2_POLY);
+	GF2(const GF2 &other) = default;
+	GF2(GF2 &&other) noexcept;
+	GF2 &operator=(const GF2 &other) = default;
+	GF2 &operator=(GF2 &&other) noexcept;
 
 private:
-    uint8_t *exp; //exponent lookup table
-    uint8_t *log; //logarithm lookup table
+    std::shared_ptr<const uint8_t> tables; //shared lookup tables, owns exp and log
+    const uint8_t *exp; //exponent lookup table
+    const uint8_t *log; //logarithm lookup table
+    uint16_t poly; //field polynomial
 };
 
 #endif
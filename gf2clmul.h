@@ -0,0 +1,111 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gf2clmul.h
+* @brief Internal carry-less multiplication helpers shared by gf2m.cpp and gf2poly.cpp
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef GF2CLMUL_H
+#define GF2CLMUL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __PCLMUL__
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Carry-less multiplication of 64-bit words
+ * @param x Multiplicand
+ * @param y Multiplier
+ * @param *lo Lower 64 bits of the product
+ * @param *hi Upper 64 bits of the product
+ */
+static inline void clmul64(uint64_t x, uint64_t y, uint64_t *lo, uint64_t *hi)
+{
+#ifdef __PCLMUL__
+    __m128i p = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)x), _mm_cvtsi64_si128((long long)y), 0x00);
+    *lo = (uint64_t)_mm_cvtsi128_si64(p);
+    *hi = (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(p, p)); //SSE2 only, _mm_extract_epi64 would need SSE4.1
+#else
+    //4-bit window: multiples of x by 0...15, the top 3 bits of x are handled separately
+    uint64_t table[16];
+    uint64_t x_ = x & 0x1FFFFFFFFFFFFFFFULL;
+    table[0] = 0;
+    for(uint8_t i = 1; i < 16; i++)
+        table[i] = (i & 1) ? (table[i - 1] ^ x_) : (table[i >> 1] << 1);
+    uint64_t l = 0, h = 0;
+    for(int8_t i = 60; i >= 0; i -= 4)
+    {
+        uint64_t t = table[(y >> i) & 15];
+        l ^= t << i;
+        if(i)
+            h ^= t >> (64 - i);
+    }
+    for(uint8_t i = 61; i < 64; i++)
+    {
+        if((x >> i) & 1)
+        {
+            l ^= y << i;
+            h ^= y >> (64 - i);
+        }
+    }
+    *lo = l;
+    *hi = h;
+#endif
+}
+
+/**
+ * @brief Sum the halves of Karatsuba operands
+ * @param *a Multiplicand, l+h words
+ * @param *b Multiplier, l+h words
+ * @param l Number of words in the lower half
+ * @param h Number of words in the upper half, at most l
+ * @param *sa Output a0+a1, l words
+ * @param *sb Output b0+b1, l words
+ */
+static inline void karatsubaSplit(const uint64_t *a, const uint64_t *b, size_t l, size_t h, uint64_t *sa, uint64_t *sb)
+{
+    for(size_t i = 0; i < l; i++)
+    {
+        sa[i] = a[i] ^ ((i < h) ? a[l + i] : 0);
+        sb[i] = b[i] ^ ((i < h) ? b[l + i] : 0);
+    }
+}
+
+/**
+ * @brief Add Karatsuba middle term to the product
+ * @param *r Product of 2(l+h) words, holding a0*b0 in the lower 2l words and a1*b1 in the upper 2h words
+ * @param l Number of words in the lower half
+ * @param h Number of words in the upper half, at most l
+ * @param *mid (a0+a1)(b0+b1), 2l words, overwritten
+ */
+static inline void karatsubaCombine(uint64_t *r, size_t l, size_t h, uint64_t *mid)
+{
+    //middle term is (a0+a1)(b0+b1) - a0*b0 - a1*b1
+    for(size_t i = 0; i < 2 * l; i++)
+        mid[i] ^= r[i] ^ ((i < 2 * h) ? r[2 * l + i] : 0);
+    for(size_t i = 0; i < 2 * l; i++)
+        r[l + i] ^= mid[i];
+}
+
+#endif
@@ -0,0 +1,574 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gf2m.cpp
+* @brief Multi-limb binary fields GF(2^m) for large m (NIST binary curve fields)
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "gf2m.h"
+#include "gf2clmul.h"
+#include <string.h>
+#include <vector>
+
+/**
+ * @brief Schoolbook multiplication of polynomials over GF(2)
+ * @tparam N Number of limbs
+ * @param *a Multiplicand, N limbs
+ * @param *b Multiplier, N limbs
+ * @param *r Product, 2N limbs
+ */
+template <uint8_t N> static inline void mulSchoolbook(const uint64_t *a, const uint64_t *b, uint64_t *r)
+{
+    for(uint8_t i = 0; i < 2 * N; i++)
+        r[i] = 0;
+    for(uint8_t i = 0; i < N; i++)
+    {
+        for(uint8_t j = 0; j < N; j++)
+        {
+            uint64_t lo, hi;
+            clmul64(a[i], b[j], &lo, &hi);
+            r[i + j] ^= lo;
+            r[i + j + 1] ^= hi;
+        }
+    }
+}
+
+/**
+ * @brief Karatsuba multiplication of polynomials over GF(2)
+ * @tparam N Number of limbs
+ * @param *a Multiplicand, N limbs
+ * @param *b Multiplier, N limbs
+ * @param *r Product, 2N limbs
+ * The operands are split into a lower half of L = ceil(N/2) limbs and an upper half of N-L limbs,
+ * and (a0+a1)(b0+b1) replaces one of the four half products. The limb count is a template parameter,
+ * so that the whole recursion is unrolled for every field size.
+ */
+template <uint8_t N> static inline void mulKaratsuba(const uint64_t *a, const uint64_t *b, uint64_t *r)
+{
+    if constexpr(N <= GF2M_KARATSUBA)
+        mulSchoolbook<N>(a, b, r);
+    else
+    {
+        constexpr uint8_t L = (N + 1) / 2;
+        constexpr uint8_t H = N - L;
+        uint64_t sa[L], sb[L], mid[2 * L];
+
+        mulKaratsuba<L>(a, b, r); //a0*b0 in r[0...2L-1]
+        mulKaratsuba<H>(a + L, b + L, r + 2 * L); //a1*b1 in r[2L...2N-1]
+        karatsubaSplit(a, b, L, H, sa, sb);
+        mulKaratsuba<L>(sa, sb, mid);
+        karatsubaCombine(r, L, H, mid);
+    }
+}
+
+/**
+ * @brief Multiply polynomials of N limbs
+ * @tparam N Number of limbs
+ * @param *a Multiplicand
+ * @param *b Multiplier
+ * @param *r Product, 2N limbs
+ */
+template <uint8_t N> static void mulLimbs(const uint64_t *a, const uint64_t *b, uint64_t *r)
+{
+    mulKaratsuba<N>(a, b, r);
+}
+
+//multiplication routines for 2...GF2M_LIMBS limbs
+static void (*const gf2mMul[GF2M_LIMBS + 1])(const uint64_t*, const uint64_t*, uint64_t*) =
+{
+    nullptr, nullptr, mulLimbs<2>, mulLimbs<3>, mulLimbs<4>, mulLimbs<5>, mulLimbs<6>, mulLimbs<7>, mulLimbs<8>, mulLimbs<9>,
+};
+
+/**
+ * @brief Bit spreading table: bits of the index moved to even positions
+ */
+static const struct GF2mSpread
+{
+    uint16_t t[256];
+    GF2mSpread()
+    {
+        for(uint16_t i = 0; i < 256; i++)
+        {
+            t[i] = 0;
+            for(uint8_t j = 0; j < 8; j++)
+                t[i] |= ((i >> j) & 1) << (2 * j);
+        }
+    }
+} gf2mSpread;
+
+/**
+ * @brief Square polynomial over GF(2)
+ * @param *x Polynomial
+ * @param n Number of limbs
+ * @param *r Square, 2n limbs
+ * Squaring is linear over GF(2), so it only spreads the bits apart: every byte is looked up in a 256-entry table.
+ */
+static inline void sqrLimbs(const uint64_t *x, uint8_t n, uint64_t *r)
+{
+    const uint16_t *t = gf2mSpread.t;
+    for(uint8_t i = 0; i < n; i++)
+    {
+        uint64_t v = x[i];
+        r[2 * i] = (uint64_t)t[v & 0xFF] | ((uint64_t)t[(v >> 8) & 0xFF] << 16)
+                 | ((uint64_t)t[(v >> 16) & 0xFF] << 32) | ((uint64_t)t[(v >> 24) & 0xFF] << 48);
+        r[2 * i + 1] = (uint64_t)t[(v >> 32) & 0xFF] | ((uint64_t)t[(v >> 40) & 0xFF] << 16)
+                     | ((uint64_t)t[(v >> 48) & 0xFF] << 32) | ((uint64_t)t[v >> 56] << 48);
+    }
+}
+
+/**
+ * @brief Reduce product modulo trinomial or pentanomial
+ * @tparam T Number of middle terms
+ * @param *c Product of 2*limbs limbs, reduced in place
+ * @param m Field degree
+ * @param limbs Number of limbs
+ * @param *terms T middle terms followed by 0
+ * Every word above x^m is folded at once, x^(64i+j) = x^(64i+j-m) * (x^k1 + ... + 1), going from the top,
+ * so that the folded bits are reduced again when their word is reached.
+ */
+template <uint8_t T> static inline void reduceTerms(uint64_t *c, uint16_t m, uint8_t limbs, const uint16_t *terms)
+{
+    uint16_t mw = m / 64;
+    uint8_t mb = m % 64;
+    uint16_t first = mb ? (mw + 1) : mw;
+    for(int16_t i = 2 * limbs - 1; i >= first; i--)
+    {
+        uint64_t t = c[i];
+        c[i] = 0;
+        uint32_t base = 64 * (uint32_t)i - m;
+        for(uint8_t j = 0; j <= T; j++)
+        {
+            uint32_t pos = base + terms[j];
+            uint8_t s = pos & 63;
+            c[pos >> 6] ^= t << s;
+            if(s)
+                c[(pos >> 6) + 1] ^= t >> (64 - s);
+        }
+    }
+    if(mb)
+    {
+        uint64_t t = c[mw] >> mb;
+        c[mw] &= ((uint64_t)1 << mb) - 1;
+        for(uint8_t j = 0; j <= T; j++)
+        {
+            uint8_t s = terms[j] & 63;
+            c[terms[j] >> 6] ^= t << s;
+            if(s)
+                c[(terms[j] >> 6) + 1] ^= t >> (64 - s);
+        }
+    }
+}
+
+/**
+ * @brief Arithmetic modulo a fixed polynomial
+ * @tparam M Field degree
+ * @tparam K1 First middle term
+ * @tparam K2 Second middle term, 0 for trinomial
+ * @tparam K3 Third middle term, 0 for trinomial
+ * All shifts and word positions are compile-time constants and the product stays in registers,
+ * which makes multiplication about twice as fast as with the generic reduction.
+ */
+template <uint16_t M, uint16_t K1, uint16_t K2, uint16_t K3> struct GF2mFixed
+{
+    static constexpr uint8_t N = (M + 63) / 64; //number of limbs
+
+    static inline void reduce(uint64_t *c, uint64_t *r)
+    {
+        constexpr uint16_t terms[4] = {K1, K2, K3, 0};
+        reduceTerms<K2 ? 3 : 1>(c, M, N, terms);
+        for(uint8_t i = 0; i < N; i++)
+            r[i] = c[i];
+    }
+
+    static void mul(const uint64_t *x, const uint64_t *y, uint64_t *r)
+    {
+        uint64_t c[2 * N];
+        mulKaratsuba<N>(x, y, c);
+        reduce(c, r);
+    }
+
+    static void sqr(const uint64_t *x, uint64_t *r)
+    {
+        uint64_t c[2 * N];
+        sqrLimbs(x, N, c);
+        reduce(c, r);
+    }
+};
+
+/**
+ * @brief NIST binary field polynomial
+ */
+struct GF2mNist
+{
+    uint16_t m; //degree
+    uint16_t k[3]; //middle terms
+    void (*mul)(const uint64_t *x, const uint64_t *y, uint64_t *r); //specialized multiplication
+    void (*sqr)(const uint64_t *x, uint64_t *r); //specialized squaring
+};
+
+#define GF2M_NIST(m, k1, k2, k3) {m, {k1, k2, k3}, GF2mFixed<m, k1, k2, k3>::mul, GF2mFixed<m, k1, k2, k3>::sqr}
+
+static const GF2mNist gf2mNist[] =
+{
+    GF2M_NIST(163, 7, 6, 3),
+    GF2M_NIST(233, 74, 0, 0),
+    GF2M_NIST(283, 12, 7, 5),
+    GF2M_NIST(409, 87, 0, 0),
+    GF2M_NIST(571, 10, 5, 2),
+};
+
+void GF2m::reduce(uint64_t *c, uint64_t *r)
+{
+    if(termCount == 1)
+        reduceTerms<1>(c, m, limbs, terms);
+    else
+        reduceTerms<3>(c, m, limbs, terms);
+    memcpy(r, c, limbs * sizeof(*r));
+}
+
+/**
+ * @brief Addition in GF(2^m)
+ * @param *x Term 1
+ * @param *y Term 2
+ * @param *r Sum, may be the same as x or y
+ */
+void GF2m::add(const uint64_t *x, const uint64_t *y, uint64_t *r)
+{
+    for(uint8_t i = 0; i < limbs; i++)
+        r[i] = x[i] ^ y[i];
+}
+
+/**
+ * @brief Multiplication in GF(2^m)
+ * @param *x Multiplicand
+ * @param *y Multiplier
+ * @param *r Product, may be the same as x or y
+ */
+void GF2m::mul(const uint64_t *x, const uint64_t *y, uint64_t *r)
+{
+    if(mulFn != nullptr)
+    {
+        mulFn(x, y, r);
+        return;
+    }
+    uint64_t c[2 * GF2M_LIMBS];
+    gf2mMul[limbs](x, y, c);
+    reduce(c, r);
+}
+
+/**
+ * @brief Squaring in GF(2^m)
+ * @param *x Element
+ * @param *r x^2, may be the same as x
+ */
+void GF2m::sqr(const uint64_t *x, uint64_t *r)
+{
+    if(sqrFn != nullptr)
+    {
+        sqrFn(x, r);
+        return;
+    }
+    uint64_t c[2 * GF2M_LIMBS];
+    sqrLimbs(x, limbs, c);
+    reduce(c, r);
+}
+
+/**
+ * @brief Repeated squaring in GF(2^m)
+ * @param *x Element
+ * @param n Number of squarings
+ * @param *r x^(2^n), may be the same as x
+ */
+void GF2m::sqrN(const uint64_t *x, uint32_t n, uint64_t *r)
+{
+    if(r != x)
+        memcpy(r, x, limbs * sizeof(*r));
+    for(uint32_t i = 0; i < n; i++)
+        sqr(r, r);
+}
+
+/**
+ * @brief Inverse in GF(2^m)
+ * @param *x Element
+ * @param *r 1/x, may be the same as x
+ * @return 0 on success, 1 if x is 0 (r is set to 0)
+ */
+uint8_t GF2m::inv(const uint64_t *x, uint64_t *r)
+{
+    uint64_t a[GF2M_LIMBS], b[GF2M_LIMBS], t[GF2M_LIMBS];
+    uint64_t nonZero = 0;
+    for(uint8_t i = 0; i < limbs; i++)
+    {
+        a[i] = x[i];
+        nonZero |= x[i];
+    }
+    if(nonZero == 0)
+    {
+        memset(r, 0, limbs * sizeof(*r));
+        return 1;
+    }
+
+    //b = a^(2^k-1), starting with k = 1 and following the bits of m-1 from the top
+    uint16_t e = m - 1;
+    int8_t bit = 15;
+    while(!((e >> bit) & 1))
+        bit--;
+    memcpy(b, a, limbs * sizeof(*b));
+    uint16_t k = 1;
+    for(bit--; bit >= 0; bit--)
+    {
+        sqrN(b, k, t); //a^(2^2k-2^k)
+        mul(t, b, b); //a^(2^2k-1)
+        k *= 2;
+        if((e >> bit) & 1)
+        {
+            sqr(b, b);
+            mul(b, a, b); //a^(2^(k+1)-1)
+            k++;
+        }
+    }
+    sqr(b, r); //a^(2^m-2)
+    return 0;
+}
+
+/**
+ * @brief Division in GF(2^m)
+ * @param *x Dividend
+ * @param *y Divisor
+ * @param *r Quotient, may be the same as x or y
+ * @return 0 on success, 1 if dividing by 0 (r is set to 0)
+ */
+uint8_t GF2m::div(const uint64_t *x, const uint64_t *y, uint64_t *r)
+{
+    uint64_t t[GF2M_LIMBS];
+    if(inv(y, t))
+    {
+        memset(r, 0, limbs * sizeof(*r));
+        return 1;
+    }
+    mul(x, t, r);
+    return 0;
+}
+
+/**
+ * @brief Multiply many pairs of elements
+ * @param *x Multiplicands, count elements of getLimbs() limbs each
+ * @param *y Multipliers
+ * @param *r Products, may be the same as x or y
+ * @param count Number of elements
+ */
+void GF2m::mulBatch(const uint64_t *x, const uint64_t *y, uint64_t *r, size_t count)
+{
+    for(size_t i = 0; i < count; i++)
+        mul(x + i * limbs, y + i * limbs, r + i * limbs);
+}
+
+/**
+ * @brief Square many elements
+ * @param *x Elements, count elements of getLimbs() limbs each
+ * @param *r Squares, may be the same as x
+ * @param count Number of elements
+ */
+void GF2m::sqrBatch(const uint64_t *x, uint64_t *r, size_t count)
+{
+    for(size_t i = 0; i < count; i++)
+        sqr(x + i * limbs, r + i * limbs);
+}
+
+/**
+ * @brief Invert many elements
+ * @param *x Elements, count elements of getLimbs() limbs each
+ * @param *r Inverses, may be the same as x. Zero elements give 0
+ * @param count Number of elements
+ * @return Number of zero elements
+ */
+size_t GF2m::invBatch(const uint64_t *x, uint64_t *r, size_t count)
+{
+    //prefix[i] = product of non-zero elements 0...i
+    std::vector<uint64_t> prefix(count * limbs);
+    std::vector<uint8_t> zero(count);
+    uint64_t acc[GF2M_LIMBS] = {1};
+    size_t zeros = 0;
+    for(size_t i = 0; i < count; i++)
+    {
+        uint64_t nonZero = 0;
+        for(uint8_t j = 0; j < limbs; j++)
+            nonZero |= x[i * limbs + j];
+        zero[i] = (nonZero == 0);
+        if(zero[i])
+            zeros++;
+        else
+            mul(acc, x + i * limbs, acc);
+        memcpy(&prefix[i * limbs], acc, limbs * sizeof(*acc));
+    }
+    if(zeros == count)
+    {
+        memset(r, 0, count * limbs * sizeof(*r));
+        return zeros;
+    }
+
+    //acc = 1/(product of all), then walk back peeling off one element at a time
+    inv(acc, acc);
+    uint64_t t[GF2M_LIMBS];
+    for(size_t i = count; i-- > 0;)
+    {
+        if(zero[i])
+        {
+            memset(r + i * limbs, 0, limbs * sizeof(*r));
+            continue;
+        }
+        uint64_t xi[GF2M_LIMBS];
+        memcpy(xi, x + i * limbs, limbs * sizeof(*xi));
+        //1/x_i = acc * prefix[i-1], then acc becomes 1/prefix[i-1]
+        if(i > 0)
+            mul(acc, &prefix[(i - 1) * limbs], t);
+        else
+            memcpy(t, acc, limbs * sizeof(*t));
+        mul(acc, xi, acc);
+        memcpy(r + i * limbs, t, limbs * sizeof(*t));
+    }
+    return zeros;
+}
+
+/**
+ * @brief Convert element to octet string
+ * @param *x Element
+ * @param *out Output (m+7)/8 bytes, most significant byte first (SEC 1 field element encoding)
+ */
+void GF2m::toBytes(const uint64_t *x, uint8_t *out)
+{
+    uint16_t n = (m + 7) / 8;
+    for(uint16_t i = 0; i < n; i++)
+    {
+        uint16_t j = n - 1 - i;
+        out[i] = (uint8_t)(x[j / 8] >> (8 * (j % 8)));
+    }
+}
+
+/**
+ * @brief Convert octet string to element
+ * @param *in Input (m+7)/8 bytes, most significant byte first
+ * @param *x Element
+ * @return 0 on success, 1 if the value has bits above x^(m-1)
+ */
+uint8_t GF2m::fromBytes(const uint8_t *in, uint64_t *x)
+{
+    uint16_t n = (m + 7) / 8;
+    memset(x, 0, limbs * sizeof(*x));
+    for(uint16_t i = 0; i < n; i++)
+    {
+        uint16_t j = n - 1 - i;
+        x[j / 8] |= (uint64_t)in[i] << (8 * (j % 8));
+    }
+    return (x[limbs - 1] & ~topMask) ? 1 : 0;
+}
+
+/**
+ * @brief Get field degree
+ * @return m
+ */
+uint16_t GF2m::getDegree(void)
+{
+    return m;
+}
+
+/**
+ * @brief Get number of limbs of an element
+ * @return ceil(m/64)
+ */
+uint8_t GF2m::getLimbs(void)
+{
+    return limbs;
+}
+
+/**
+ * @brief Check if object is initialized
+ * @return 0 if initialized
+ */
+uint8_t GF2m::isInitialized(void)
+{
+    if(m)
+        return 0;
+
+    return 1;
+}
+
+/**
+ * @brief Initializes GF(2^m) object
+ * @param m Field degree, 65 to GF2M_MAX_DEGREE
+ * @param k1 Middle term of polynomial x^m + x^k1 + 1 or x^m + x^k1 + x^k2 + x^k3 + 1, 0 to use the NIST polynomial for m
+ * @param k2 Second middle term of pentanomial, 0 for trinomial
+ * @param k3 Third middle term of pentanomial, 0 for trinomial
+ */
+GF2m::GF2m(uint16_t m, uint16_t k1, uint16_t k2, uint16_t k3)
+{
+    this->m = 0;
+    limbs = 0;
+    termCount = 0;
+    memset(terms, 0, sizeof(terms));
+    topMask = 0;
+    mulFn = nullptr;
+    sqrFn = nullptr;
+
+    if((m <= 64) || (m > GF2M_MAX_DEGREE))
+        return; //unsupported degree
+
+    if(k1 == 0)
+    {
+        for(uint8_t i = 0; i < sizeof(gf2mNist) / sizeof(*gf2mNist); i++)
+        {
+            if(gf2mNist[i].m == m)
+            {
+                k1 = gf2mNist[i].k[0];
+                k2 = gf2mNist[i].k[1];
+                k3 = gf2mNist[i].k[2];
+            }
+        }
+        if(k1 == 0)
+            return; //no default polynomial
+    }
+    if((k1 == 0) || (k1 > (m - 64)))
+        return;
+    if((k2 == 0) && (k3 == 0))
+        termCount = 1;
+    else if((k1 > k2) && (k2 > k3) && (k3 > 0))
+        termCount = 3;
+    else
+        return; //neither trinomial nor pentanomial
+
+    terms[0] = k1;
+    terms[1] = (termCount == 1) ? 0 : k2;
+    terms[2] = k3;
+    terms[3] = 0;
+    this->m = m;
+    limbs = (m + 63) / 64;
+    topMask = (m % 64) ? (((uint64_t)1 << (m % 64)) - 1) : ~(uint64_t)0;
+
+    //NIST polynomials (whether chosen by default or given explicitly) have specialized routines
+    for(uint8_t i = 0; i < sizeof(gf2mNist) / sizeof(*gf2mNist); i++)
+    {
+        if((gf2mNist[i].m == m) && (gf2mNist[i].k[0] == k1) && (gf2mNist[i].k[1] == k2) && (gf2mNist[i].k[2] == k3))
+        {
+            mulFn = gf2mNist[i].mul;
+            sqrFn = gf2mNist[i].sqr;
+        }
+    }
+}
@@ -0,0 +1,182 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gf2m.h
+* @brief Multi-limb binary fields GF(2^m) for large m (NIST binary curve fields)
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef GF2M_H
+#define GF2M_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define GF2M_LIMBS 9 //maximum number of 64-bit limbs of an element, enough for GF(2^571)
+#define GF2M_MAX_DEGREE (GF2M_LIMBS * 64) //maximum field degree
+#define GF2M_KARATSUBA 3 //limb count up to which multiplication is done with the schoolbook method
+
+/**
+ * @brief This class provides handling of GF(2^m) fields for 64 < m <= 576, defined by trinomials or pentanomials
+ *
+ * An element is an array of getLimbs() 64-bit limbs, least significant limb first, with bit i of the whole array
+ * being the coefficient of x^i (polynomial basis, the same bit order as in GF2 and GF2w). Bits above x^(m-1) must be zero.
+ * Multiplication uses carry-less 64x64-bit products (PCLMULQDQ if available) combined with Karatsuba's method,
+ * followed by a word-wise reduction specialized for the number of polynomial terms.
+ * Squaring spreads the bits using a lookup table and inversion uses the Itoh-Tsujii algorithm.
+ * The default polynomials are the ones of the NIST binary curves (FIPS 186-4): m = 163, 233, 283, 409 and 571.
+ */
+class GF2m
+{
+public:
+	/**
+	 * @brief Addition in GF(2^m)
+	 * @param *x Term 1
+	 * @param *y Term 2
+	 * @param *r Sum, may be the same as x or y
+	 */
+	void add(const uint64_t *x, const uint64_t *y, uint64_t *r);
+
+	/**
+	 * @brief Multiplication in GF(2^m)
+	 * @param *x Multiplicand
+	 * @param *y Multiplier
+	 * @param *r Product, may be the same as x or y
+	 */
+	void mul(const uint64_t *x, const uint64_t *y, uint64_t *r);
+
+	/**
+	 * @brief Squaring in GF(2^m)
+	 * @param *x Element
+	 * @param *r x^2, may be the same as x
+	 */
+	void sqr(const uint64_t *x, uint64_t *r);
+
+	/**
+	 * @brief Repeated squaring in GF(2^m)
+	 * @param *x Element
+	 * @param n Number of squarings
+	 * @param *r x^(2^n), may be the same as x
+	 */
+	void sqrN(const uint64_t *x, uint32_t n, uint64_t *r);
+
+	/**
+	 * @brief Inverse in GF(2^m)
+	 * @param *x Element
+	 * @param *r 1/x, may be the same as x
+	 * @return 0 on success, 1 if x is 0 (r is set to 0)
+	 * Itoh-Tsujii: x^-1 = (x^(2^(m-1)-1))^2, with the power built along an addition chain of m-1,
+	 * which takes about log2(m) multiplications and m-1 squarings.
+	 */
+	uint8_t inv(const uint64_t *x, uint64_t *r);
+
+	/**
+	 * @brief Division in GF(2^m)
+	 * @param *x Dividend
+	 * @param *y Divisor
+	 * @param *r Quotient, may be the same as x or y
+	 * @return 0 on success, 1 if dividing by 0 (r is set to 0)
+	 */
+	uint8_t div(const uint64_t *x, const uint64_t *y, uint64_t *r);
+
+	/**
+	 * @brief Multiply many pairs of elements
+	 * @param *x Multiplicands, count elements of getLimbs() limbs each
+	 * @param *y Multipliers
+	 * @param *r Products, may be the same as x or y
+	 * @param count Number of elements
+	 */
+	void mulBatch(const uint64_t *x, const uint64_t *y, uint64_t *r, size_t count);
+
+	/**
+	 * @brief Square many elements
+	 * @param *x Elements, count elements of getLimbs() limbs each
+	 * @param *r Squares, may be the same as x
+	 * @param count Number of elements
+	 */
+	void sqrBatch(const uint64_t *x, uint64_t *r, size_t count);
+
+	/**
+	 * @brief Invert many elements
+	 * @param *x Elements, count elements of getLimbs() limbs each
+	 * @param *r Inverses, may be the same as x. Zero elements give 0
+	 * @param count Number of elements
+	 * @return Number of zero elements
+	 * Montgomery's trick is used, so there is only one field inversion and 3 multiplications per element.
+	 */
+	size_t invBatch(const uint64_t *x, uint64_t *r, size_t count);
+
+	/**
+	 * @brief Convert element to octet string
+	 * @param *x Element
+	 * @param *out Output (m+7)/8 bytes, most significant byte first (SEC 1 field element encoding)
+	 */
+	void toBytes(const uint64_t *x, uint8_t *out);
+
+	/**
+	 * @brief Convert octet string to element
+	 * @param *in Input (m+7)/8 bytes, most significant byte first
+	 * @param *x Element
+	 * @return 0 on success, 1 if the value has bits above x^(m-1)
+	 */
+	uint8_t fromBytes(const uint8_t *in, uint64_t *x);
+
+	/**
+	 * @brief Get field degree
+	 * @return m
+	 */
+	uint16_t getDegree(void);
+
+	/**
+	 * @brief Get number of limbs of an element
+	 * @return ceil(m/64)
+	 */
+	uint8_t getLimbs(void);
+
+	/**
+	 * @brief Check if object is initialized
+	 * @return 0 if initialized
+	 */
+	uint8_t isInitialized(void);
+
+	/**
+	 * @brief Initializes GF(2^m) object
+	 * @param m Field degree, 65 to GF2M_MAX_DEGREE
+	 * @param k1 Middle term of polynomial x^m + x^k1 + 1 or x^m + x^k1 + x^k2 + x^k3 + 1, 0 to use the NIST polynomial for m
+	 * @param k2 Second middle term of pentanomial, 0 for trinomial
+	 * @param k3 Third middle term of pentanomial, 0 for trinomial
+	 * Terms must satisfy m-64 >= k1 > k2 > k3 > 0, so that a reduction step never folds a word onto itself.
+	 * The polynomial must be irreducible, which is not checked.
+	 */
+	GF2m(uint16_t m, uint16_t k1 = 0, uint16_t k2 = 0, uint16_t k3 = 0);
+
+private:
+	uint16_t m; //field degree, 0 if not initialized
+	uint8_t limbs; //number of limbs
+	uint8_t termCount; //number of middle terms, 1 for trinomial or 3 for pentanomial
+	uint16_t terms[4]; //middle terms followed by the constant term 0
+	uint64_t topMask; //mask of used bits of the most significant limb
+	void (*mulFn)(const uint64_t *x, const uint64_t *y, uint64_t *r); //multiplication specialized for the polynomial, nullptr if none
+	void (*sqrFn)(const uint64_t *x, uint64_t *r); //squaring specialized for the polynomial, nullptr if none
+
+	void reduce(uint64_t *c, uint64_t *r); //reduce 2*limbs product
+};
+
+#endif
@@ -0,0 +1,785 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gf2poly.cpp
+* @brief Bit-packed polynomials over GF(2) with fast multiplication
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "gf2poly.h"
+#include "gf2clmul.h"
+#include <string.h>
+#include <thread>
+#include <functional>
+
+/**
+ * @brief Multiplication in GF(2^64) defined by x^64 + x^4 + x^3 + x + 1
+ * @param x Multiplicand
+ * @param y Multiplier
+ * @return Product
+ */
+static inline uint64_t gf64Mul(uint64_t x, uint64_t y)
+{
+    uint64_t lo, hi;
+    clmul64(x, y, &lo, &hi);
+    //x^64 = x^4 + x^3 + x + 1, applied twice since hi*(x^4 + x^3 + x + 1) can overflow by 4 bits
+    uint64_t o = (hi >> 63) ^ (hi >> 61) ^ (hi >> 60);
+    hi ^= o;
+    return lo ^ hi ^ (hi << 1) ^ (hi << 3) ^ (hi << 4);
+}
+
+/**
+ * @brief Run a loop split across threads
+ * @param count Number of iterations
+ * @param threads Number of threads
+ * @param &body Loop body, called with a range of iterations [begin, end)
+ */
+static void parallelFor(size_t count, unsigned threads, const std::function<void(size_t, size_t)> &body)
+{
+    if(threads > count)
+        threads = (unsigned)count;
+    if(threads <= 1)
+    {
+        body(0, count);
+        return;
+    }
+    std::vector<std::thread> workers;
+    size_t part = (count + threads - 1) / threads;
+    for(unsigned t = 1; t < threads; t++)
+    {
+        size_t begin = t * part;
+        size_t end = (begin + part < count) ? (begin + part) : count;
+        if(begin < end)
+            workers.emplace_back([&body, begin, end]() { body(begin, end); });
+    }
+    body(0, part);
+    for(auto &w : workers)
+        w.join();
+}
+
+/**
+ * @brief Schoolbook multiplication of packed polynomials
+ * @param *a Multiplicand, n words
+ * @param *b Multiplier, n words
+ * @param n Number of words
+ * @param *r Product, 2n words
+ * Products are accumulated column by column, so every output word is stored once.
+ */
+static void mulSchoolbook(const uint64_t *a, const uint64_t *b, size_t n, uint64_t *r)
+{
+    uint64_t carry = 0;
+    for(size_t k = 0; k < 2 * n - 1; k++)
+    {
+        uint64_t lo = 0, hi = 0;
+        size_t first = (k >= n) ? (k - n + 1) : 0;
+        size_t last = (k < n) ? k : (n - 1);
+        for(size_t i = first; i <= last; i++)
+        {
+            uint64_t l, h;
+            clmul64(a[i], b[k - i], &l, &h);
+            lo ^= l;
+            hi ^= h;
+        }
+        r[k] = lo ^ carry;
+        carry = hi;
+    }
+    r[2 * n - 1] = carry;
+}
+
+/**
+ * @brief Get scratch size needed by Karatsuba multiplication
+ * @param n Number of words
+ * @return Number of scratch words
+ */
+static size_t karatsubaScratch(size_t n)
+{
+    if(n < GF2POLY_KARATSUBA_MIN)
+        return 0;
+    size_t l = (n + 1) / 2;
+    return 4 * l + karatsubaScratch(l);
+}
+
+/**
+ * @brief Karatsuba multiplication of packed polynomials
+ * @param *a Multiplicand, n words
+ * @param *b Multiplier, n words
+ * @param n Number of words
+ * @param *r Product, 2n words
+ * @param *scratch Scratch of karatsubaScratch(n) words
+ */
+static void mulKaratsuba(const uint64_t *a, const uint64_t *b, size_t n, uint64_t *r, uint64_t *scratch)
+{
+    if(n < GF2POLY_KARATSUBA_MIN)
+    {
+        mulSchoolbook(a, b, n, r);
+        return;
+    }
+    size_t l = (n + 1) / 2;
+    size_t h = n - l;
+    uint64_t *sa = scratch, *sb = scratch + l, *mid = scratch + 2 * l, *next = scratch + 4 * l;
+
+    mulKaratsuba(a, b, l, r, next); //a0*b0 in r[0...2l-1]
+    mulKaratsuba(a + l, b + l, h, r + 2 * l, next); //a1*b1 in r[2l...2n-1]
+    karatsubaSplit(a, b, l, h, sa, sb);
+    mulKaratsuba(sa, sb, l, mid, next);
+    karatsubaCombine(r, l, h, mid);
+}
+
+static void mulBalanced(const uint64_t *a, const uint64_t *b, size_t n, uint64_t *r, unsigned threads, uint8_t method);
+
+/**
+ * @brief Add shifted polynomial
+ * @param *dst Destination of n+1 words, dst += src*x^s
+ * @param *src Source of n words
+ * @param n Number of source words
+ * @param s Shift, 1 to 63
+ */
+static void xorShifted(uint64_t *dst, const uint64_t *src, size_t n, uint8_t s)
+{
+    uint64_t prev = 0;
+    for(size_t i = 0; i < n; i++)
+    {
+        dst[i] ^= (src[i] << s) | (prev >> (64 - s));
+        prev = src[i];
+    }
+    dst[n] ^= prev >> (64 - s);
+}
+
+/**
+ * @brief Divide polynomial by x, the division must be exact
+ * @param *w Polynomial of n words, divided in place
+ * @param n Number of words
+ */
+static void divX(uint64_t *w, size_t n)
+{
+    for(size_t i = 0; i + 1 < n; i++)
+        w[i] = (w[i] >> 1) | (w[i + 1] << 63);
+    w[n - 1] >>= 1;
+}
+
+/**
+ * @brief Divide polynomial by x+1, the division must be exact
+ * @param *w Polynomial of n words, divided in place
+ * @param n Number of words
+ * Quotient coefficient i is the sum of coefficients 0...i, that is a prefix XOR going up from the lowest bit.
+ */
+static void divX1(uint64_t *w, size_t n)
+{
+    uint64_t carry = 0;
+    for(size_t i = 0; i < n; i++)
+    {
+        uint64_t v = w[i];
+        v ^= v << 1;
+        v ^= v << 2;
+        v ^= v << 4;
+        v ^= v << 8;
+        v ^= v << 16;
+        v ^= v << 32;
+        v ^= carry;
+        w[i] = v;
+        carry = (uint64_t)0 - (v >> 63);
+    }
+}
+
+/**
+ * @brief Toom-Cook 3-way multiplication of packed polynomials
+ * @param *a Multiplicand, n words
+ * @param *b Multiplier, n words
+ * @param n Number of words
+ * @param *r Product, 2n words
+ * @param threads Number of threads for the five sub-products
+ * @param method Method for sub-products
+ * Operands are split into three parts of k words, evaluated at 0, 1, x, x+1 and infinity, and the five products
+ * r(y) = r0 + r1 y + ... + r4 y^4 are interpolated using only shifts and exact divisions by x and x+1 (Bodrato).
+ */
+static void mulToom3(const uint64_t *a, const uint64_t *b, size_t n, uint64_t *r, unsigned threads, uint8_t method)
+{
+    size_t k = (n + 2) / 3;
+    size_t e = k + 1; //evaluations at x and x+1 are up to 2 bits longer
+    size_t l = 2 * e; //length of interpolation terms
+    std::vector<uint64_t> buf(6 * k + 6 * e + 5 * l, 0);
+    uint64_t *pa = &buf[0], *pb = pa + 3 * k;
+    uint64_t *a1 = pb + 3 * k, *b1 = a1 + e, *ax = b1 + e, *bx = ax + e, *ax1 = bx + e, *bx1 = ax1 + e;
+    uint64_t *w0 = bx1 + e, *w1 = w0 + l, *wx = w1 + l, *wx1 = wx + l, *winf = wx1 + l;
+    memcpy(pa, a, n * sizeof(*pa));
+    memcpy(pb, b, n * sizeof(*pb));
+
+    //evaluation: p(1) = p0+p1+p2, p(x) = p0+p1*x+p2*x^2, p(x+1) = p(1)+p(x)+p0
+    const uint64_t *src[2] = {pa, pb};
+    uint64_t *ev1[2] = {a1, b1}, *evx[2] = {ax, bx}, *evx1[2] = {ax1, bx1};
+    for(uint8_t o = 0; o < 2; o++)
+    {
+        const uint64_t *p0 = src[o], *p1 = src[o] + k, *p2 = src[o] + 2 * k;
+        for(size_t i = 0; i < k; i++)
+        {
+            ev1[o][i] = p0[i] ^ p1[i] ^ p2[i];
+            evx[o][i] = p0[i];
+        }
+        xorShifted(evx[o], p1, k, 1);
+        xorShifted(evx[o], p2, k, 2);
+        for(size_t i = 0; i < e; i++)
+            evx1[o][i] = ev1[o][i] ^ evx[o][i] ^ ((i < k) ? p0[i] : 0);
+    }
+
+    unsigned sub = (threads > 5) ? (threads / 5) : 1;
+    parallelFor(5, threads, [&](size_t begin, size_t end)
+    {
+        for(size_t j = begin; j < end; j++)
+        {
+            switch(j)
+            {
+                case 0:
+                    mulBalanced(pa, pb, k, w0, sub, method);
+                    break;
+                case 1:
+                    mulBalanced(pa + 2 * k, pb + 2 * k, k, winf, sub, method);
+                    break;
+                case 2:
+                    mulBalanced(a1, b1, e, w1, sub, method);
+                    break;
+                case 3:
+                    mulBalanced(ax, bx, e, wx, sub, method);
+                    break;
+                case 4:
+                    mulBalanced(ax1, bx1, e, wx1, sub, method);
+                    break;
+            }
+        }
+    });
+
+    //w0 = r0 and winf = r4 (2k words, the rest of their l words is zero)
+    //wx = (r(x) + r0 + r4*x^4)/x = r1 + r2*x + r3*x^2
+    for(size_t i = 0; i < l; i++)
+        wx[i] ^= w0[i];
+    xorShifted(wx, winf, 2 * k, 4);
+    divX(wx, l);
+    //wx1 = (r(x+1) + r0 + r4*(x^4+1))/(x+1) = r1 + r2*(x+1) + r3*(x^2+1)
+    for(size_t i = 0; i < l; i++)
+        wx1[i] ^= w0[i] ^ winf[i];
+    xorShifted(wx1, winf, 2 * k, 4);
+    divX1(wx1, l);
+    //w1 = r(1) + r0 + r4 = r1 + r2 + r3
+    for(size_t i = 0; i < l; i++)
+        w1[i] ^= w0[i] ^ winf[i];
+    //wx1 = r2 + r3, w1 = r1
+    for(size_t i = 0; i < l; i++)
+    {
+        wx1[i] ^= wx[i];
+        w1[i] ^= wx1[i];
+    }
+    //wx = (r2*x + r3*x^2)/x + r2 + r3 = r3*(x+1), then r3
+    for(size_t i = 0; i < l; i++)
+        wx[i] ^= w1[i];
+    divX(wx, l);
+    for(size_t i = 0; i < l; i++)
+        wx[i] ^= wx1[i];
+    divX1(wx, l);
+    //wx1 = r2
+    for(size_t i = 0; i < l; i++)
+        wx1[i] ^= wx[i];
+
+    //recombine r0 + r1*y + r2*y^2 + r3*y^3 + r4*y^4 with y = x^(64k)
+    std::vector<uint64_t> out(6 * k, 0);
+    const uint64_t *terms[5] = {w0, w1, wx1, wx, winf};
+    for(uint8_t t = 0; t < 5; t++)
+    {
+        for(size_t i = 0; i < 2 * k; i++)
+            out[t * k + i] ^= terms[t][i];
+    }
+    memcpy(r, out.data(), 2 * n * sizeof(*r));
+}
+
+/**
+ * @brief Multiply packed polynomials of equal length
+ * @param *a Multiplicand, n words
+ * @param *b Multiplier, n words
+ * @param n Number of words
+ * @param *r Product, 2n words
+ * @param threads Number of threads
+ * @param method Multiplication method (except FFT, which is only used at the top level)
+ */
+static void mulBalanced(const uint64_t *a, const uint64_t *b, size_t n, uint64_t *r, unsigned threads, uint8_t method)
+{
+    if((method == GF2POLY_SCHOOLBOOK) || ((method != GF2POLY_KARATSUBA) && (n < GF2POLY_KARATSUBA_MIN)))
+    {
+        mulSchoolbook(a, b, n, r);
+        return;
+    }
+    if((method == GF2POLY_TOOM3) ? (n >= 3 * GF2POLY_KARATSUBA_MIN) : ((method == GF2POLY_AUTO) && (n >= GF2POLY_TOOM3_MIN)))
+    {
+        mulToom3(a, b, n, r, (n >= GF2POLY_PARALLEL_MIN) ? threads : 1, method);
+        return;
+    }
+    std::vector<uint64_t> scratch(karatsubaScratch(n));
+    mulKaratsuba(a, b, n, r, scratch.data());
+}
+
+/**
+ * @brief Cantor basis of GF(2^64)
+ *
+ * beta_0 = 1 and beta_i^2 + beta_i = beta_(i-1). With this basis the subspace polynomial s_j vanishing on
+ * span(beta_0...beta_(j-1)) is the j-fold composition of x^2 + x, so it has only binary coefficients,
+ * s_j(beta_i) = beta_(i-j) and s_j(beta_j) = 1.
+ */
+static const struct GF2PolyCantor
+{
+    uint64_t beta[64];
+
+    /**
+     * @brief Solve x^2 + x = c
+     * @param c Right-hand side, must have zero trace
+     * @return One of the two solutions
+     */
+    static uint64_t solve(uint64_t c)
+    {
+        //rows of the GF(2)-linear map x -> x^2 + x, bit j of row i is the contribution of input bit j to output bit i
+        uint64_t row[64], rhs[64];
+        uint8_t pivot[64];
+        for(uint8_t i = 0; i < 64; i++)
+        {
+            row[i] = 0;
+            rhs[i] = (c >> i) & 1;
+        }
+        for(uint8_t j = 0; j < 64; j++)
+        {
+            uint64_t e = (uint64_t)1 << j;
+            uint64_t col = gf64Mul(e, e) ^ e;
+            for(uint8_t i = 0; i < 64; i++)
+                row[i] |= ((col >> i) & 1) << j;
+        }
+        uint8_t rank = 0;
+        for(uint8_t j = 0; j < 64; j++)
+        {
+            uint8_t p = rank;
+            while((p < 64) && !((row[p] >> j) & 1))
+                p++;
+            if(p == 64)
+                continue;
+            uint64_t t = row[p]; row[p] = row[rank]; row[rank] = t;
+            t = rhs[p]; rhs[p] = rhs[rank]; rhs[rank] = t;
+            for(uint8_t i = 0; i < 64; i++)
+            {
+                if((i != rank) && ((row[i] >> j) & 1))
+                {
+                    row[i] ^= row[rank];
+                    rhs[i] ^= rhs[rank];
+                }
+            }
+            pivot[rank++] = j;
+        }
+        //free variables are 0
+        uint64_t x = 0;
+        for(uint8_t i = 0; i < rank; i++)
+            x |= rhs[i] << pivot[i];
+        return x;
+    }
+
+    GF2PolyCantor()
+    {
+        beta[0] = 1;
+        for(uint8_t i = 1; i < 64; i++)
+            beta[i] = solve(beta[i - 1]);
+    }
+} gf2PolyCantor;
+
+/**
+ * @brief Convert polynomial over GF(2^64) from monomial to novel basis
+ * @param *f 2^k coefficients, converted in place
+ * @param k Log2 of size
+ * @param threads Number of threads
+ * Every block of 2^i coefficients is divided by s_(i-1)(x) = sum of x^(2^j) for j whose bits are a subset of bits of i-1,
+ * leaving the remainder in the lower half and the quotient in the upper half, from the largest blocks down.
+ */
+static void toNovel(uint64_t *f, uint8_t k, unsigned threads)
+{
+    size_t n = (size_t)1 << k;
+    for(uint8_t i = k; i >= 1; i--)
+    {
+        size_t d = (size_t)1 << (i - 1);
+        size_t offsets[64];
+        uint8_t count = 0;
+        for(uint8_t j = 0; j < i - 1; j++)
+        {
+            if((j & (i - 1)) == j)
+                offsets[count++] = (size_t)1 << j;
+        }
+        parallelFor(n >> i, (n >> i) > 1 ? threads : 1, [&](size_t begin, size_t end)
+        {
+            for(size_t b = begin; b < end; b++)
+            {
+                uint64_t *g = f + (b << i);
+                for(size_t t = 2 * d; t-- > d;)
+                {
+                    uint64_t v = g[t];
+                    for(uint8_t j = 0; j < count; j++)
+                        g[t - d + offsets[j]] ^= v;
+                }
+            }
+        });
+    }
+}
+
+/**
+ * @brief Convert polynomial over GF(2^64) from novel to monomial basis
+ * @param *f 2^k coefficients, converted in place
+ * @param k Log2 of size
+ * @param threads Number of threads
+ * This undoes toNovel() step by step in reverse order.
+ */
+static void fromNovel(uint64_t *f, uint8_t k, unsigned threads)
+{
+    size_t n = (size_t)1 << k;
+    for(uint8_t i = 1; i <= k; i++)
+    {
+        size_t d = (size_t)1 << (i - 1);
+        size_t offsets[64];
+        uint8_t count = 0;
+        for(uint8_t j = 0; j < i - 1; j++)
+        {
+            if((j & (i - 1)) == j)
+                offsets[count++] = (size_t)1 << j;
+        }
+        parallelFor(n >> i, (n >> i) > 1 ? threads : 1, [&](size_t begin, size_t end)
+        {
+            for(size_t b = begin; b < end; b++)
+            {
+                uint64_t *g = f + (b << i);
+                for(size_t t = d; t < 2 * d; t++)
+                {
+                    uint64_t v = g[t];
+                    for(uint8_t j = 0; j < count; j++)
+                        g[t - d + offsets[j]] ^= v;
+                }
+            }
+        });
+    }
+}
+
+/**
+ * @brief Additive FFT in novel basis (Lin-Chung-Han)
+ * @param *f 2^k coefficients, replaced with values at omega_0...omega_(2^k-1)
+ * @param k Log2 of size
+ * @param *omega omega_v = sum of beta_i over bits i of v
+ * @param inverse Non-zero for the inverse transform
+ * @param threads Number of threads
+ * At the level with half size h = 2^j, block t evaluates f0 + s_j(x)*f1 on alpha + span(beta_0...beta_j),
+ * alpha = omega_(2ht). Since s_j(alpha) = omega_(2t), the butterfly is f0 += omega_(2t)*f1, f1 += f0.
+ */
+static void fft(uint64_t *f, uint8_t k, const uint64_t *omega, uint8_t inverse, unsigned threads)
+{
+    size_t n = (size_t)1 << k;
+    for(uint8_t l = 0; l < k; l++)
+    {
+        uint8_t j = inverse ? l : (k - 1 - l);
+        size_t h = (size_t)1 << j;
+        parallelFor(n / 2, threads, [&](size_t begin, size_t end)
+        {
+            for(size_t idx = begin; idx < end; idx++)
+            {
+                size_t t = idx >> j;
+                size_t p = (t << (j + 1)) + (idx & (h - 1));
+                uint64_t lambda = omega[2 * t];
+                if(inverse)
+                {
+                    f[p + h] ^= f[p];
+                    f[p] ^= gf64Mul(lambda, f[p + h]);
+                }
+                else
+                {
+                    f[p] ^= gf64Mul(lambda, f[p + h]);
+                    f[p + h] ^= f[p];
+                }
+            }
+        });
+    }
+}
+
+/**
+ * @brief Multiply packed polynomials with additive FFT
+ * @param *a Multiplicand, na words
+ * @param na Number of multiplicand words
+ * @param *b Multiplier, nb words
+ * @param nb Number of multiplier words
+ * @param *r Product of na+nb words, zeroed by caller
+ * @param threads Number of threads
+ * Operands are cut into 32-bit pieces, which are coefficients of polynomials over GF(2^64). Products of pieces have
+ * at most 63 bits, so the product over GF(2^64) holds the exact carry-less sums, which are added back with overlap.
+ */
+static void mulFFT(const uint64_t *a, size_t na, const uint64_t *b, size_t nb, uint64_t *r, unsigned threads)
+{
+    size_t count = 2 * (na + nb) - 1;
+    uint8_t k = 0;
+    while(((size_t)1 << k) < count)
+        k++;
+    size_t n = (size_t)1 << k;
+    if(n < GF2POLY_PARALLEL_MIN)
+        threads = 1;
+
+    std::vector<uint64_t> omega(n);
+    omega[0] = 0;
+    for(size_t v = 1; v < n; v++)
+        omega[v] = omega[v & (v - 1)] ^ gf2PolyCantor.beta[__builtin_ctzll(v)];
+
+    std::vector<uint64_t> fa(n, 0), fb(n, 0);
+    const uint64_t *src[2] = {a, b};
+    size_t len[2] = {na, nb};
+    uint64_t *dst[2] = {fa.data(), fb.data()};
+    unsigned sub = (threads > 1) ? (threads / 2) : 1;
+    parallelFor(2, threads, [&](size_t begin, size_t end)
+    {
+        for(size_t o = begin; o < end; o++)
+        {
+            for(size_t i = 0; i < len[o]; i++)
+            {
+                dst[o][2 * i] = src[o][i] & 0xFFFFFFFF;
+                dst[o][2 * i + 1] = src[o][i] >> 32;
+            }
+            toNovel(dst[o], k, sub);
+            fft(dst[o], k, omega.data(), 0, sub);
+        }
+    });
+    parallelFor(n, threads, [&](size_t begin, size_t end)
+    {
+        for(size_t i = begin; i < end; i++)
+            fa[i] = gf64Mul(fa[i], fb[i]);
+    });
+    fft(fa.data(), k, omega.data(), 1, threads);
+    fromNovel(fa.data(), k, threads);
+
+    for(size_t i = 0; i < count; i++)
+    {
+        if(i & 1)
+        {
+            r[i / 2] ^= fa[i] << 32;
+            r[i / 2 + 1] ^= fa[i] >> 32;
+        }
+        else
+            r[i / 2] ^= fa[i];
+    }
+}
+
+/**
+ * @brief Multiply packed polynomials
+ * @param *a Multiplicand
+ * @param na Number of multiplicand words
+ * @param *b Multiplier
+ * @param nb Number of multiplier words
+ * @param *r Product of na+nb words, must not overlap the operands
+ * @param threads Number of threads, 0 to use all hardware threads
+ * @param method Multiplication method, GF2POLY_AUTO to choose by size
+ */
+void GF2Poly::mulWords(const uint64_t *a, size_t na, const uint64_t *b, size_t nb, uint64_t *r, unsigned threads, uint8_t method)
+{
+    if(threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if(threads == 0)
+        threads = 1;
+    memset(r, 0, (na + nb) * sizeof(*r));
+    if((na == 0) || (nb == 0))
+        return;
+
+    if((method == GF2POLY_FFT) || ((method == GF2POLY_AUTO) && ((na + nb) >= GF2POLY_FFT_MIN) && (na >= 4) && (nb >= 4)))
+    {
+        mulFFT(a, na, b, nb, r, threads);
+        return;
+    }
+
+    if(na < nb)
+    {
+        const uint64_t *t = a; a = b; b = t;
+        size_t tn = na; na = nb; nb = tn;
+    }
+    //the longer operand is cut into pieces of the length of the shorter one
+    std::vector<uint64_t> piece(nb), product(2 * nb);
+    for(size_t off = 0; off < na; off += nb)
+    {
+        size_t len = ((na - off) < nb) ? (na - off) : nb;
+        const uint64_t *p = a + off;
+        if(len < nb)
+        {
+            memset(piece.data(), 0, nb * sizeof(*p));
+            memcpy(piece.data(), p, len * sizeof(*p));
+            p = piece.data();
+        }
+        mulBalanced(p, b, nb, product.data(), threads, method);
+        for(size_t i = 0; i < len + nb; i++)
+            r[off + i] ^= product[i];
+    }
+}
+
+/**
+ * @brief Multiply polynomials
+ * @param &a Multiplicand
+ * @param &b Multiplier
+ * @param &r Product, may be the same as a or b
+ * @param threads Number of threads, 0 to use all hardware threads
+ * @param method Multiplication method, GF2POLY_AUTO to choose by size
+ */
+void GF2Poly::mul(const GF2Poly &a, const GF2Poly &b, GF2Poly &r, unsigned threads, uint8_t method)
+{
+    size_t na = a.words.size(), nb = b.words.size();
+    while((na > 0) && (a.words[na - 1] == 0))
+        na--;
+    while((nb > 0) && (b.words[nb - 1] == 0))
+        nb--;
+    std::vector<uint64_t> out(na + nb);
+    mulWords(a.words.data(), na, b.words.data(), nb, out.data(), threads, method);
+    r.words.swap(out);
+    r.trim();
+}
+
+/**
+ * @brief Square polynomial
+ * @param &a Polynomial
+ * @param &r Square, may be the same as a
+ */
+void GF2Poly::sqr(const GF2Poly &a, GF2Poly &r)
+{
+    std::vector<uint64_t> out(2 * a.words.size());
+    for(size_t i = 0; i < a.words.size(); i++)
+    {
+        //spread 32 bits to even positions of 64 bits
+        uint64_t h[2] = {a.words[i] & 0xFFFFFFFF, a.words[i] >> 32};
+        for(uint8_t j = 0; j < 2; j++)
+        {
+            uint64_t x = h[j];
+            x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+            x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+            x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+            x = (x | (x << 2)) & 0x3333333333333333ULL;
+            x = (x | (x << 1)) & 0x5555555555555555ULL;
+            out[2 * i + j] = x;
+        }
+    }
+    r.words.swap(out);
+    r.trim();
+}
+
+/**
+ * @brief Add polynomials
+ * @param &a Term 1
+ * @param &b Term 2
+ * @param &r Sum, may be the same as a or b
+ */
+void GF2Poly::add(const GF2Poly &a, const GF2Poly &b, GF2Poly &r)
+{
+    size_t n = (a.words.size() > b.words.size()) ? a.words.size() : b.words.size();
+    std::vector<uint64_t> out(n, 0);
+    for(size_t i = 0; i < a.words.size(); i++)
+        out[i] = a.words[i];
+    for(size_t i = 0; i < b.words.size(); i++)
+        out[i] ^= b.words[i];
+    r.words.swap(out);
+    r.trim();
+}
+
+/**
+ * @brief Get polynomial degree
+ * @return Degree, -1 for the zero polynomial
+ */
+int64_t GF2Poly::degree(void)
+{
+    for(size_t i = words.size(); i-- > 0;)
+    {
+        if(words[i])
+            return (int64_t)(64 * i + 63 - __builtin_clzll(words[i]));
+    }
+    return -1;
+}
+
+/**
+ * @brief Get coefficient
+ * @param i Power of x
+ * @return Coefficient of x^i
+ */
+uint8_t GF2Poly::get(size_t i)
+{
+    if((i / 64) >= words.size())
+        return 0;
+    return (words[i / 64] >> (i % 64)) & 1;
+}
+
+/**
+ * @brief Set coefficient
+ * @param i Power of x, the polynomial grows if needed
+ * @param v Coefficient
+ */
+void GF2Poly::set(size_t i, uint8_t v)
+{
+    if((i / 64) >= words.size())
+    {
+        if(v == 0)
+            return;
+        words.resize(i / 64 + 1, 0);
+    }
+    if(v)
+        words[i / 64] |= (uint64_t)1 << (i % 64);
+    else
+        words[i / 64] &= ~((uint64_t)1 << (i % 64));
+}
+
+/**
+ * @brief Get packed coefficients
+ * @return Pointer to getWords() words
+ */
+uint64_t *GF2Poly::data(void)
+{
+    return words.data();
+}
+
+/**
+ * @brief Get number of words
+ * @return Number of words
+ */
+size_t GF2Poly::getWords(void)
+{
+    return words.size();
+}
+
+/**
+ * @brief Change number of words, new words are zero
+ * @param words Number of words
+ */
+void GF2Poly::resize(size_t words)
+{
+    this->words.resize(words, 0);
+}
+
+/**
+ * @brief Remove leading zero words
+ */
+void GF2Poly::trim(void)
+{
+    size_t n = words.size();
+    while((n > 0) && (words[n - 1] == 0))
+        n--;
+    words.resize(n);
+}
+
+/**
+ * @brief Initializes polynomial
+ * @param *coefficients Packed coefficients, nullptr for the zero polynomial
+ * @param words Number of words
+ */
+GF2Poly::GF2Poly(const uint64_t *coefficients, size_t words)
+{
+    if(coefficients != nullptr)
+        this->words.assign(coefficients, coefficients + words);
+}
@@ -0,0 +1,150 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gf2poly.h
+* @brief Bit-packed polynomials over GF(2) with fast multiplication
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef GF2POLY_H
+#define GF2POLY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#define GF2POLY_AUTO 0 //choose multiplication method by size
+#define GF2POLY_SCHOOLBOOK 1 //quadratic carry-less multiplication
+#define GF2POLY_KARATSUBA 2 //Karatsuba recursion
+#define GF2POLY_TOOM3 3 //Toom-Cook 3-way recursion with Karatsuba below it
+#define GF2POLY_FFT 4 //additive FFT over GF(2^64)
+
+#define GF2POLY_KARATSUBA_MIN 16 //operand size in words from which Karatsuba is used
+#define GF2POLY_TOOM3_MIN 192 //operand size in words from which Toom-Cook 3-way is used
+#define GF2POLY_FFT_MIN 16384 //total operand size in words from which the additive FFT is used
+#define GF2POLY_PARALLEL_MIN 1024 //operand size in words from which multiplication is split across threads
+
+/**
+ * @brief This class provides polynomials over GF(2) with coefficients packed 64 per word
+ *
+ * Bit i of word j is the coefficient of x^(64j+i). Multiplication is layered by operand size:
+ * carry-less schoolbook multiplication (PCLMULQDQ if available) for a few words, Karatsuba recursion above it,
+ * Toom-Cook 3-way recursion (with Bodrato's evaluation points 0, 1, x, x+1 and infinity) for larger operands,
+ * and for millions of terms an additive FFT: the operands are cut into 32-bit pieces treated as elements of GF(2^64),
+ * so that piece products never need reduction, and they are multiplied with the Lin-Chung-Han novel-basis FFT
+ * over a Cantor basis, where the basis conversion needs only additions.
+ * Toom-Cook sub-products and FFT butterflies are split across threads for large operands.
+ */
+class GF2Poly
+{
+public:
+	/**
+	 * @brief Get polynomial degree
+	 * @return Degree, -1 for the zero polynomial
+	 */
+	int64_t degree(void);
+
+	/**
+	 * @brief Get coefficient
+	 * @param i Power of x
+	 * @return Coefficient of x^i
+	 */
+	uint8_t get(size_t i);
+
+	/**
+	 * @brief Set coefficient
+	 * @param i Power of x, the polynomial grows if needed
+	 * @param v Coefficient
+	 */
+	void set(size_t i, uint8_t v);
+
+	/**
+	 * @brief Get packed coefficients
+	 * @return Pointer to getWords() words
+	 */
+	uint64_t *data(void);
+
+	/**
+	 * @brief Get number of words
+	 * @return Number of words
+	 */
+	size_t getWords(void);
+
+	/**
+	 * @brief Change number of words, new words are zero
+	 * @param words Number of words
+	 */
+	void resize(size_t words);
+
+	/**
+	 * @brief Remove leading zero words
+	 */
+	void trim(void);
+
+	/**
+	 * @brief Add polynomials
+	 * @param &a Term 1
+	 * @param &b Term 2
+	 * @param &r Sum, may be the same as a or b
+	 */
+	static void add(const GF2Poly &a, const GF2Poly &b, GF2Poly &r);
+
+	/**
+	 * @brief Multiply polynomials
+	 * @param &a Multiplicand
+	 * @param &b Multiplier
+	 * @param &r Product, may be the same as a or b
+	 * @param threads Number of threads, 0 to use all hardware threads
+	 * @param method Multiplication method, GF2POLY_AUTO to choose by size
+	 */
+	static void mul(const GF2Poly &a, const GF2Poly &b, GF2Poly &r, unsigned threads = 1, uint8_t method = GF2POLY_AUTO);
+
+	/**
+	 * @brief Square polynomial
+	 * @param &a Polynomial
+	 * @param &r Square, may be the same as a
+	 * Squaring only spreads the coefficients apart, so it takes linear time.
+	 */
+	static void sqr(const GF2Poly &a, GF2Poly &r);
+
+	/**
+	 * @brief Multiply packed polynomials
+	 * @param *a Multiplicand
+	 * @param na Number of multiplicand words
+	 * @param *b Multiplier
+	 * @param nb Number of multiplier words
+	 * @param *r Product of na+nb words, must not overlap the operands
+	 * @param threads Number of threads, 0 to use all hardware threads
+	 * @param method Multiplication method, GF2POLY_AUTO to choose by size
+	 */
+	static void mulWords(const uint64_t *a, size_t na, const uint64_t *b, size_t nb, uint64_t *r, unsigned threads = 1, uint8_t method = GF2POLY_AUTO);
+
+	/**
+	 * @brief Initializes polynomial
+	 * @param *coefficients Packed coefficients, nullptr for the zero polynomial
+	 * @param words Number of words
+	 */
+	GF2Poly(const uint64_t *coefficients = nullptr, size_t words = 0);
+
+private:
+	std::vector<uint64_t> words; //packed coefficients
+};
+
+#endif
@@ -0,0 +1,213 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gf2w.cpp
+* @brief Table-free Galois field library for GF(2^w), w up to 32
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "gf2w.h"
+
+#ifdef __PCLMUL__
+#include <immintrin.h>
+
+/**
+ * @brief Carry-less multiplication, lower 64 bits of the result
+ * @param x Multiplicand
+ * @param y Multiplier
+ * @return Product
+ */
+static inline uint64_t clmul(uint64_t x, uint64_t y)
+{
+    return (uint64_t)_mm_cvtsi128_si64(_mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)x), _mm_cvtsi64_si128((long long)y), 0x00));
+}
+#endif
+
+//primitive polynomials for w = 2...32, including the x^w term
+static const uint64_t gf2wPoly[33] =
+{
+    0, 0, 0x7, 0xB, 0x13, 0x25, 0x43, 0x89, 0x11D, 0x211, 0x409, 0x805, 0x1053, 0x201B, 0x4443, 0x8003, 0x1100B,
+    0x20009, 0x40081, 0x80027, 0x100009, 0x200005, 0x400003, 0x800021, 0x1000087, 0x2000009, 0x4000047,
+    0x8000027, 0x10000009, 0x20000005, 0x40800007, 0x80000009, 0x100400007ULL,
+};
+
+uint32_t GF2w::add(uint32_t x, uint32_t y)
+{
+    return x ^ y;
+}
+
+uint32_t GF2w::sub(uint32_t x, uint32_t y)
+{
+    return x ^ y;
+}
+
+/**
+ * @brief Multiplication in GF(2^w)
+ * @param x Multiplicand
+ * @param y Multiplier
+ * @return Multiplication result
+ */
+uint32_t GF2w::mul(uint32_t x, uint32_t y)
+{
+#ifdef __PCLMUL__
+    //carry-less product has a degree of up to 2w-2
+    uint64_t c = clmul(x, y);
+    //Barrett reduction: quotient is ((c/x^w)*mu)/x^w, remainder is c-quotient*poly
+    uint64_t q = clmul(c >> w, mu) >> w;
+    return (uint32_t)((c ^ clmul(q, poly)) & mask);
+#else
+    //Russian Peasant Multiplication, the same as in GF2::slowMul()
+    uint32_t ret = 0;
+    uint64_t x_ = x;
+    while(y)
+    {
+        if(y & 1)
+            ret ^= (uint32_t)x_;
+        y >>= 1;
+        x_ <<= 1;
+        if((x_ >> w) & 1)
+            x_ ^= poly;
+    }
+    return ret;
+#endif
+}
+
+/**
+ * @brief Division in GF(2^w)
+ * @param dividend Dividend
+ * @param divisor Divisor
+ * @return Division result. 0 is returned when dividing by 0.
+ */
+uint32_t GF2w::div(uint32_t dividend, uint32_t divisor)
+{
+    if(divisor == 0) return 0; //illegal division by 0, but for now just return 0
+    return mul(dividend, inv(divisor));
+}
+
+/**
+ * @brief Power in GF(2^w)
+ * @param x Base
+ * @param exponent Exponent
+ * @return Result
+ */
+uint32_t GF2w::pow(uint32_t x, uint64_t exponent)
+{
+    uint32_t ret = 1;
+    while(exponent)
+    {
+        if(exponent & 1)
+            ret = mul(ret, x);
+        x = mul(x, x);
+        exponent >>= 1;
+    }
+    return ret;
+}
+
+/**
+ * @brief Inverse in GF(2^w)
+ * @param x Number of which inverse is calculated
+ * @return 1/x, 0 if x is 0
+ */
+uint32_t GF2w::inv(uint32_t x)
+{
+    if(x == 0) //0 has no inverse
+        return 0;
+    //x^(2^w-1)=1, so x^(2^w-2)=1/x
+    return pow(x, ((uint64_t)1 << w) - 2);
+}
+
+/**
+ * @brief Get field width
+ * @return w
+ */
+uint8_t GF2w::getWidth(void)
+{
+    return w;
+}
+
+/**
+ * @brief Get field polynomial
+ * @return Polynomial including the x^w term
+ */
+uint64_t GF2w::getPoly(void)
+{
+    return poly;
+}
+
+/**
+ * @brief Get default primitive polynomial for given width
+ * @param w Field width
+ * @return Polynomial including the x^w term, 0 if width is not supported
+ */
+uint64_t GF2w::defaultPoly(uint8_t w)
+{
+    if(w > 32)
+        return 0;
+    return gf2wPoly[w];
+}
+
+/**
+ * @brief Check if object is initialized
+ * @return 0 if initialized
+ */
+uint8_t GF2w::isInitialized(void)
+{
+    if(w)
+        return 0;
+
+    return 1;
+}
+
+/**
+ * @brief Initializes GF(2^w) object
+ * @param w Field width, 2 to 32
+ * @param poly Irreducible polynomial including the x^w term, 0 to use the default primitive polynomial
+ */
+GF2w::GF2w(uint8_t w, uint64_t poly)
+{
+    this->w = 0;
+    this->poly = 0;
+    mask = 0;
+    mu = 0;
+
+    if((w < 2) || (w > 32))
+        return; //unsupported width
+
+    if(poly == 0)
+        poly = gf2wPoly[w];
+    if((poly >> w) != 1)
+        return; //polynomial must be of degree w
+
+    this->w = w;
+    this->poly = poly;
+    mask = (uint32_t)(((uint64_t)1 << w) - 1);
+
+    //calculate mu=x^(2w)/poly with long division, keeping only w+1 bits of the remainder
+    uint64_t r = (uint64_t)1 << w;
+    for(int8_t i = w; i >= 0; i--)
+    {
+        if((r >> w) & 1)
+        {
+            mu |= (uint64_t)1 << i;
+            r ^= poly;
+        }
+        r <<= 1;
+    }
+}
@@ -0,0 +1,127 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gf2w.h
+* @brief Table-free Galois field library for GF(2^w), w up to 32
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef GF2W_H
+#define GF2W_H
+
+#include <stdint.h>
+
+/**
+ * @brief This class provides handling of GF(2^w) fields for 2 <= w <= 32
+ *
+ * Elements are stored in the same way as in GF2, but there are no lookup tables,
+ * since they would be way too big for wider fields. Multiplication is done with carry-less multiplication
+ * (PCLMULQDQ if available) followed by the reduction modulo field polynomial.
+ */
+class GF2w
+{
+public:
+	/**
+	 * @brief Addition in GF(2^w)
+	 * @param x Term 1
+	 * @param y Term 2
+	 * @return Sum
+	 */
+	uint32_t add(uint32_t x, uint32_t y);
+
+	/**
+	 * @brief Subtraction in GF(2^w)
+	 * @param x Minuend
+	 * @param y Subtrahend
+	 * @return Difference
+	 */
+	uint32_t sub(uint32_t x, uint32_t y);
+
+	/**
+	 * @brief Multiplication in GF(2^w)
+	 * @param x Multiplicand
+	 * @param y Multiplier
+	 * @return Multiplication result
+	 */
+	uint32_t mul(uint32_t x, uint32_t y);
+
+	/**
+	 * @brief Division in GF(2^w)
+	 * @param dividend Dividend
+	 * @param divisor Divisor
+	 * @return Division result. 0 is returned when dividing by 0.
+	 */
+	uint32_t div(uint32_t dividend, uint32_t divisor);
+
+	/**
+	 * @brief Power in GF(2^w)
+	 * @param x Base
+	 * @param exponent Exponent
+	 * @return Result
+	 */
+	uint32_t pow(uint32_t x, uint64_t exponent);
+
+	/**
+	 * @brief Inverse in GF(2^w)
+	 * @param x Number of which inverse is calculated
+	 * @return 1/x, 0 if x is 0
+	 */
+	uint32_t inv(uint32_t x);
+
+	/**
+	 * @brief Get field width
+	 * @return w
+	 */
+	uint8_t getWidth(void);
+
+	/**
+	 * @brief Get field polynomial
+	 * @return Polynomial including the x^w term
+	 */
+	uint64_t getPoly(void);
+
+	/**
+	 * @brief Get default primitive polynomial for given width
+	 * @param w Field width
+	 * @return Polynomial including the x^w term, 0 if width is not supported
+	 */
+	static uint64_t defaultPoly(uint8_t w);
+
+	/**
+	 * @brief Check if object is initialized
+	 * @return 0 if initialized
+	 */
+	uint8_t isInitialized(void);
+
+	/**
+	 * @brief Initializes GF(2^w) object
+	 * @param w Field width, 2 to 32
+	 * @param poly Irreducible polynomial including the x^w term, 0 to use the default primitive polynomial
+	 */
+	GF2w(uint8_t w, uint64_t poly = 0);
+
+private:
+	uint8_t w; //field width, 0 if not initialized
+	uint64_t poly; //field polynomial
+	uint32_t mask; //w-bit mask
+	uint64_t mu; //x^(2w)/poly, used for Barrett reduction
+};
+
+#endif
@@ -0,0 +1,322 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gfdlog.cpp
+* @brief Table-free discrete logarithm for GF(p) and GF(2^w)
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "gfdlog.h"
+
+/**
+ * @brief Hash function for baby-step table
+ * @param x Key
+ * @return Hash
+ */
+static inline uint32_t hash(uint32_t x)
+{
+    return (x * 0x9E3779B1U) ^ (x >> 16);
+}
+
+/**
+ * @brief Modular inverse using extended Euclidean algorithm
+ * @param a Number
+ * @param m Modulus
+ * @return a^(-1) mod m
+ */
+static uint64_t invMod(uint64_t a, uint64_t m)
+{
+    int64_t t = 0, newT = 1;
+    int64_t r = (int64_t)m, newR = (int64_t)(a % m);
+    while(newR)
+    {
+        int64_t k = r / newR;
+        int64_t x = t - k * newT;
+        t = newT;
+        newT = x;
+        x = r - k * newR;
+        r = newR;
+        newR = x;
+    }
+    if(t < 0)
+        t += (int64_t)m;
+    return (uint64_t)t;
+}
+
+uint32_t DLog::mul(uint32_t x, uint32_t y)
+{
+    if(p)
+        return (uint32_t)(((uint64_t)x * y) % p);
+    return field.mul(x, y);
+}
+
+uint32_t DLog::pow(uint32_t x, uint64_t exponent)
+{
+    uint32_t ret = 1;
+    while(exponent)
+    {
+        if(exponent & 1)
+            ret = mul(ret, x);
+        x = mul(x, x);
+        exponent >>= 1;
+    }
+    return ret;
+}
+
+/**
+ * @brief Baby-step giant-step logarithm in subgroup of prime order
+ * @param &f Factor data
+ * @param h Element of subgroup of order q
+ * @return Logarithm of h to the base gamma
+ */
+uint64_t DLog::bsgs(Factor &f, uint32_t h)
+{
+    //h=gamma^(i*m+j), so h*gamma^(-i*m)=gamma^j, which is looked up in the baby-step table
+    for(uint32_t i = 0; i <= f.m; i++)
+    {
+        uint32_t k = hash(h) & f.tableMask;
+        while(f.keys[k])
+        {
+            if(f.keys[k] == h)
+                return (uint64_t)i * f.m + f.values[k];
+            k = (k + 1) & f.tableMask;
+        }
+        h = mul(h, f.giant);
+    }
+    return 0; //should never happen for a valid generator
+}
+
+/**
+ * @brief Calculate discrete logarithm
+ * @param x Field element
+ * @return Logarithm of x to the base of generator, DLOG_UNDEFINED if x is 0 (mod p for GF(p))
+ */
+uint64_t DLog::log(uint32_t x)
+{
+    if(n == 0)
+        return DLOG_UNDEFINED;
+    //reduced first, so that multiples of p are 0 too
+    if(p)
+        x %= p;
+    if(x == 0)
+        return DLOG_UNDEFINED;
+
+    uint64_t ret = 0;
+    for(size_t i = 0; i < factors.size(); i++)
+    {
+        Factor &f = factors[i];
+        //project x and g onto the subgroup of order q^e
+        uint32_t a = pow(x, f.cofactor);
+        //find base-q digits of the logarithm one by one
+        uint64_t l = 0;
+        uint64_t qk = 1;
+        uint64_t rest = f.qe / f.q; //q^(e-1-k)
+        for(uint8_t k = 0; k < f.e; k++)
+        {
+            uint32_t h = pow(mul(a, pow(f.gInv, l)), rest);
+            l += bsgs(f, h) * qk;
+            qk *= f.q;
+            rest /= f.q;
+        }
+        //Chinese remainder theorem
+        ret = (ret + ((l * f.crt) % f.qe) * f.cofactor) % n;
+    }
+    return ret;
+}
+
+/**
+ * @brief Calculate discrete logarithms of multiple elements
+ * @param *x Field elements
+ * @param *out Output logarithms
+ * @param n Number of elements
+ */
+void DLog::log(const uint32_t *x, uint64_t *out, size_t n)
+{
+    for(size_t i = 0; i < n; i++)
+        out[i] = log(x[i]);
+}
+
+/**
+ * @brief Get logarithm base
+ * @return Generator of the multiplicative group
+ */
+uint32_t DLog::getGenerator(void)
+{
+    return g;
+}
+
+/**
+ * @brief Get multiplicative group order
+ * @return Group order
+ */
+uint64_t DLog::getOrder(void)
+{
+    return n;
+}
+
+/**
+ * @brief Check if object is initialized
+ * @return 0 if initialized
+ */
+uint8_t DLog::isInitialized(void)
+{
+    if(n)
+        return 0;
+
+    return 1;
+}
+
+/**
+ * @brief Factor group order, find generator and build baby-step tables
+ * @param g Requested generator, 0 to find one
+ * @return 0 on success, 1 if g is not a generator or there is no generator
+ */
+uint8_t DLog::setup(uint32_t g)
+{
+    uint64_t order = n;
+    n = 0;
+
+    //factor group order with trial division, it is at most 2^32-1, so this is quick
+    uint64_t r = order;
+    for(uint64_t q = 2; q * q <= r; q++)
+    {
+        if((r % q) == 0)
+        {
+            Factor f = Factor();
+            f.q = q;
+            f.e = 0;
+            f.qe = 1;
+            while((r % q) == 0)
+            {
+                r /= q;
+                f.e++;
+                f.qe *= q;
+            }
+            factors.push_back(f);
+        }
+    }
+    if(r > 1)
+    {
+        Factor f = Factor();
+        f.q = r;
+        f.e = 1;
+        f.qe = r;
+        factors.push_back(f);
+    }
+
+    //g is a generator if g^n=1 and g^(n/q)!=1 for every prime factor q of n
+    //g^n=1 always holds in a field, but not if the GF(2^w) polynomial is reducible, and then there may be no generator at all
+    uint64_t candidate = (g != 0) ? g : ((order > 1) ? 2 : 1);
+    while(1)
+    {
+        if(candidate > order)
+            return 1; //no generator in the group
+        size_t i = 0;
+        for(; i < factors.size(); i++)
+        {
+            if(pow((uint32_t)candidate, order / factors[i].q) == 1)
+                break;
+        }
+        if((i == factors.size()) && (pow((uint32_t)candidate, order) == 1))
+            break;
+        if(g != 0)
+            return 1; //requested base is not a generator
+        candidate++;
+    }
+    this->g = (uint32_t)candidate;
+
+    for(size_t i = 0; i < factors.size(); i++)
+    {
+        Factor &f = factors[i];
+        f.cofactor = order / f.qe;
+        f.crt = invMod(f.cofactor % f.qe, f.qe);
+        f.gInv = pow(pow(this->g, f.cofactor), f.qe - 1);
+        f.gamma = pow(this->g, order / f.q);
+        f.m = 1;
+        while(((uint64_t)f.m * f.m) < f.q)
+            f.m++;
+        uint32_t size = 2;
+        while(size < (2 * f.m))
+            size <<= 1;
+        f.tableMask = size - 1;
+        f.keys.assign(size, 0);
+        f.values.assign(size, 0);
+        uint32_t x = 1;
+        for(uint32_t j = 0; j < f.m; j++)
+        {
+            uint32_t k = hash(x) & f.tableMask;
+            while(f.keys[k])
+                k = (k + 1) & f.tableMask;
+            f.keys[k] = x;
+            f.values[k] = j;
+            x = mul(x, f.gamma);
+        }
+        //x is gamma^m now, giant step is its inverse gamma^(q-m)
+        f.giant = pow(f.gamma, f.q - (f.m % f.q));
+    }
+
+    n = order;
+    return 0;
+}
+
+/**
+ * @brief Initializes discrete logarithm for GF(p)
+ * @param p Field characteristic, must be prime
+ * @param g Logarithm base, must be a primitive root. 0 to use the smallest primitive root, which is also used by GFn
+ */
+DLog::DLog(uint32_t p, uint32_t g) : field(0)
+{
+    this->p = 0;
+    this->g = 0;
+    n = 0;
+
+    if(p < 2)
+        return;
+    for(uint32_t i = 2; (uint64_t)i * i <= p; i++)
+    {
+        if((p % i) == 0)
+            return; //not a prime number
+    }
+    if((g % p) == 0 && (g != 0))
+        return;
+
+    this->p = p;
+    n = p - 1;
+    if(setup(g % p))
+        this->p = 0;
+}
+
+/**
+ * @brief Initializes discrete logarithm for GF(2^w)
+ * @param field Field object, the object is not initialized if its polynomial is reducible and there is no primitive element
+ * @param g Logarithm base, must be a primitive element. 0 to use the smallest primitive element (x for primitive polynomials)
+ */
+DLog::DLog(GF2w &field, uint32_t g) : field(field)
+{
+    p = 0;
+    this->g = 0;
+    n = 0;
+
+    if(this->field.isInitialized())
+        return;
+
+    n = ((uint64_t)1 << this->field.getWidth()) - 1;
+    setup(g);
+}
@@ -0,0 +1,126 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gfdlog.h
+* @brief Table-free discrete logarithm for GF(p) and GF(2^w)
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef GFDLOG_H
+#define GFDLOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "gf2w.h"
+
+#define DLOG_UNDEFINED 0xFFFFFFFFFFFFFFFFULL //logarithm of 0
+
+/**
+ * @brief This class provides discrete logarithm in fields too big for a full logarithm table
+ *
+ * The order of the multiplicative group (q-1) is factored and the logarithm is found separately
+ * for every prime factor using Pohlig-Hellman algorithm. Logarithms in subgroups of prime order are found
+ * with baby-step giant-step algorithm. Baby-step tables are calculated once in the constructor,
+ * so they are shared by all queries.
+ */
+class DLog
+{
+public:
+	/**
+	 * @brief Calculate discrete logarithm
+	 * @param x Field element
+	 * @return Logarithm of x to the base of generator, DLOG_UNDEFINED if x is 0 (mod p for GF(p))
+	 */
+	uint64_t log(uint32_t x);
+
+	/**
+	 * @brief Calculate discrete logarithms of multiple elements
+	 * @param *x Field elements
+	 * @param *out Output logarithms
+	 * @param n Number of elements
+	 */
+	void log(const uint32_t *x, uint64_t *out, size_t n);
+
+	/**
+	 * @brief Get logarithm base
+	 * @return Generator of the multiplicative group
+	 */
+	uint32_t getGenerator(void);
+
+	/**
+	 * @brief Get multiplicative group order
+	 * @return Group order
+	 */
+	uint64_t getOrder(void);
+
+	/**
+	 * @brief Check if object is initialized
+	 * @return 0 if initialized
+	 */
+	uint8_t isInitialized(void);
+
+	/**
+	 * @brief Initializes discrete logarithm for GF(p)
+	 * @param p Field characteristic, must be prime
+	 * @param g Logarithm base, must be a primitive root. 0 to use the smallest primitive root, which is also used by GFn
+	 */
+	DLog(uint32_t p, uint32_t g = 0);
+
+	/**
+	 * @brief Initializes discrete logarithm for GF(2^w)
+	 * @param field Field object, the object is not initialized if its polynomial is reducible and there is no primitive element
+	 * @param g Logarithm base, must be a primitive element. 0 to use the smallest primitive element (x for primitive polynomials)
+	 */
+	DLog(GF2w &field, uint32_t g = 0);
+
+private:
+	/**
+	 * @brief Precomputed data for a prime factor of group order
+	 */
+	struct Factor
+	{
+		uint64_t q; //prime factor
+		uint8_t e; //multiplicity
+		uint64_t qe; //q^e
+		uint64_t cofactor; //n/q^e
+		uint64_t crt; //(n/q^e)^(-1) mod q^e
+		uint32_t gInv; //g^(-n/q^e), inverse of generator of subgroup of order q^e
+		uint32_t gamma; //g^(n/q), generator of subgroup of order q
+		uint32_t giant; //gamma^(-m), giant step
+		uint32_t m; //number of baby steps
+		uint32_t tableMask; //hash table size - 1
+		std::vector<uint32_t> keys; //baby steps gamma^j, 0 for empty entry
+		std::vector<uint32_t> values; //baby step exponents j
+	};
+
+	GF2w field; //binary field, not initialized in GF(p) mode
+	uint32_t p; //prime field characteristic, 0 in GF(2^w) mode
+	uint32_t g; //generator
+	uint64_t n; //group order
+	std::vector<Factor> factors; //group order factorization
+
+	uint32_t mul(uint32_t x, uint32_t y);
+	uint32_t pow(uint32_t x, uint64_t exponent);
+	uint8_t setup(uint32_t g); //factor group order, find generator and build tables
+	uint64_t bsgs(Factor &f, uint32_t h); //logarithm to the base gamma in subgroup of order q
+};
+
+#endif
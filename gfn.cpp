@@ -121,7 +121,7 @@ uint16_t GFn::slowMul(uint16_t x, uint16_t y)
     if(x == 0 || y == 0)
         return 0;
 
-    return (x * y) % len;
+    return ((uint32_t)x * y) % len;
 }
 
 /**
@@ -134,12 +134,12 @@ int8_t GFn::checkPrime(uint16_t x)
 	if(x < 2)
 		return -1; //definitely not primes
 
-	for(uint16_t i = 2; i < (x >> 1); i++)
+	for(uint32_t i = 2; (i * i) <= x; i++)
 	{
 		if((x % i) == 0) //divisible by something - not a prime
 			return -1;
 	}
-	return 0; //probably prime
+	return 0; //prime
 }
 
 /**
@@ -164,6 +164,57 @@ uint16_t GFn::findPrime(uint16_t max)
 	return 0;
 }
 
+/**
+ * @brief Finds the smallest primitive root modulo p
+ * @param p Prime number
+ * @return Primitive root, 0 if fail
+ */
+uint16_t GFn::findGenerator(uint16_t p)
+{
+	if(checkPrime(p) != 0)
+		return 0;
+	if(p == 2)
+		return 1;
+
+	//collect prime factors of p-1, which is the order of the multiplicative group
+	uint16_t factors[16];
+	uint8_t count = 0;
+	uint16_t n = p - 1;
+	for(uint16_t q = 2; (uint32_t)q * q <= n; q++)
+	{
+		if((n % q) == 0)
+		{
+			factors[count++] = q;
+			while((n % q) == 0)
+				n /= q;
+		}
+	}
+	if(n > 1)
+		factors[count++] = n;
+
+	//g is a generator if g^((p-1)/q)!=1 for every prime factor q of p-1
+	for(uint16_t g = 2; g < p; g++)
+	{
+		uint8_t i = 0;
+		for(; i < count; i++)
+		{
+			uint32_t e = (p - 1) / factors[i];
+			uint32_t x = 1, b = g;
+			while(e)
+			{
+				if(e & 1)
+					x = (x * b) % p;
+				b = (b * b) % p;
+				e >>= 1;
+			}
+			if(x == 1)
+				break;
+		}
+		if(i == count)
+			return g;
+	}
+	return 0;
+}
 
 /**
  * @brief Check if object is initialized
@@ -184,20 +235,23 @@ uint8_t GFn::isInitialized(void)
 GFn::GFn(uint16_t p)
 {
     len = 0;
+    exp = nullptr;
+    log = nullptr;
 
 	if(checkPrime(p) != 0)
     	return; //not a prime number
 
     len = p; //store characteristic
 
-	//TODO: I don't know yet why, but to generator number to generate lookup tables must be the highest prime number lower than the GF characteristic
-	//otherwise we will get non-unique values
+	//the generator number must be a primitive root modulo p, that is its powers must give all non-zero elements
+	//otherwise we will get non-unique values in lookup tables
     //in "standard" Galois fields GF(p^n), where n>1, the elements of this field are polynomials with a degree of up to n-1
     //the generator polynomial has a degree of n and must be irreducible
-	uint16_t gen = findPrime(p);
+	uint16_t gen = findGenerator(p);
 
     //initialize lookup tables for fast calculations
-    exp = new uint16_t[len]; //exponential function table for every possible exponent in this field
+    uint16_t *t = new uint16_t[2 * (uint32_t)len](); //both tables in one allocation
+    uint16_t *expTable = t; //exponential function table for every possible exponent in this field
     //if we have GF(p), there are p numbers in this field: 0,...,p-1
     //we can have the exp(x), where x is any element of GF(p), so it creates a table of p elements
     //for log(x) we can have all elements of GF(p) except 0 (log(0) is not defined).
@@ -206,23 +260,41 @@ GFn::GFn(uint16_t p)
     //For example, in GF(7) with generator number 5, exp(0)=exp(6)=1 and that's true (7^0=1 and 7^6 mod 7=1)
     //although this is a problem for the logarithm, as it will have two different values for the same argument (log(1)=0 and log(1)=6)
     //log(x) is a function, so it must have only one value associated with one value. Just drop the log(1)=6.
-    log = new uint16_t[len]; //logarithmic function table
+    uint16_t *logTable = t + len; //logarithmic function table
 
     uint16_t x = 1;
     //fill lookup tables
     for(uint16_t i = 0; i < (len - 1); i++) //skip the last element for log table
     {
-    	exp[i] = x;
-        log[x] = i;
+    	expTable[i] = x;
+        logTable[x] = i;
         x = slowMul(x, gen); //get next x by multiplying it by the generator number
     }
-    exp[len - 1] = x; //store last element in exp table
+    expTable[len - 1] = x; //store last element in exp table
+
+    tables = std::shared_ptr<const uint16_t>(t, std::default_delete<const uint16_t[]>());
+    exp = expTable;
+    log = logTable;
 }
 
-GFn::~GFn()
+GFn::GFn(GFn &&other) noexcept : tables(std::move(other.tables)), exp(other.exp), log(other.log), len(other.len)
 {
-    if(exp != nullptr)
-        delete[] exp;
-    if(log != nullptr)
-        delete[] log;
+    other.exp = nullptr;
+    other.log = nullptr;
+    other.len = 0;
+}
+
+GFn &GFn::operator=(GFn &&other) noexcept
+{
+    if(this != &other)
+    {
+        tables = std::move(other.tables);
+        exp = other.exp;
+        log = other.log;
+        len = other.len;
+        other.exp = nullptr;
+        other.log = nullptr;
+        other.len = 0;
+    }
+    return *this;
 }
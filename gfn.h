@@ -29,9 +29,12 @@
 
 #include <stdint.h>
 #include <string.h>
+#include <memory>
 
 /**
  * @brief This class provides handling of GF(p) fields
+ *
+ * Lookup tables are immutable and shared between copies of an object, so copying does not allocate.
  */
 class GFn
 {
@@ -104,6 +107,14 @@ public:
 	 */
 	static uint16_t findPrime(uint16_t max);
 
+	/**
+	 * @brief Finds the smallest primitive root modulo p
+	 * @param p Prime number
+	 * @return Primitive root, 0 if fail
+	 * This is the logarithm base used by the lookup tables.
+	 */
+	static uint16_t findGenerator(uint16_t p);
+
 	/**
 	 * @brief Check if object is initialized
 	 * @return 0 if initialized
@@ -115,11 +126,15 @@ public:
 	 * @param p Field characteristic GF(p), must be prime
 	 */
 	GFn(uint16_t p);
-	~GFn();
+	GFn(const GFn &other) = default;
+	GFn(GFn &&other) noexcept;
+	GFn &operator=(const GFn &other) = default;
+	GFn &operator=(GFn &&other) noexcept;
 
 private:
-    uint16_t *exp; //exponent lookup table
-    uint16_t *log; //logarithm lookup table
+    std::shared_ptr<const uint16_t> tables; //shared lookup tables, owns exp and log
+    const uint16_t *exp; //exponent lookup table
+    const uint16_t *log; //logarithm lookup table
     uint16_t len; //field characteristic
 };
 
@@ -0,0 +1,464 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gfnormal.cpp
+* @brief Normal basis arithmetic for GF(2^w)
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "gfnormal.h"
+#include "gfroots.h"
+
+#ifdef __PCLMUL__
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Check if number is prime
+ * @param p Number
+ * @return true if prime
+ */
+static bool isPrime(uint32_t p)
+{
+    if(p < 2)
+        return false;
+    for(uint32_t i = 2; (i * i) <= p; i++)
+    {
+        if((p % i) == 0)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Get multiplicative order of 2 modulo odd p
+ * @param p Modulus
+ * @return Smallest k > 0 such that 2^k = 1 mod p
+ */
+static uint32_t order2(uint32_t p)
+{
+    uint32_t x = 2 % p, k = 1;
+    while(x != 1)
+    {
+        x = (x * 2) % p;
+        k++;
+    }
+    return k;
+}
+
+/**
+ * @brief Apply linear map using lookup tables
+ * @param *table Lookup tables, 256 entries per input byte
+ * @param bytes Number of input bytes
+ * @param x Input word
+ * @return Output word
+ */
+inline uint32_t NormalBasis::convert(const uint32_t *table, uint8_t bytes, uint32_t x)
+{
+    uint32_t ret = 0;
+    for(uint8_t i = 0; i < bytes; i++)
+        ret ^= table[i * 256 + ((x >> (8 * i)) & 0xFF)];
+    return ret;
+}
+
+/**
+ * @brief Build conversion tables and multiplication matrix for normal element
+ * @param b Candidate element in polynomial basis
+ * @return 0 on success, 1 if b is not a normal element
+ */
+uint8_t NormalBasis::setBasis(uint32_t b)
+{
+    //basis elements b^(2^i) in polynomial basis
+    std::vector<uint32_t> basis(w);
+    basis[0] = b;
+    for(uint8_t i = 1; i < w; i++)
+        basis[i] = field.mul(basis[i - 1], basis[i - 1]);
+
+    //invert the matrix with rows b^(2^i) over GF(2), row j of the inverse is then x^j in normal basis
+    std::vector<uint32_t> a(basis), inverse(w);
+    for(uint8_t i = 0; i < w; i++)
+        inverse[i] = (uint32_t)1 << i;
+    for(uint8_t c = 0; c < w; c++)
+    {
+        uint8_t r = c;
+        while((r < w) && !((a[r] >> c) & 1))
+            r++;
+        if(r == w)
+            return 1; //singular, b is not normal
+        uint32_t t = a[r];
+        a[r] = a[c];
+        a[c] = t;
+        t = inverse[r];
+        inverse[r] = inverse[c];
+        inverse[c] = t;
+        for(uint8_t i = 0; i < w; i++)
+        {
+            if((i != c) && ((a[i] >> c) & 1))
+            {
+                a[i] ^= a[c];
+                inverse[i] ^= inverse[c];
+            }
+        }
+    }
+
+    uint8_t bytes = (w + 7) / 8;
+    toNormalTable.assign(bytes * 256, 0);
+    toPolyTable.assign(bytes * 256, 0);
+    for(uint8_t i = 0; i < w; i++)
+    {
+        for(uint16_t v = 0; v < 256; v++)
+        {
+            if((v >> (i & 7)) & 1)
+            {
+                toNormalTable[(i >> 3) * 256 + v] ^= inverse[i];
+                toPolyTable[(i >> 3) * 256 + v] ^= basis[i];
+            }
+        }
+    }
+
+    //multiplication matrix: coefficient of b in b^(2^i)*b^(2^j), the others are its cyclic shifts
+    terms.clear();
+    rowStart.assign(w + 1, 0);
+    for(uint8_t i = 0; i < w; i++)
+    {
+        rowStart[i] = (uint16_t)terms.size();
+        for(uint8_t j = 0; j < w; j++)
+        {
+            if(convert(toNormalTable.data(), bytes, field.mul(basis[i], basis[j])) & 1)
+                terms.push_back(j);
+        }
+    }
+    rowStart[w] = (uint16_t)terms.size();
+    return 0;
+}
+
+/**
+ * @brief Build cyclic representation tables for optimal normal basis
+ */
+void NormalBasis::setCyclic(void)
+{
+    cycle = 0;
+#ifdef __PCLMUL__
+    uint32_t n = (type == NORMAL_TYPE1) ? (w + 1) : (2 * w + 1);
+    if((type == NORMAL_GENERAL) || (n > 63))
+        return;
+    //basis element i is c^(2^i) (type I) or c^(2^i) + c^(-2^i) (type II)
+    uint8_t bytes = (w + 7) / 8, cyclicBytes = (n + 7) / 8;
+    toCyclicTable.assign(bytes * 256, 0);
+    fromCyclicTable.assign(cyclicBytes * 256, 0);
+    uint32_t e = 1;
+    for(uint8_t i = 0; i < w; i++)
+    {
+        uint64_t positions = (uint64_t)1 << e;
+        if(type == NORMAL_TYPE2)
+            positions |= (uint64_t)1 << (n - e);
+        for(uint16_t v = 0; v < 256; v++)
+        {
+            if((v >> (i & 7)) & 1)
+                toCyclicTable[(i >> 3) * 256 + v] |= positions;
+            if((v >> (e & 7)) & 1)
+                fromCyclicTable[(e >> 3) * 256 + v] |= (uint32_t)1 << i;
+        }
+        e = (e * 2) % n;
+    }
+    cycle = (uint8_t)n;
+#endif
+}
+
+/**
+ * @brief Multiplication in normal basis
+ * @param x Multiplicand
+ * @param y Multiplier
+ * @return Multiplication result
+ */
+uint32_t NormalBasis::mul(uint32_t x, uint32_t y)
+{
+#ifdef __PCLMUL__
+    if(cycle)
+    {
+        uint8_t bytes = (w + 7) / 8;
+        uint64_t u = 0, v = 0;
+        for(uint8_t i = 0; i < bytes; i++)
+        {
+            u |= toCyclicTable[i * 256 + ((x >> (8 * i)) & 0xFF)];
+            v |= toCyclicTable[i * 256 + ((y >> (8 * i)) & 0xFF)];
+        }
+        __m128i p = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long)u), _mm_cvtsi64_si128((long long)v), 0x00);
+        uint64_t lo = (uint64_t)_mm_cvtsi128_si64(p), hi = (uint64_t)_mm_cvtsi128_si64(_mm_unpackhi_epi64(p, p));
+        //reduce modulo x^N - 1, then replace c^0 = 1 with the sum of all other powers
+        uint64_t nmask = ((uint64_t)1 << cycle) - 1;
+        uint64_t c = (lo & nmask) ^ (lo >> cycle) ^ (hi << (64 - cycle));
+        if(c & 1)
+            c ^= nmask;
+        uint32_t ret = 0;
+        for(uint8_t i = 0; i < ((cycle + 7) / 8); i++)
+            ret |= fromCyclicTable[i * 256 + ((c >> (8 * i)) & 0xFF)];
+        return ret;
+    }
+#endif
+    //doubled words, so that a cyclic rotation is a single shift
+    uint64_t xx = (uint64_t)x | ((uint64_t)x << w);
+    uint64_t yy = (uint64_t)y | ((uint64_t)y << w);
+    uint64_t ret = 0;
+    const uint8_t *t = terms.data();
+    for(uint8_t i = 0; i < w; i++)
+    {
+        uint64_t s = 0;
+        for(uint16_t j = rowStart[i]; j < rowStart[i + 1]; j++)
+            s ^= yy >> t[j];
+        ret ^= (xx >> i) & s;
+    }
+    return (uint32_t)ret & mask;
+}
+
+/**
+ * @brief Squaring in normal basis
+ * @param x Element
+ * @return x^2
+ */
+uint32_t NormalBasis::sqr(uint32_t x)
+{
+    return (uint32_t)((((uint64_t)x << 1) | (x >> (w - 1))) & mask);
+}
+
+/**
+ * @brief Repeated squaring in normal basis
+ * @param x Element
+ * @param k Number of squarings
+ * @return x^(2^k)
+ */
+uint32_t NormalBasis::sqrN(uint32_t x, uint32_t k)
+{
+    k %= w;
+    if(k == 0)
+        return x;
+    return (uint32_t)((((uint64_t)x << k) | (x >> (w - k))) & mask);
+}
+
+/**
+ * @brief Power in normal basis
+ * @param x Base
+ * @param exponent Exponent
+ * @return Result
+ */
+uint32_t NormalBasis::pow(uint32_t x, uint64_t exponent)
+{
+    uint32_t ret = mask;
+    while(exponent)
+    {
+        if(exponent & 1)
+            ret = mul(ret, x);
+        x = sqr(x);
+        exponent >>= 1;
+    }
+    return ret;
+}
+
+/**
+ * @brief Inverse in normal basis
+ * @param x Number of which inverse is calculated
+ * @return 1/x, 0 if x is 0
+ */
+uint32_t NormalBasis::inv(uint32_t x)
+{
+    if(x == 0)
+        return 0;
+    //1/x = x^(2^w - 2) = (x^(2^(w-1) - 1))^2, where r = x^(2^k - 1) is built with r^(2^k)*r and r^2*x steps
+    uint32_t e = w - 1;
+    uint8_t top = 31 - __builtin_clz(e);
+    uint32_t r = x, k = 1;
+    for(int8_t i = top - 1; i >= 0; i--)
+    {
+        r = mul(sqrN(r, k), r);
+        k *= 2;
+        if((e >> i) & 1)
+        {
+            r = mul(sqr(r), x);
+            k++;
+        }
+    }
+    return sqr(r);
+}
+
+/**
+ * @brief Absolute trace
+ * @param x Element
+ * @return Tr(x), 0 or 1
+ */
+uint8_t NormalBasis::trace(uint32_t x)
+{
+    //trace of every basis element is the trace of b, which is 1 for a normal element
+    return (uint8_t)__builtin_parity(x);
+}
+
+/**
+ * @brief Get unity element
+ * @return 1 in normal basis (all bits set)
+ */
+uint32_t NormalBasis::one(void)
+{
+    return mask;
+}
+
+/**
+ * @brief Convert element from polynomial basis
+ * @param x Element in polynomial basis
+ * @return Element in normal basis
+ */
+uint32_t NormalBasis::toNormal(uint32_t x)
+{
+    return convert(toNormalTable.data(), (w + 7) / 8, x);
+}
+
+/**
+ * @brief Convert element to polynomial basis
+ * @param x Element in normal basis
+ * @return Element in polynomial basis
+ */
+uint32_t NormalBasis::toPoly(uint32_t x)
+{
+    return convert(toPolyTable.data(), (w + 7) / 8, x);
+}
+
+/**
+ * @brief Convert many elements from polynomial basis
+ * @param *src Elements in polynomial basis
+ * @param *dst Output elements in normal basis, may be the same as src
+ * @param n Number of elements
+ */
+void NormalBasis::toNormal(const uint32_t *src, uint32_t *dst, size_t n)
+{
+    const uint32_t *table = toNormalTable.data();
+    uint8_t bytes = (w + 7) / 8;
+    for(size_t i = 0; i < n; i++)
+        dst[i] = convert(table, bytes, src[i]);
+}
+
+/**
+ * @brief Convert many elements to polynomial basis
+ * @param *src Elements in normal basis
+ * @param *dst Output elements in polynomial basis, may be the same as src
+ * @param n Number of elements
+ */
+void NormalBasis::toPoly(const uint32_t *src, uint32_t *dst, size_t n)
+{
+    const uint32_t *table = toPolyTable.data();
+    uint8_t bytes = (w + 7) / 8;
+    for(size_t i = 0; i < n; i++)
+        dst[i] = convert(table, bytes, src[i]);
+}
+
+/**
+ * @brief Get basis type
+ * @return NORMAL_TYPE1, NORMAL_TYPE2 or NORMAL_GENERAL
+ */
+uint8_t NormalBasis::getType(void)
+{
+    return type;
+}
+
+/**
+ * @brief Get basis complexity
+ * @return Number of ones in the multiplication matrix, 2w-1 for optimal normal basis
+ */
+uint32_t NormalBasis::getComplexity(void)
+{
+    return (uint32_t)terms.size();
+}
+
+/**
+ * @brief Check if object is initialized
+ * @return 0 if initialized
+ */
+uint8_t NormalBasis::isInitialized(void)
+{
+    return (w == 0);
+}
+
+/**
+ * @brief Initializes normal basis
+ * @param &field Field object, copied
+ */
+NormalBasis::NormalBasis(GF2w &field) : field(field)
+{
+    w = 0;
+    mask = 0;
+    type = NORMAL_GENERAL;
+    cycle = 0;
+    if(this->field.isInitialized())
+        return;
+    uint8_t width = this->field.getWidth();
+    w = width;
+    mask = (uint32_t)(((uint64_t)1 << w) - 1);
+
+    //minimal polynomial of the optimal normal element, if there is one
+    uint64_t f = 0;
+    if(isPrime(w + 1) && (order2(w + 1) == w))
+    {
+        //type I: primitive (w+1)-th root of unity, root of x^w + ... + x + 1
+        type = NORMAL_TYPE1;
+        f = ((uint64_t)1 << (w + 1)) - 1;
+    }
+    else if(isPrime(2 * w + 1) && ((order2(2 * w + 1) == 2 * w) || (((2 * w + 1) % 4 == 3) && (order2(2 * w + 1) == w))))
+    {
+        //type II: c + 1/c for primitive (2w+1)-th root of unity c, root of f_w where f_0 = 1, f_1 = x + 1, f_i = x*f_(i-1) + f_(i-2)
+        type = NORMAL_TYPE2;
+        uint64_t f0 = 1, f1 = 3;
+        for(uint8_t i = 1; i < w; i++)
+        {
+            uint64_t t = (f1 << 1) ^ f0;
+            f0 = f1;
+            f1 = t;
+        }
+        f = f1;
+    }
+
+    if(type != NORMAL_GENERAL)
+    {
+        std::vector<uint32_t> poly(w + 1), roots;
+        for(uint8_t i = 0; i <= w; i++)
+            poly[i] = (f >> i) & 1;
+        PolyRoots finder(this->field);
+        if(finder.roots(poly, roots) && !setBasis(roots[0]))
+        {
+            setCyclic();
+            return;
+        }
+        type = NORMAL_GENERAL;
+    }
+
+    //no optimal normal basis, take the simplest one among some candidates
+    uint32_t best = 0, bestComplexity = UINT32_MAX;
+    uint64_t candidates = ((uint64_t)1 << w) < NORMAL_CANDIDATES ? ((uint64_t)1 << w) : NORMAL_CANDIDATES;
+    for(uint32_t i = 1; i < candidates; i++)
+    {
+        //in big fields spread candidates over the whole field, small elements may all have zero trace
+        uint32_t b = (candidates < NORMAL_CANDIDATES) ? i : ((uint32_t)((i * 0x9E3779B97F4A7C15ULL) >> 32) & mask);
+        if((b == 0) || setBasis(b))
+            continue;
+        if(terms.size() < bestComplexity)
+        {
+            best = b;
+            bestComplexity = (uint32_t)terms.size();
+        }
+    }
+    if((best == 0) || setBasis(best))
+        w = 0;
+}
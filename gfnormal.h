@@ -0,0 +1,181 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gfnormal.h
+* @brief Normal basis arithmetic for GF(2^w)
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef GFNORMAL_H
+#define GFNORMAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "gf2w.h"
+
+#define NORMAL_GENERAL 0 //normal basis that is not optimal
+#define NORMAL_TYPE1 1 //type I optimal normal basis, w+1 is prime
+#define NORMAL_TYPE2 2 //type II optimal normal basis, 2w+1 is prime
+#define NORMAL_CANDIDATES 256 //number of candidate elements tested when there is no optimal normal basis
+
+/**
+ * @brief This class provides GF(2^w) arithmetic in a normal basis
+ *
+ * An element is a = sum of a_i*b^(2^i), where b is a normal element of the field given by a GF2w object.
+ * Bit i of a word is a_i, so squaring is just a cyclic rotation by one bit and the trace is the parity of all bits.
+ * Multiplication is the word-parallel Massey-Omura scheme: c = sum of rot(a, i) & rot(b, j) over all ones (i, j)
+ * of the multiplication matrix. An optimal normal basis (type I or II) is used if it exists for given w,
+ * so the matrix has only 2w-1 ones. Otherwise the basis with the lowest complexity found among
+ * NORMAL_CANDIDATES elements is used (e.g. for w = 8, where no optimal normal basis exists).
+ * Elements of an optimal normal basis are also sums of powers of an N-th root of unity (N = w+1 for type I,
+ * N = 2w+1 for type II), so when carry-less multiplication (PCLMULQDQ) is available, they are multiplied
+ * in this cyclic representation instead: bits are permuted with lookup tables and multiplied modulo x^N - 1.
+ * Conversions to and from the polynomial basis of the GF2w object (and GF2 for w = 8 with the same polynomial)
+ * are linear maps applied with byte lookup tables.
+ */
+class NormalBasis
+{
+public:
+	/**
+	 * @brief Multiplication in normal basis
+	 * @param x Multiplicand
+	 * @param y Multiplier
+	 * @return Multiplication result
+	 */
+	uint32_t mul(uint32_t x, uint32_t y);
+
+	/**
+	 * @brief Squaring in normal basis
+	 * @param x Element
+	 * @return x^2
+	 */
+	uint32_t sqr(uint32_t x);
+
+	/**
+	 * @brief Repeated squaring in normal basis
+	 * @param x Element
+	 * @param k Number of squarings
+	 * @return x^(2^k)
+	 */
+	uint32_t sqrN(uint32_t x, uint32_t k);
+
+	/**
+	 * @brief Power in normal basis
+	 * @param x Base
+	 * @param exponent Exponent
+	 * @return Result
+	 */
+	uint32_t pow(uint32_t x, uint64_t exponent);
+
+	/**
+	 * @brief Inverse in normal basis
+	 * @param x Number of which inverse is calculated
+	 * @return 1/x, 0 if x is 0
+	 * Uses Itoh-Tsujii algorithm, which needs only about log2(w) multiplications, as squarings are free.
+	 */
+	uint32_t inv(uint32_t x);
+
+	/**
+	 * @brief Absolute trace
+	 * @param x Element
+	 * @return Tr(x), 0 or 1
+	 */
+	uint8_t trace(uint32_t x);
+
+	/**
+	 * @brief Get unity element
+	 * @return 1 in normal basis (all bits set)
+	 */
+	uint32_t one(void);
+
+	/**
+	 * @brief Convert element from polynomial basis
+	 * @param x Element in polynomial basis
+	 * @return Element in normal basis
+	 */
+	uint32_t toNormal(uint32_t x);
+
+	/**
+	 * @brief Convert element to polynomial basis
+	 * @param x Element in normal basis
+	 * @return Element in polynomial basis
+	 */
+	uint32_t toPoly(uint32_t x);
+
+	/**
+	 * @brief Convert many elements from polynomial basis
+	 * @param *src Elements in polynomial basis
+	 * @param *dst Output elements in normal basis, may be the same as src
+	 * @param n Number of elements
+	 */
+	void toNormal(const uint32_t *src, uint32_t *dst, size_t n);
+
+	/**
+	 * @brief Convert many elements to polynomial basis
+	 * @param *src Elements in normal basis
+	 * @param *dst Output elements in polynomial basis, may be the same as src
+	 * @param n Number of elements
+	 */
+	void toPoly(const uint32_t *src, uint32_t *dst, size_t n);
+
+	/**
+	 * @brief Get basis type
+	 * @return NORMAL_TYPE1, NORMAL_TYPE2 or NORMAL_GENERAL
+	 */
+	uint8_t getType(void);
+
+	/**
+	 * @brief Get basis complexity
+	 * @return Number of ones in the multiplication matrix, 2w-1 for optimal normal basis
+	 */
+	uint32_t getComplexity(void);
+
+	/**
+	 * @brief Check if object is initialized
+	 * @return 0 if initialized
+	 */
+	uint8_t isInitialized(void);
+
+	/**
+	 * @brief Initializes normal basis
+	 * @param &field Field object, copied
+	 */
+	NormalBasis(GF2w &field);
+
+private:
+	GF2w field; //field object
+	uint8_t w; //field width, 0 if not initialized
+	uint32_t mask; //w-bit mask
+	uint8_t type; //basis type
+	std::vector<uint8_t> terms; //column indexes of ones in the multiplication matrix, row by row
+	std::vector<uint16_t> rowStart; //index of the first term of every row, w+1 entries
+	std::vector<uint32_t> toNormalTable; //polynomial to normal basis, 256 entries per byte
+	std::vector<uint32_t> toPolyTable; //normal to polynomial basis, 256 entries per byte
+	uint8_t cycle; //N of the cyclic representation, 0 if not used
+	std::vector<uint64_t> toCyclicTable; //normal basis to cyclic representation, 256 entries per byte
+	std::vector<uint32_t> fromCyclicTable; //cyclic representation to normal basis, 256 entries per byte
+
+	uint8_t setBasis(uint32_t b); //build tables for normal element b
+	void setCyclic(void); //build cyclic representation tables for optimal normal basis
+	static uint32_t convert(const uint32_t *table, uint8_t bytes, uint32_t x); //apply linear map using lookup tables
+};
+
+#endif
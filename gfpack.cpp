@@ -0,0 +1,357 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gfpack.cpp
+* @brief Compact serialization of GF(p) element vectors
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "gfpack.h"
+
+#if defined(__GNUC__)
+#define GFPACK_UNROLL _Pragma("GCC unroll 16") //fully unroll block loops, so that shifts become constants
+#else
+#define GFPACK_UNROLL
+#endif
+
+/**
+ * @brief Number of bits needed to store a value
+ * @param x Value
+ * @return Number of bits
+ */
+static inline uint8_t bitLength(uint64_t x)
+{
+    uint8_t ret = 0;
+    while(x)
+    {
+        ret++;
+        x >>= 1;
+    }
+    return ret;
+}
+
+/**
+ * @brief Write bits to a little endian bit stream
+ * @param *out Output buffer
+ * @param &pos Bit position, updated
+ * @param x Value
+ * @param bits Number of bits, up to 64
+ */
+static inline void writeBits(uint8_t *out, size_t &pos, uint64_t x, uint8_t bits)
+{
+    while(bits)
+    {
+        uint8_t offset = pos & 7;
+        uint8_t count = 8 - offset;
+        if(count > bits)
+            count = bits;
+        if(offset == 0)
+            out[pos >> 3] = 0;
+        out[pos >> 3] |= (uint8_t)((x & ((1U << count) - 1)) << offset);
+        x >>= count;
+        pos += count;
+        bits -= count;
+    }
+}
+
+/**
+ * @brief Read bits from a little endian bit stream
+ * @param *in Input buffer
+ * @param &pos Bit position, updated
+ * @param bits Number of bits, up to 64
+ * @return Value
+ */
+static inline uint64_t readBits(const uint8_t *in, size_t &pos, uint8_t bits)
+{
+    uint64_t ret = 0;
+    uint8_t done = 0;
+    while(done < bits)
+    {
+        uint8_t offset = pos & 7;
+        uint8_t count = 8 - offset;
+        if(count > (bits - done))
+            count = bits - done;
+        ret |= (uint64_t)((in[pos >> 3] >> offset) & ((1U << count) - 1)) << done;
+        pos += count;
+        done += count;
+    }
+    return ret;
+}
+
+/**
+ * @brief Pack blocks of 8 elements
+ * @param *in Input elements
+ * @param blocks Number of blocks
+ * @param *out Output buffer
+ * 8 elements give exactly B bytes. B is a template parameter, so that all shifts are constant
+ * and the compiler can generate branch-free, unrolled (and vectorized) code.
+ */
+template <uint8_t B> static void packBlocks(const uint16_t *in, size_t blocks, uint8_t *out)
+{
+    for(size_t i = 0; i < blocks; i++)
+    {
+        uint64_t lo = 0, hi = 0;
+        GFPACK_UNROLL
+        for(uint8_t k = 0; k < 8; k++)
+        {
+            const uint8_t shift = k * B;
+            uint64_t x = in[k];
+            if(shift < 64)
+            {
+                lo |= x << shift;
+                if((shift + B) > 64)
+                    hi |= x >> (64 - shift);
+            }
+            else
+                hi |= x << (shift - 64);
+        }
+        GFPACK_UNROLL
+        for(uint8_t k = 0; k < B; k++)
+            out[k] = (uint8_t)((k < 8) ? (lo >> (k << 3)) : (hi >> ((k - 8) << 3)));
+        in += 8;
+        out += B;
+    }
+}
+
+/**
+ * @brief Unpack blocks of 8 elements
+ * @param *in Packed data
+ * @param blocks Number of blocks
+ * @param *out Output elements
+ */
+template <uint8_t B> static void unpackBlocks(const uint8_t *in, size_t blocks, uint16_t *out)
+{
+    const uint16_t m = (uint16_t)((1U << B) - 1);
+    for(size_t i = 0; i < blocks; i++)
+    {
+        uint64_t lo = 0, hi = 0;
+        GFPACK_UNROLL
+        for(uint8_t k = 0; k < B; k++)
+        {
+            if(k < 8)
+                lo |= (uint64_t)in[k] << (k << 3);
+            else
+                hi |= (uint64_t)in[k] << ((k - 8) << 3);
+        }
+        GFPACK_UNROLL
+        for(uint8_t k = 0; k < 8; k++)
+        {
+            const uint8_t shift = k * B;
+            uint64_t x;
+            if(shift < 64)
+            {
+                x = lo >> shift;
+                if((shift + B) > 64)
+                    x |= hi << (64 - shift);
+            }
+            else
+                x = hi >> (shift - 64);
+            out[k] = (uint16_t)x & m;
+        }
+        in += B;
+        out += 8;
+    }
+}
+
+typedef void (*packFunction)(const uint16_t*, size_t, uint8_t*);
+typedef void (*unpackFunction)(const uint8_t*, size_t, uint16_t*);
+
+//block kernels for every possible number of bits per element
+static const packFunction packFunctions[17] =
+{
+    nullptr, packBlocks<1>, packBlocks<2>, packBlocks<3>, packBlocks<4>, packBlocks<5>, packBlocks<6>, packBlocks<7>, packBlocks<8>,
+    packBlocks<9>, packBlocks<10>, packBlocks<11>, packBlocks<12>, packBlocks<13>, packBlocks<14>, packBlocks<15>, packBlocks<16>,
+};
+static const unpackFunction unpackFunctions[17] =
+{
+    nullptr, unpackBlocks<1>, unpackBlocks<2>, unpackBlocks<3>, unpackBlocks<4>, unpackBlocks<5>, unpackBlocks<6>, unpackBlocks<7>, unpackBlocks<8>,
+    unpackBlocks<9>, unpackBlocks<10>, unpackBlocks<11>, unpackBlocks<12>, unpackBlocks<13>, unpackBlocks<14>, unpackBlocks<15>, unpackBlocks<16>,
+};
+
+/**
+ * @brief Get size of bit-packed vector
+ * @param n Number of elements
+ * @return Size in bytes
+ */
+size_t GFPack::packedSize(size_t n)
+{
+    return (n * bits + 7) >> 3;
+}
+
+/**
+ * @brief Pack vector using ceil(log2(p)) bits per element
+ * @param *in Input elements, must be lower than p
+ * @param n Number of elements
+ * @param *out Output buffer of packedSize(n) bytes
+ * @return Number of bytes written
+ */
+size_t GFPack::pack(const uint16_t *in, size_t n, uint8_t *out)
+{
+    if(p == 0)
+        return 0;
+
+    size_t blocks = n >> 3;
+    packFunctions[bits](in, blocks, out);
+    uint8_t *o = out + blocks * bits;
+    size_t pos = 0;
+    for(size_t i = blocks << 3; i < n; i++)
+        writeBits(o, pos, in[i], bits);
+    return (size_t)(o - out) + ((pos + 7) >> 3);
+}
+
+/**
+ * @brief Unpack vector packed with pack()
+ * @param *in Packed data
+ * @param n Number of elements
+ * @param *out Output elements
+ * @return Number of bytes read
+ */
+size_t GFPack::unpack(const uint8_t *in, size_t n, uint16_t *out)
+{
+    if(p == 0)
+        return 0;
+
+    size_t blocks = n >> 3;
+    unpackFunctions[bits](in, blocks, out);
+    const uint8_t *s = in + blocks * bits;
+    size_t pos = 0;
+    for(size_t i = blocks << 3; i < n; i++)
+        out[i] = (uint16_t)readBits(s, pos, bits);
+    return (size_t)(s - in) + ((pos + 7) >> 3);
+}
+
+/**
+ * @brief Get size of densely packed vector
+ * @param n Number of elements
+ * @return Size in bytes
+ */
+size_t GFPack::denseSize(size_t n)
+{
+    if(p == 0)
+        return 0;
+    size_t total = (n / groupLen) * groupBits[groupLen - 1];
+    if(n % groupLen)
+        total += groupBits[(n % groupLen) - 1];
+    return (total + 7) >> 3;
+}
+
+/**
+ * @brief Pack vector using base-p groups
+ * @param *in Input elements, must be lower than p
+ * @param n Number of elements
+ * @param *out Output buffer of denseSize(n) bytes
+ * @return Number of bytes written
+ */
+size_t GFPack::packDense(const uint16_t *in, size_t n, uint8_t *out)
+{
+    if(p == 0)
+        return 0;
+
+    size_t pos = 0;
+    for(size_t i = 0; i < n; i += groupLen)
+    {
+        uint8_t len = ((n - i) < groupLen) ? (uint8_t)(n - i) : groupLen;
+        //Horner's scheme, the first element is the least significant digit
+        uint64_t x = 0;
+        for(int8_t k = len - 1; k >= 0; k--)
+            x = x * p + in[i + k];
+        writeBits(out, pos, x, groupBits[len - 1]);
+    }
+    return (pos + 7) >> 3;
+}
+
+/**
+ * @brief Unpack vector packed with packDense()
+ * @param *in Packed data
+ * @param n Number of elements
+ * @param *out Output elements
+ * @return Number of bytes read
+ */
+size_t GFPack::unpackDense(const uint8_t *in, size_t n, uint16_t *out)
+{
+    if(p == 0)
+        return 0;
+
+    size_t pos = 0;
+    for(size_t i = 0; i < n; i += groupLen)
+    {
+        uint8_t len = ((n - i) < groupLen) ? (uint8_t)(n - i) : groupLen;
+        uint64_t x = readBits(in, pos, groupBits[len - 1]);
+        for(uint8_t k = 0; k < len; k++)
+        {
+            out[i + k] = (uint16_t)(x % p);
+            x /= p;
+        }
+    }
+    return (pos + 7) >> 3;
+}
+
+/**
+ * @brief Get number of bits per element in bit-packed format
+ * @return Bits per element
+ */
+uint8_t GFPack::getBits(void)
+{
+    return bits;
+}
+
+/**
+ * @brief Check if object is initialized
+ * @return 0 if initialized
+ */
+uint8_t GFPack::isInitialized(void)
+{
+    if(p)
+        return 0;
+
+    return 1;
+}
+
+/**
+ * @brief Initializes packer
+ * @param p Field characteristic
+ */
+GFPack::GFPack(uint16_t p)
+{
+    this->p = 0;
+    bits = 0;
+    groupLen = 0;
+
+    if(p < 2)
+        return;
+
+    this->p = p;
+    bits = bitLength(p - 1);
+
+    //find the group length (up to 8) giving the lowest number of bits per element, with p^k-1 fitting in 64 bits
+    uint64_t pk = 1; //p^k
+    uint8_t best = 1;
+    for(uint8_t k = 1; k <= 8; k++)
+    {
+        if(pk > (0xFFFFFFFFFFFFFFFFULL / p))
+            break;
+        pk *= p;
+        groupBits[k - 1] = bitLength(pk - 1);
+        //compare bits per element as fractions
+        if(((uint32_t)groupBits[k - 1] * best) < ((uint32_t)groupBits[best - 1] * k))
+            best = k;
+    }
+    groupLen = best;
+}
@@ -0,0 +1,120 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gfpack.h
+* @brief Compact serialization of GF(p) element vectors
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef GFPACK_H
+#define GFPACK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief This class provides packing of GF(p) elements, which are stored in 16-bit words, to a compact form
+ *
+ * There are two formats:
+ * - bit-packed: every element takes ceil(log2(p)) bits, elements are processed in blocks of 8,
+ * which always give a whole number of bytes,
+ * - dense: groups of k elements are treated as k-digit base-p numbers, every group takes ceil(log2(p^k)) bits.
+ * This is closer to the log2(p) bits per element limit, but slower, as it requires division.
+ * In both formats the first element goes to the least significant bits of the first byte.
+ */
+class GFPack
+{
+public:
+	/**
+	 * @brief Get size of bit-packed vector
+	 * @param n Number of elements
+	 * @return Size in bytes
+	 */
+	size_t packedSize(size_t n);
+
+	/**
+	 * @brief Pack vector using ceil(log2(p)) bits per element
+	 * @param *in Input elements, must be lower than p
+	 * @param n Number of elements
+	 * @param *out Output buffer of packedSize(n) bytes
+	 * @return Number of bytes written
+	 */
+	size_t pack(const uint16_t *in, size_t n, uint8_t *out);
+
+	/**
+	 * @brief Unpack vector packed with pack()
+	 * @param *in Packed data
+	 * @param n Number of elements
+	 * @param *out Output elements
+	 * @return Number of bytes read
+	 */
+	size_t unpack(const uint8_t *in, size_t n, uint16_t *out);
+
+	/**
+	 * @brief Get size of densely packed vector
+	 * @param n Number of elements
+	 * @return Size in bytes
+	 */
+	size_t denseSize(size_t n);
+
+	/**
+	 * @brief Pack vector using base-p groups
+	 * @param *in Input elements, must be lower than p
+	 * @param n Number of elements
+	 * @param *out Output buffer of denseSize(n) bytes
+	 * @return Number of bytes written
+	 */
+	size_t packDense(const uint16_t *in, size_t n, uint8_t *out);
+
+	/**
+	 * @brief Unpack vector packed with packDense()
+	 * @param *in Packed data
+	 * @param n Number of elements
+	 * @param *out Output elements
+	 * @return Number of bytes read
+	 */
+	size_t unpackDense(const uint8_t *in, size_t n, uint16_t *out);
+
+	/**
+	 * @brief Get number of bits per element in bit-packed format
+	 * @return Bits per element
+	 */
+	uint8_t getBits(void);
+
+	/**
+	 * @brief Check if object is initialized
+	 * @return 0 if initialized
+	 */
+	uint8_t isInitialized(void);
+
+	/**
+	 * @brief Initializes packer
+	 * @param p Field characteristic
+	 */
+	GFPack(uint16_t p);
+
+private:
+	uint16_t p; //field characteristic, 0 if not initialized
+	uint8_t bits; //bits per element
+	uint8_t groupLen; //number of elements in dense group
+	uint8_t groupBits[8]; //number of bits for a dense group of 1...groupLen elements (index is length - 1)
+};
+
+#endif
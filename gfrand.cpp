@@ -0,0 +1,227 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gfrand.cpp
+* @brief Bulk uniform random Galois field element generator
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "gfrand.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+static inline uint64_t rotl(uint64_t x, uint8_t k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * @brief SplitMix64 generator used for seeding
+ * @param *x Generator state
+ * @return Random word
+ */
+static inline uint64_t splitMix(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Advance xoshiro256 state by 2^128 or 2^192 steps
+ * @param *state 4-word generator state
+ * @param longJump Advance by 2^192 steps instead of 2^128
+ */
+void GFRandom::jump(uint64_t *state, bool longJump)
+{
+    static const uint64_t shortPoly[4] = {0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL};
+    static const uint64_t longPoly[4] = {0x76E15D3EFEFDCBBFULL, 0xC5004E441C522FB3ULL, 0x77710069854EE241ULL, 0x39109BB02ACBE635ULL};
+    const uint64_t *poly = longJump ? longPoly : shortPoly;
+    uint64_t t[4] = {0, 0, 0, 0};
+    for(uint8_t i = 0; i < 4; i++)
+    {
+        for(uint8_t b = 0; b < 64; b++)
+        {
+            if((poly[i] >> b) & 1)
+            {
+                for(uint8_t k = 0; k < 4; k++)
+                    t[k] ^= state[k];
+            }
+            //single xoshiro256 step
+            uint64_t x = state[1] << 17;
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= x;
+            state[3] = rotl(state[3], 45);
+        }
+    }
+    for(uint8_t k = 0; k < 4; k++)
+        state[k] = t[k];
+}
+
+/**
+ * @brief Generate next buffer of random words
+ *
+ * All lanes are stepped together and their outputs are interleaved: buffer[i] comes from lane i % GFRAND_LANES.
+ */
+void GFRandom::refill(void)
+{
+#if defined(__AVX2__) && (GFRAND_LANES == 4)
+    __m256i s0 = _mm256_loadu_si256((const __m256i*)s[0]);
+    __m256i s1 = _mm256_loadu_si256((const __m256i*)s[1]);
+    __m256i s2 = _mm256_loadu_si256((const __m256i*)s[2]);
+    __m256i s3 = _mm256_loadu_si256((const __m256i*)s[3]);
+    for(uint8_t i = 0; i < GFRAND_BUFFER; i += GFRAND_LANES)
+    {
+        //result = rotl(s1 * 5, 7) * 9, multiplications done with shifts and additions
+        __m256i r = _mm256_add_epi64(s1, _mm256_slli_epi64(s1, 2));
+        r = _mm256_or_si256(_mm256_slli_epi64(r, 7), _mm256_srli_epi64(r, 57));
+        r = _mm256_add_epi64(r, _mm256_slli_epi64(r, 3));
+        _mm256_storeu_si256((__m256i*)&buffer[i], r);
+
+        __m256i t = _mm256_slli_epi64(s1, 17);
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+    }
+    _mm256_storeu_si256((__m256i*)s[0], s0);
+    _mm256_storeu_si256((__m256i*)s[1], s1);
+    _mm256_storeu_si256((__m256i*)s[2], s2);
+    _mm256_storeu_si256((__m256i*)s[3], s3);
+#else
+    for(uint8_t i = 0; i < GFRAND_BUFFER; i += GFRAND_LANES)
+    {
+        for(uint8_t l = 0; l < GFRAND_LANES; l++)
+        {
+            buffer[i + l] = rotl(s[1][l] * 5, 7) * 9;
+            uint64_t t = s[1][l] << 17;
+            s[2][l] ^= s[0][l];
+            s[3][l] ^= s[1][l];
+            s[1][l] ^= s[2][l];
+            s[0][l] ^= s[3][l];
+            s[2][l] ^= t;
+            s[3][l] = rotl(s[3][l], 45);
+        }
+    }
+#endif
+    pos = 0;
+}
+
+/**
+ * @brief Get next random 64-bit word
+ * @return Random word
+ */
+uint64_t GFRandom::next(void)
+{
+    if(pos == GFRAND_BUFFER)
+        refill();
+    return buffer[pos++];
+}
+
+/**
+ * @brief Fill buffer with random GF(2^8) elements
+ * @param *out Output buffer
+ * @param n Number of elements
+ * @param nonZero Generate only non-zero elements
+ */
+void GFRandom::fillGF2(uint8_t *out, size_t n, bool nonZero)
+{
+    size_t k = 0;
+    while(k < n)
+    {
+        uint64_t x = next();
+        if(!nonZero && ((n - k) >= 8))
+        {
+            for(uint8_t i = 0; i < 8; i++)
+                out[k + i] = (uint8_t)(x >> (i << 3));
+            k += 8;
+            continue;
+        }
+        for(uint8_t i = 0; (i < 8) && (k < n); i++)
+        {
+            uint8_t b = (uint8_t)(x >> (i << 3));
+            out[k] = b;
+            //branchless rejection of zeros, the next element simply overwrites the rejected one
+            k += nonZero ? (b != 0) : 1;
+        }
+    }
+}
+
+/**
+ * @brief Fill buffer with random GF(p) elements
+ * @param *out Output buffer
+ * @param n Number of elements
+ * @param p Field characteristic
+ * @param nonZero Generate only non-zero elements
+ */
+void GFRandom::fillGFn(uint16_t *out, size_t n, uint16_t p, bool nonZero)
+{
+    if(p < 2)
+        return;
+    //number of possible values and the offset for non-zero elements
+    uint32_t range = nonZero ? (p - 1) : p;
+    uint16_t offset = nonZero ? 1 : 0;
+    //multiply 16-bit random number by the range, the upper half is the result
+    //lower halves below 2^16 mod range would make some results more probable, so they are rejected
+    uint32_t threshold = 65536 % range;
+
+    size_t k = 0;
+    while(k < n)
+    {
+        uint64_t x = next();
+        for(uint8_t i = 0; (i < 4) && (k < n); i++)
+        {
+            uint32_t m = (uint32_t)((x >> (i << 4)) & 0xFFFF) * range;
+            out[k] = (uint16_t)(m >> 16) + offset;
+            k += ((m & 0xFFFF) >= threshold);
+        }
+    }
+}
+
+/**
+ * @brief Initializes random generator
+ * @param seed Seed value
+ * @param stream Stream number, e.g. thread number, initialization takes O(stream) time
+ */
+GFRandom::GFRandom(uint64_t seed, uint64_t stream)
+{
+    uint64_t state[4];
+    for(uint8_t i = 0; i < 4; i++)
+        state[i] = splitMix(&seed);
+
+    //every stream starts 2^192 steps after the previous one, its lanes are 2^128 steps apart within this range
+    for(uint64_t i = 0; i < stream; i++)
+        jump(state, true);
+    for(uint8_t l = 0; l < GFRAND_LANES; l++)
+    {
+        for(uint8_t i = 0; i < 4; i++)
+            s[i][l] = state[i];
+        jump(state);
+    }
+    pos = GFRAND_BUFFER;
+}
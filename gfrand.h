@@ -0,0 +1,87 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gfrand.h
+* @brief Bulk uniform random Galois field element generator
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef GFRAND_H
+#define GFRAND_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define GFRAND_LANES 4 //number of interleaved xoshiro256** generators
+#define GFRAND_BUFFER 64 //number of 64-bit words generated at once
+
+/**
+ * @brief This class provides fast generation of uniformly distributed GF(2^8) and GF(p) elements
+ *
+ * Random numbers come from four interleaved xoshiro256** generators, which are stepped together
+ * (using AVX2 if available). The output does not depend on the instruction set, so a given seed and stream
+ * always produce the same sequence. Every stream is 2^192 steps apart from the previous one and the lanes
+ * of a stream are 2^128 steps apart, so each thread can use its own stream number without any overlap.
+ * Reaching a stream takes one long jump per stream number, so the constructor runs in O(stream) time.
+ */
+class GFRandom
+{
+public:
+	/**
+	 * @brief Get next random 64-bit word
+	 * @return Random word
+	 */
+	uint64_t next(void);
+
+	/**
+	 * @brief Fill buffer with random GF(2^8) elements
+	 * @param *out Output buffer
+	 * @param n Number of elements
+	 * @param nonZero Generate only non-zero elements
+	 */
+	void fillGF2(uint8_t *out, size_t n, bool nonZero = false);
+
+	/**
+	 * @brief Fill buffer with random GF(p) elements
+	 * @param *out Output buffer
+	 * @param n Number of elements
+	 * @param p Field characteristic
+	 * @param nonZero Generate only non-zero elements
+	 * Uses Lemire's multiply-and-shift method with rejection, so the distribution is exactly uniform.
+	 */
+	void fillGFn(uint16_t *out, size_t n, uint16_t p, bool nonZero = false);
+
+	/**
+	 * @brief Initializes random generator
+	 * @param seed Seed value
+	 * @param stream Stream number, e.g. thread number, initialization takes O(stream) time
+	 */
+	GFRandom(uint64_t seed, uint64_t stream = 0);
+
+private:
+	uint64_t s[4][GFRAND_LANES]; //generator states, s[i][lane]
+	uint64_t buffer[GFRAND_BUFFER]; //generated words
+	uint8_t pos; //position in buffer
+
+	void refill(void); //generate next buffer
+	static void jump(uint64_t *state, bool longJump = false); //advance state by 2^128 (or 2^192 with longJump) steps
+};
+
+#endif
@@ -0,0 +1,1075 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gfring.cpp
+* @brief Polynomial rings Z_q[x]/(x^n+1) with negacyclic number theoretic transform
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "gfring.h"
+#include <string.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Double width and unsigned types of coefficients
+ */
+template <class T> struct GFRingTypes;
+
+template <> struct GFRingTypes<int16_t>
+{
+    typedef int32_t W; //product type
+    typedef uint16_t U; //unsigned type
+    static const uint8_t bits = 16; //coefficient width
+};
+
+template <> struct GFRingTypes<int32_t>
+{
+    typedef int64_t W;
+    typedef uint32_t U;
+    static const uint8_t bits = 32;
+};
+
+/**
+ * @brief Montgomery reduction
+ * @param &t Ring constants
+ * @param a Number, |a| < q*2^(w-1)
+ * @return a/2^w mod q, in -q+1...q-1
+ */
+template <class T> static inline T montReduce(const GFRingTables<T> &t, typename GFRingTypes<T>::W a)
+{
+    typedef typename GFRingTypes<T>::U U;
+    T m = (T)(U)((U)a * (U)t.qinv);
+    return (T)((a - (typename GFRingTypes<T>::W)m * t.q) >> GFRingTypes<T>::bits);
+}
+
+/**
+ * @brief Montgomery multiplication
+ * @param &t Ring constants
+ * @param a Multiplicand
+ * @param b Multiplier
+ * @return a*b/2^w mod q, in -q+1...q-1
+ */
+template <class T> static inline T montMul(const GFRingTables<T> &t, T a, T b)
+{
+    return montReduce(t, (typename GFRingTypes<T>::W)a * b);
+}
+
+/**
+ * @brief Barrett reduction
+ * @param &t Ring constants
+ * @param a Number, |a| < 2^14 for 16-bit coefficients
+ * @return a mod q, in 0...2q-1
+ */
+template <class T> static inline T barrettReduce(const GFRingTables<T> &t, T a)
+{
+    T k = (T)(((typename GFRingTypes<T>::W)a * t.barrett) >> t.shift);
+    return (T)(a - k * t.q);
+}
+
+/**
+ * @brief Map number from -q+1...q-1 to 0...q-1
+ * @param &t Ring constants
+ * @param a Number
+ * @return a mod q
+ */
+template <class T> static inline T canonical(const GFRingTables<T> &t, T a)
+{
+    return (T)(a + ((a >> (GFRingTypes<T>::bits - 1)) & t.q));
+}
+
+/**
+ * @brief Multiply by q^(-1) modulo 2^w
+ * @param &t Ring constants
+ * @param x Number
+ * @return x*q^(-1) mod 2^w, the second operand of SIMD Montgomery multiplication by x
+ */
+template <class T> static inline T qinvMul(const GFRingTables<T> &t, T x)
+{
+    typedef typename GFRingTypes<T>::U U;
+    return (T)(U)((U)x * (U)t.qinv);
+}
+
+/**
+ * @brief Forward NTT, portable version
+ * @param &t Ring constants
+ * @param n Ring degree
+ * @param last Block half-length of the last level, 1 for complete NTT, 2 otherwise
+ * @param *a Polynomial, replaced with transform
+ */
+template <class T> static void nttScalar(const GFRingTables<T> &t, uint16_t n, uint16_t last, T *a)
+{
+    //coefficients grow by at most q per level, the products are always in -q+1...q-1
+    uint16_t k = 1;
+    for(uint16_t len = n / 2; len >= last; len >>= 1)
+    {
+        for(uint16_t start = 0; start < n; start += 2 * len)
+        {
+            T z = t.zetas[k++];
+            for(uint16_t j = start; j < (start + len); j++)
+            {
+                T u = montMul(t, z, a[j + len]);
+                a[j + len] = (T)(a[j] - u);
+                a[j] = (T)(a[j] + u);
+            }
+        }
+    }
+    for(uint16_t i = 0; i < n; i++)
+        a[i] = canonical(t, montMul(t, a[i], t.mont));
+}
+
+/**
+ * @brief Inverse NTT, portable version
+ * @param &t Ring constants
+ * @param n Ring degree
+ * @param last Block half-length of the last forward level
+ * @param *a Transform, replaced with polynomial
+ */
+template <class T> static void invNttScalar(const GFRingTables<T> &t, uint16_t n, uint16_t last, T *a)
+{
+    for(uint16_t len = last; len <= (n / 2); len <<= 1)
+    {
+        uint16_t k = n / (2 * len);
+        for(uint16_t start = 0; start < n; start += 2 * len)
+        {
+            T z = t.izetas[k++];
+            for(uint16_t j = start; j < (start + len); j++)
+            {
+                T u = a[j];
+                T s = (T)(u + a[j + len]);
+                //16-bit sums are reduced on every level, 32-bit sums fit without reduction (q*2^levels < 2^31)
+                if(sizeof(T) == 2)
+                    s = barrettReduce(t, s);
+                a[j] = s;
+                a[j + len] = montMul(t, z, (T)(u - a[j + len]));
+            }
+        }
+    }
+    for(uint16_t i = 0; i < n; i++)
+        a[i] = canonical(t, montMul(t, a[i], t.scale));
+}
+
+/**
+ * @brief Multiply in NTT domain, portable version
+ * @param &t Ring constants
+ * @param n Ring degree
+ * @param complete 1 for complete NTT
+ * @param *a Multiplicand
+ * @param *b Multiplier
+ * @param *r Product
+ */
+template <class T> static void basemulScalar(const GFRingTables<T> &t, uint16_t n, uint8_t complete, const T *a, const T *b, T *r)
+{
+    if(complete)
+    {
+        for(uint16_t i = 0; i < n; i++)
+            r[i] = canonical(t, montMul(t, montMul(t, a[i], b[i]), t.mont2));
+        return;
+    }
+    //pair p is a residue modulo x^2 - zeta, with zeta of pairs 2i and 2i+1 being opposite
+    for(uint16_t p = 0; p < (n / 2); p++)
+    {
+        T z = t.zetas[n / 4 + p / 2];
+        if(p & 1)
+            z = (T)-z;
+        T a0 = a[2 * p], a1 = a[2 * p + 1], b0 = b[2 * p], b1 = b[2 * p + 1];
+        T r0 = (T)(montMul(t, montMul(t, a1, b1), z) + montMul(t, a0, b0));
+        T r1 = (T)(montMul(t, a0, b1) + montMul(t, a1, b0));
+        r[2 * p] = canonical(t, montMul(t, r0, t.mont2));
+        r[2 * p + 1] = canonical(t, montMul(t, r1, t.mont2));
+    }
+}
+
+#ifdef __AVX2__
+
+/**
+ * @brief Montgomery multiplication of 16-bit lanes
+ * @param a Multiplicands
+ * @param b Multipliers
+ * @param bq Multipliers times q^(-1) mod 2^16
+ * @param q Modulus
+ * @return a*b/2^16 mod q, in -q+1...q-1
+ */
+static inline __m256i montMul16(__m256i a, __m256i b, __m256i bq, __m256i q)
+{
+    __m256i m = _mm256_mullo_epi16(a, bq);
+    __m256i h = _mm256_mulhi_epi16(a, b);
+    m = _mm256_mulhi_epi16(m, q);
+    return _mm256_sub_epi16(h, m);
+}
+
+/**
+ * @brief Montgomery multiplication of 32-bit lanes
+ * @param a Multiplicands
+ * @param b Multipliers
+ * @param bq Multipliers times q^(-1) mod 2^32
+ * @param q Modulus
+ * @return a*b/2^32 mod q, in -q+1...q-1
+ */
+static inline __m256i montMul32(__m256i a, __m256i b, __m256i bq, __m256i q)
+{
+    //even lanes first, then odd lanes moved to even positions, the results are in the high halves of 64-bit products
+    __m256i ao = _mm256_srli_epi64(a, 32);
+    __m256i pe = _mm256_mul_epi32(a, b);
+    __m256i po = _mm256_mul_epi32(ao, _mm256_srli_epi64(b, 32));
+    __m256i me = _mm256_mul_epi32(a, bq);
+    __m256i mo = _mm256_mul_epi32(ao, _mm256_srli_epi64(bq, 32));
+    pe = _mm256_sub_epi64(pe, _mm256_mul_epi32(me, q));
+    po = _mm256_sub_epi64(po, _mm256_mul_epi32(mo, q));
+    return _mm256_blend_epi32(_mm256_srli_epi64(pe, 32), po, 0xAA);
+}
+
+/**
+ * @brief Separate butterfly inputs of in-register levels, 16-bit lanes
+ * @param v0 Coefficients 0...15 of a group
+ * @param v1 Coefficients 16...31 of a group
+ * @param len Block half-length, 1...8
+ * @param &l Output low halves of blocks
+ * @param &h Output high halves of blocks, lane i pairs with lane i of l
+ */
+static inline void split16(__m256i v0, __m256i v1, uint16_t len, __m256i &l, __m256i &h)
+{
+    switch(len)
+    {
+        case 8:
+            l = _mm256_permute2x128_si256(v0, v1, 0x20);
+            h = _mm256_permute2x128_si256(v0, v1, 0x31);
+            break;
+        case 4:
+            l = _mm256_unpacklo_epi64(v0, v1);
+            h = _mm256_unpackhi_epi64(v0, v1);
+            break;
+        case 2:
+            l = _mm256_blend_epi32(v0, _mm256_slli_epi64(v1, 32), 0xAA);
+            h = _mm256_blend_epi32(_mm256_srli_epi64(v0, 32), v1, 0xAA);
+            break;
+        default:
+            l = _mm256_blend_epi16(v0, _mm256_slli_epi32(v1, 16), 0xAA);
+            h = _mm256_blend_epi16(_mm256_srli_epi32(v0, 16), v1, 0xAA);
+            break;
+    }
+}
+
+/**
+ * @brief Inverse of split16()
+ */
+static inline void merge16(__m256i l, __m256i h, uint16_t len, __m256i &v0, __m256i &v1)
+{
+    switch(len)
+    {
+        case 8:
+            v0 = _mm256_permute2x128_si256(l, h, 0x20);
+            v1 = _mm256_permute2x128_si256(l, h, 0x31);
+            break;
+        case 4:
+            v0 = _mm256_unpacklo_epi64(l, h);
+            v1 = _mm256_unpackhi_epi64(l, h);
+            break;
+        case 2:
+            v0 = _mm256_blend_epi32(l, _mm256_slli_epi64(h, 32), 0xAA);
+            v1 = _mm256_blend_epi32(_mm256_srli_epi64(l, 32), h, 0xAA);
+            break;
+        default:
+            v0 = _mm256_blend_epi16(l, _mm256_slli_epi32(h, 16), 0xAA);
+            v1 = _mm256_blend_epi16(_mm256_srli_epi32(l, 16), h, 0xAA);
+            break;
+    }
+}
+
+/**
+ * @brief Separate butterfly inputs of in-register levels, 32-bit lanes
+ * @param v0 Coefficients 0...7 of a group
+ * @param v1 Coefficients 8...15 of a group
+ * @param len Block half-length, 1...4
+ * @param &l Output low halves of blocks
+ * @param &h Output high halves of blocks, lane i pairs with lane i of l
+ */
+static inline void split32(__m256i v0, __m256i v1, uint16_t len, __m256i &l, __m256i &h)
+{
+    switch(len)
+    {
+        case 4:
+            l = _mm256_permute2x128_si256(v0, v1, 0x20);
+            h = _mm256_permute2x128_si256(v0, v1, 0x31);
+            break;
+        case 2:
+            l = _mm256_unpacklo_epi64(v0, v1);
+            h = _mm256_unpackhi_epi64(v0, v1);
+            break;
+        default:
+            l = _mm256_blend_epi32(v0, _mm256_slli_epi64(v1, 32), 0xAA);
+            h = _mm256_blend_epi32(_mm256_srli_epi64(v0, 32), v1, 0xAA);
+            break;
+    }
+}
+
+/**
+ * @brief Inverse of split32()
+ */
+static inline void merge32(__m256i l, __m256i h, uint16_t len, __m256i &v0, __m256i &v1)
+{
+    switch(len)
+    {
+        case 4:
+            v0 = _mm256_permute2x128_si256(l, h, 0x20);
+            v1 = _mm256_permute2x128_si256(l, h, 0x31);
+            break;
+        case 2:
+            v0 = _mm256_unpacklo_epi64(l, h);
+            v1 = _mm256_unpackhi_epi64(l, h);
+            break;
+        default:
+            v0 = _mm256_blend_epi32(l, _mm256_slli_epi64(h, 32), 0xAA);
+            v1 = _mm256_blend_epi32(_mm256_srli_epi64(l, 32), h, 0xAA);
+            break;
+    }
+}
+
+/**
+ * @brief SIMD operations for one coefficient width
+ */
+template <class T> struct GFRingSimd;
+
+template <> struct GFRingSimd<int16_t>
+{
+    static const uint16_t lanes = 16; //lanes per vector
+    static inline __m256i set1(int16_t x) {return _mm256_set1_epi16(x);}
+    static inline __m256i add(__m256i a, __m256i b) {return _mm256_add_epi16(a, b);}
+    static inline __m256i sub(__m256i a, __m256i b) {return _mm256_sub_epi16(a, b);}
+    static inline __m256i mullo(__m256i a, __m256i b) {return _mm256_mullo_epi16(a, b);}
+    static inline __m256i mont(__m256i a, __m256i b, __m256i bq, __m256i q) {return montMul16(a, b, bq, q);}
+    static inline __m256i canonical(__m256i a, __m256i q) {return _mm256_add_epi16(a, _mm256_and_si256(_mm256_srai_epi16(a, 15), q));}
+    static inline void split(__m256i v0, __m256i v1, uint16_t len, __m256i &l, __m256i &h) {split16(v0, v1, len, l, h);}
+    static inline void merge(__m256i l, __m256i h, uint16_t len, __m256i &v0, __m256i &v1) {merge16(l, h, len, v0, v1);}
+    static inline __m256i barrett(const GFRingTables<int16_t> &t, __m256i a, __m256i q)
+    {
+        __m256i k = _mm256_mulhi_epi16(a, _mm256_set1_epi16(t.barrett));
+        k = _mm256_sra_epi16(k, _mm_cvtsi32_si128(t.shift - 16));
+        return _mm256_sub_epi16(a, _mm256_mullo_epi16(k, q));
+    }
+};
+
+template <> struct GFRingSimd<int32_t>
+{
+    static const uint16_t lanes = 8;
+    static inline __m256i set1(int32_t x) {return _mm256_set1_epi32(x);}
+    static inline __m256i add(__m256i a, __m256i b) {return _mm256_add_epi32(a, b);}
+    static inline __m256i sub(__m256i a, __m256i b) {return _mm256_sub_epi32(a, b);}
+    static inline __m256i mullo(__m256i a, __m256i b) {return _mm256_mullo_epi32(a, b);}
+    static inline __m256i mont(__m256i a, __m256i b, __m256i bq, __m256i q) {return montMul32(a, b, bq, q);}
+    static inline __m256i canonical(__m256i a, __m256i q) {return _mm256_add_epi32(a, _mm256_and_si256(_mm256_srai_epi32(a, 31), q));}
+    static inline void split(__m256i v0, __m256i v1, uint16_t len, __m256i &l, __m256i &h) {split32(v0, v1, len, l, h);}
+    static inline void merge(__m256i l, __m256i h, uint16_t len, __m256i &v0, __m256i &v1) {merge32(l, h, len, v0, v1);}
+    static inline __m256i barrett(const GFRingTables<int32_t> &t, __m256i a, __m256i q)
+    {
+        (void)t;
+        (void)q;
+        return a; //32-bit sums are never reduced
+    }
+};
+
+/**
+ * @brief Get number of in-register (SIMD) NTT levels
+ * @param lanes Lanes per vector
+ * @param last Block half-length of the last level
+ * @return Number of levels with block half-length below lanes
+ */
+static uint16_t registerLevels(uint16_t lanes, uint16_t last)
+{
+    uint16_t levels = 0;
+    for(uint16_t l = last; l < lanes; l <<= 1)
+        levels++;
+    return levels;
+}
+
+/**
+ * @brief Get coefficient offset of a lane of split low halves
+ * @param lanes Lanes per vector
+ * @param len Block half-length
+ * @param i Lane number
+ * @return Offset of coefficient within the group of two vectors
+ * This mirrors split16() and split32().
+ */
+static uint16_t laneOffset(uint16_t lanes, uint16_t len, uint16_t i)
+{
+    uint16_t half = lanes / 2; //lanes per 128-bit half
+    if(len == half)
+        return (i / half) * lanes + (i % half);
+    uint16_t h = i / half;
+    uint16_t u = (i % half) / len;
+    uint16_t src = u & 1;
+    return src * lanes + h * half + (u - src) * len + (i % len);
+}
+
+/**
+ * @brief Forward NTT, AVX2 version
+ * @param &t Ring constants
+ * @param n Ring degree
+ * @param last Block half-length of the last level
+ * @param *a Polynomial, replaced with transform
+ */
+template <class T> static void nttSimd(const GFRingTables<T> &t, uint16_t n, uint16_t last, T *a)
+{
+    typedef GFRingSimd<T> S;
+    const uint16_t w = S::lanes;
+    __m256i q = S::set1(t.q);
+    uint16_t k = 1;
+    uint16_t len;
+    //levels with blocks of whole vectors, the same twiddle factor in all lanes
+    for(len = n / 2; len >= w; len >>= 1)
+    {
+        for(uint16_t start = 0; start < n; start += 2 * len)
+        {
+            __m256i z = S::set1(t.zetas[k]);
+            __m256i zq = S::set1(t.zetasQinv[k]);
+            k++;
+            for(uint16_t j = start; j < (start + len); j += w)
+            {
+                __m256i x = _mm256_loadu_si256((const __m256i*)&a[j]);
+                __m256i u = S::mont(_mm256_loadu_si256((const __m256i*)&a[j + len]), z, zq, q);
+                _mm256_storeu_si256((__m256i*)&a[j + len], S::sub(x, u));
+                _mm256_storeu_si256((__m256i*)&a[j], S::add(x, u));
+            }
+        }
+    }
+    //remaining levels within groups of two vectors, kept in registers, followed by the final reduction
+    __m256i m = S::set1(t.mont);
+    __m256i mq = S::set1(qinvMul(t, t.mont));
+    const T *lane = t.lanes.data();
+    for(uint16_t g = 0; g < n; g += 2 * w)
+    {
+        __m256i v0 = _mm256_loadu_si256((const __m256i*)&a[g]);
+        __m256i v1 = _mm256_loadu_si256((const __m256i*)&a[g + w]);
+        for(uint16_t l = len; l >= last; l >>= 1)
+        {
+            __m256i x, y;
+            S::split(v0, v1, l, x, y);
+            __m256i u = S::mont(y, _mm256_loadu_si256((const __m256i*)lane), _mm256_loadu_si256((const __m256i*)(lane + w)), q);
+            lane += 2 * w;
+            S::merge(S::add(x, u), S::sub(x, u), l, v0, v1);
+        }
+        _mm256_storeu_si256((__m256i*)&a[g], S::canonical(S::mont(v0, m, mq, q), q));
+        _mm256_storeu_si256((__m256i*)&a[g + w], S::canonical(S::mont(v1, m, mq, q), q));
+    }
+}
+
+/**
+ * @brief Inverse NTT, AVX2 version
+ * @param &t Ring constants
+ * @param n Ring degree
+ * @param last Block half-length of the last forward level
+ * @param *a Transform, replaced with polynomial
+ */
+template <class T> static void invNttSimd(const GFRingTables<T> &t, uint16_t n, uint16_t last, T *a)
+{
+    typedef GFRingSimd<T> S;
+    const uint16_t w = S::lanes;
+    __m256i q = S::set1(t.q);
+    //in-register levels, their twiddle factors follow the ones of the forward transform
+    const T *lane = t.lanes.data() + (n / (2 * w)) * registerLevels(w, last) * 2 * w;
+    for(uint16_t g = 0; g < n; g += 2 * w)
+    {
+        __m256i v0 = _mm256_loadu_si256((const __m256i*)&a[g]);
+        __m256i v1 = _mm256_loadu_si256((const __m256i*)&a[g + w]);
+        for(uint16_t l = last; l < w; l <<= 1)
+        {
+            __m256i x, y;
+            S::split(v0, v1, l, x, y);
+            __m256i s = S::barrett(t, S::add(x, y), q);
+            __m256i d = S::mont(S::sub(x, y), _mm256_loadu_si256((const __m256i*)lane), _mm256_loadu_si256((const __m256i*)(lane + w)), q);
+            lane += 2 * w;
+            S::merge(s, d, l, v0, v1);
+        }
+        _mm256_storeu_si256((__m256i*)&a[g], v0);
+        _mm256_storeu_si256((__m256i*)&a[g + w], v1);
+    }
+    for(uint16_t len = w; len <= (n / 2); len <<= 1)
+    {
+        uint16_t k = n / (2 * len);
+        for(uint16_t start = 0; start < n; start += 2 * len)
+        {
+            __m256i z = S::set1(t.izetas[k]);
+            __m256i zq = S::set1(t.izetasQinv[k]);
+            k++;
+            for(uint16_t j = start; j < (start + len); j += w)
+            {
+                __m256i x = _mm256_loadu_si256((const __m256i*)&a[j]);
+                __m256i y = _mm256_loadu_si256((const __m256i*)&a[j + len]);
+                _mm256_storeu_si256((__m256i*)&a[j], S::barrett(t, S::add(x, y), q));
+                _mm256_storeu_si256((__m256i*)&a[j + len], S::mont(S::sub(x, y), z, zq, q));
+            }
+        }
+    }
+    __m256i f = S::set1(t.scale);
+    __m256i fq = S::set1(qinvMul(t, t.scale));
+    for(uint16_t i = 0; i < n; i += w)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)&a[i]);
+        _mm256_storeu_si256((__m256i*)&a[i], S::canonical(S::mont(x, f, fq, q), q));
+    }
+}
+
+/**
+ * @brief Multiply in NTT domain, AVX2 version
+ * @param &t Ring constants
+ * @param n Ring degree
+ * @param complete 1 for complete NTT
+ * @param *a Multiplicand
+ * @param *b Multiplier
+ * @param *r Product
+ */
+template <class T> static void basemulSimd(const GFRingTables<T> &t, uint16_t n, uint8_t complete, const T *a, const T *b, T *r)
+{
+    typedef GFRingSimd<T> S;
+    const uint16_t w = S::lanes;
+    __m256i q = S::set1(t.q);
+    __m256i qinv = S::set1(t.qinv);
+    __m256i m2 = S::set1(t.mont2);
+    __m256i m2q = S::set1(qinvMul(t, t.mont2));
+    if(complete)
+    {
+        for(uint16_t i = 0; i < n; i += w)
+        {
+            __m256i x = _mm256_loadu_si256((const __m256i*)&a[i]);
+            __m256i y = _mm256_loadu_si256((const __m256i*)&b[i]);
+            x = S::mont(x, y, S::mullo(y, qinv), q);
+            _mm256_storeu_si256((__m256i*)&r[i], S::canonical(S::mont(x, m2, m2q, q), q));
+        }
+        return;
+    }
+    //pairs are separated into even and odd coefficients like in the last in-register level
+    const T *lane = t.lanes.data() + 2 * (n / (2 * w)) * registerLevels(w, 2) * 2 * w;
+    for(uint16_t g = 0; g < n; g += 2 * w)
+    {
+        __m256i a0, a1, b0, b1;
+        S::split(_mm256_loadu_si256((const __m256i*)&a[g]), _mm256_loadu_si256((const __m256i*)&a[g + w]), 1, a0, a1);
+        S::split(_mm256_loadu_si256((const __m256i*)&b[g]), _mm256_loadu_si256((const __m256i*)&b[g + w]), 1, b0, b1);
+        __m256i b0q = S::mullo(b0, qinv);
+        __m256i b1q = S::mullo(b1, qinv);
+        __m256i x = S::mont(a1, b1, b1q, q);
+        x = S::mont(x, _mm256_loadu_si256((const __m256i*)lane), _mm256_loadu_si256((const __m256i*)(lane + w)), q);
+        lane += 2 * w;
+        __m256i r0 = S::add(x, S::mont(a0, b0, b0q, q));
+        __m256i r1 = S::add(S::mont(a0, b1, b1q, q), S::mont(a1, b0, b0q, q));
+        r0 = S::canonical(S::mont(r0, m2, m2q, q), q);
+        r1 = S::canonical(S::mont(r1, m2, m2q, q), q);
+        __m256i v0, v1;
+        S::merge(r0, r1, 1, v0, v1);
+        _mm256_storeu_si256((__m256i*)&r[g], v0);
+        _mm256_storeu_si256((__m256i*)&r[g + w], v1);
+    }
+}
+
+#endif
+
+/**
+ * @brief Forward NTT
+ * @param &t Ring constants
+ * @param n Ring degree
+ * @param last Block half-length of the last level
+ * @param *a Polynomial, replaced with transform
+ */
+template <class T> static void nttT(const GFRingTables<T> &t, uint16_t n, uint16_t last, T *a)
+{
+#ifdef __AVX2__
+    nttSimd(t, n, last, a);
+#else
+    nttScalar(t, n, last, a);
+#endif
+}
+
+/**
+ * @brief Inverse NTT
+ * @param &t Ring constants
+ * @param n Ring degree
+ * @param last Block half-length of the last forward level
+ * @param *a Transform, replaced with polynomial
+ */
+template <class T> static void invNttT(const GFRingTables<T> &t, uint16_t n, uint16_t last, T *a)
+{
+#ifdef __AVX2__
+    invNttSimd(t, n, last, a);
+#else
+    invNttScalar(t, n, last, a);
+#endif
+}
+
+/**
+ * @brief Multiply in NTT domain
+ * @param &t Ring constants
+ * @param n Ring degree
+ * @param complete 1 for complete NTT (or pointwise product)
+ * @param *a Multiplicand
+ * @param *b Multiplier
+ * @param *r Product
+ */
+template <class T> static void basemulT(const GFRingTables<T> &t, uint16_t n, uint8_t complete, const T *a, const T *b, T *r)
+{
+#ifdef __AVX2__
+    basemulSimd(t, n, complete, a, b, r);
+#else
+    basemulScalar(t, n, complete, a, b, r);
+#endif
+}
+
+/**
+ * @brief Multiply polynomials using NTT
+ * @param &t Ring constants
+ * @param n Ring degree
+ * @param complete 1 for complete NTT
+ * @param *a Multiplicand
+ * @param *b Multiplier
+ * @param *r Product
+ */
+template <class T> static void mulT(const GFRingTables<T> &t, uint16_t n, uint8_t complete, const T *a, const T *b, T *r)
+{
+    uint16_t last = complete ? 1 : 2;
+    std::vector<T> x(a, a + n), y(b, b + n);
+    nttT(t, n, last, x.data());
+    nttT(t, n, last, y.data());
+    basemulT(t, n, complete, x.data(), y.data(), r);
+    invNttT(t, n, last, r);
+}
+
+/**
+ * @brief Multiply polynomials using the schoolbook method
+ * @param q Modulus
+ * @param n Ring degree
+ * @param *a Multiplicand
+ * @param *b Multiplier
+ * @param *r Product
+ */
+template <class T> static void slowMulT(uint32_t q, uint16_t n, const T *a, const T *b, T *r)
+{
+    std::vector<int64_t> c(n, 0);
+    for(uint16_t i = 0; i < n; i++)
+    {
+        for(uint16_t j = 0; j < n; j++)
+        {
+            int64_t p = ((int64_t)a[i] * b[j]) % q;
+            //x^n = -1
+            if((i + j) < n)
+                c[i + j] += p;
+            else
+                c[i + j - n] -= p;
+        }
+    }
+    for(uint16_t i = 0; i < n; i++)
+        r[i] = (T)(((c[i] % q) + q) % q);
+}
+
+/**
+ * @brief Add polynomials
+ * @param &t Ring constants
+ * @param n Ring degree
+ * @param *a Term 1
+ * @param *b Term 2
+ * @param *r Sum
+ */
+template <class T> static void addT(const GFRingTables<T> &t, uint16_t n, const T *a, const T *b, T *r)
+{
+    for(uint16_t i = 0; i < n; i++)
+        r[i] = canonical(t, (T)(a[i] + b[i] - t.q));
+}
+
+/**
+ * @brief Subtract polynomials
+ * @param &t Ring constants
+ * @param n Ring degree
+ * @param *a Minuend
+ * @param *b Subtrahend
+ * @param *r Difference
+ */
+template <class T> static void subT(const GFRingTables<T> &t, uint16_t n, const T *a, const T *b, T *r)
+{
+    for(uint16_t i = 0; i < n; i++)
+        r[i] = canonical(t, (T)(a[i] - b[i]));
+}
+
+/**
+ * @brief Reduce coefficients to 0...q-1
+ * @param &t Ring constants
+ * @param n Ring degree
+ * @param *a Polynomial
+ */
+template <class T> static void reduceT(const GFRingTables<T> &t, uint16_t n, T *a)
+{
+    //Montgomery multiplication by 2^w is exact for any coefficient and leaves it in -q+1...q-1
+#ifdef __AVX2__
+    typedef GFRingSimd<T> S;
+    __m256i q = S::set1(t.q);
+    __m256i m = S::set1(t.mont);
+    __m256i mq = S::set1(qinvMul(t, t.mont));
+    for(uint16_t i = 0; i < n; i += S::lanes)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)&a[i]);
+        _mm256_storeu_si256((__m256i*)&a[i], S::canonical(S::mont(x, m, mq, q), q));
+    }
+#else
+    for(uint16_t i = 0; i < n; i++)
+        a[i] = canonical(t, montMul(t, a[i], t.mont));
+#endif
+}
+
+/**
+ * @brief Modular exponentiation
+ * @param x Base
+ * @param e Exponent
+ * @param q Modulus
+ * @return x^e mod q
+ */
+static uint32_t powMod(uint64_t x, uint64_t e, uint32_t q)
+{
+    uint64_t r = 1;
+    x %= q;
+    while(e)
+    {
+        if(e & 1)
+            r = (r * x) % q;
+        x = (x * x) % q;
+        e >>= 1;
+    }
+    return (uint32_t)r;
+}
+
+/**
+ * @brief Calculate ring constants for one coefficient width
+ * @param &t Output constants
+ * @param q Modulus
+ * @param n Ring degree
+ * @param levels Number of NTT levels
+ * @param complete 1 for complete NTT
+ * @param psi Primitive 2^(levels+1)-th root of unity
+ */
+template <class T> static void fillTables(GFRingTables<T> &t, uint32_t q, uint16_t n, uint8_t levels, uint8_t complete, uint32_t psi)
+{
+    const uint8_t bits = GFRingTypes<T>::bits;
+    auto center = [q](uint64_t x) {x %= q; return (T)((x > (q / 2)) ? ((int64_t)x - q) : (int64_t)x);};
+
+    t.q = (T)q;
+    uint64_t inv = q; //Newton's iteration, every step doubles the number of correct bits
+    for(uint8_t i = 0; i < 5; i++)
+        inv *= 2 - q * inv;
+    t.qinv = (T)(typename GFRingTypes<T>::U)inv;
+    uint64_t r = ((uint64_t)1 << bits) % q;
+    t.mont = center(r);
+    t.mont2 = center(r * r);
+    t.scale = center(r * powMod(((uint32_t)1 << levels) % q, q - 2, q));
+    t.shift = 0;
+    t.barrett = 0;
+    if(bits == 16)
+    {
+        //2^shift/q < 2^15 and the error is below 1 for |a| < 2^14
+        t.shift = 15;
+        for(uint32_t x = q; x > 1; x >>= 1)
+            t.shift++;
+        t.barrett = (T)(((uint32_t)1 << t.shift) / q);
+    }
+
+    uint32_t size = (uint32_t)1 << levels;
+    t.zetas.resize(size);
+    t.izetas.resize(size);
+    t.zetasQinv.resize(size);
+    t.izetasQinv.resize(size);
+    for(uint32_t k = 0; k < size; k++)
+    {
+        uint32_t e = 0; //bit-reversed k
+        for(uint8_t b = 0; b < levels; b++)
+            e |= ((k >> b) & 1) << (levels - 1 - b);
+        t.zetas[k] = center((uint64_t)powMod(psi, e, q) * r);
+        t.izetas[k] = center((uint64_t)powMod(psi, 2 * size - e, q) * r);
+        t.zetasQinv[k] = qinvMul(t, t.zetas[k]);
+        t.izetasQinv[k] = qinvMul(t, t.izetas[k]);
+    }
+
+    t.lanes.clear();
+#ifdef __AVX2__
+    //twiddle factors of in-register levels for every group of two vectors, each followed by its q^(-1) products
+    //forward levels, then inverse levels, then basemul() pairs for incomplete NTT
+    const uint16_t w = GFRingSimd<T>::lanes;
+    uint16_t last = complete ? 1 : 2;
+    std::vector<T> z(w);
+    for(uint8_t inverse = 0; inverse < 2; inverse++)
+    {
+        for(uint16_t g = 0; g < n; g += 2 * w)
+        {
+            for(uint16_t i = 0, l = inverse ? last : (w / 2); i < registerLevels(w, last); i++, l = inverse ? (l << 1) : (l >> 1))
+            {
+                for(uint16_t j = 0; j < w; j++)
+                {
+                    uint16_t o = g + laneOffset(w, l, j);
+                    uint16_t k = n / (2 * l) + o / (2 * l);
+                    z[j] = inverse ? t.izetas[k] : t.zetas[k];
+                }
+                for(uint16_t j = 0; j < w; j++)
+                    t.lanes.push_back(z[j]);
+                for(uint16_t j = 0; j < w; j++)
+                    t.lanes.push_back(qinvMul(t, z[j]));
+            }
+        }
+    }
+    if(!complete)
+    {
+        for(uint16_t g = 0; g < n; g += 2 * w)
+        {
+            for(uint16_t j = 0; j < w; j++)
+            {
+                uint16_t p = (g + laneOffset(w, 1, j)) / 2;
+                z[j] = t.zetas[n / 4 + p / 2];
+                if(p & 1)
+                    z[j] = (T)-z[j];
+            }
+            for(uint16_t j = 0; j < w; j++)
+                t.lanes.push_back(z[j]);
+            for(uint16_t j = 0; j < w; j++)
+                t.lanes.push_back(qinvMul(t, z[j]));
+        }
+    }
+#else
+    (void)n;
+    (void)complete;
+#endif
+}
+
+uint8_t GFRing::ntt(int16_t *a)
+{
+    if(narrow.q == 0)
+        return 1;
+    nttT(narrow, n, complete ? 1 : 2, a);
+    return 0;
+}
+
+uint8_t GFRing::ntt(int32_t *a)
+{
+    if(wide.q == 0)
+        return 1;
+    nttT(wide, n, complete ? 1 : 2, a);
+    return 0;
+}
+
+uint8_t GFRing::invNtt(int16_t *a)
+{
+    if(narrow.q == 0)
+        return 1;
+    invNttT(narrow, n, complete ? 1 : 2, a);
+    return 0;
+}
+
+uint8_t GFRing::invNtt(int32_t *a)
+{
+    if(wide.q == 0)
+        return 1;
+    invNttT(wide, n, complete ? 1 : 2, a);
+    return 0;
+}
+
+uint8_t GFRing::basemul(const int16_t *a, const int16_t *b, int16_t *r)
+{
+    if(narrow.q == 0)
+        return 1;
+    basemulT(narrow, n, complete, a, b, r);
+    return 0;
+}
+
+uint8_t GFRing::basemul(const int32_t *a, const int32_t *b, int32_t *r)
+{
+    if(wide.q == 0)
+        return 1;
+    basemulT(wide, n, complete, a, b, r);
+    return 0;
+}
+
+uint8_t GFRing::pointwise(const int16_t *a, const int16_t *b, int16_t *r)
+{
+    if(narrow.q == 0)
+        return 1;
+    basemulT(narrow, n, 1, a, b, r);
+    return 0;
+}
+
+uint8_t GFRing::pointwise(const int32_t *a, const int32_t *b, int32_t *r)
+{
+    if(wide.q == 0)
+        return 1;
+    basemulT(wide, n, 1, a, b, r);
+    return 0;
+}
+
+uint8_t GFRing::mul(const int16_t *a, const int16_t *b, int16_t *r)
+{
+    if(narrow.q == 0)
+        return 1;
+    mulT(narrow, n, complete, a, b, r);
+    return 0;
+}
+
+uint8_t GFRing::mul(const int32_t *a, const int32_t *b, int32_t *r)
+{
+    if(wide.q == 0)
+        return 1;
+    mulT(wide, n, complete, a, b, r);
+    return 0;
+}
+
+uint8_t GFRing::slowMul(const int16_t *a, const int16_t *b, int16_t *r)
+{
+    if(narrow.q == 0)
+        return 1;
+    slowMulT(q, n, a, b, r);
+    return 0;
+}
+
+uint8_t GFRing::slowMul(const int32_t *a, const int32_t *b, int32_t *r)
+{
+    if(wide.q == 0)
+        return 1;
+    slowMulT(q, n, a, b, r);
+    return 0;
+}
+
+uint8_t GFRing::add(const int16_t *a, const int16_t *b, int16_t *r)
+{
+    if(narrow.q == 0)
+        return 1;
+    addT(narrow, n, a, b, r);
+    return 0;
+}
+
+uint8_t GFRing::add(const int32_t *a, const int32_t *b, int32_t *r)
+{
+    if(wide.q == 0)
+        return 1;
+    addT(wide, n, a, b, r);
+    return 0;
+}
+
+uint8_t GFRing::sub(const int16_t *a, const int16_t *b, int16_t *r)
+{
+    if(narrow.q == 0)
+        return 1;
+    subT(narrow, n, a, b, r);
+    return 0;
+}
+
+uint8_t GFRing::sub(const int32_t *a, const int32_t *b, int32_t *r)
+{
+    if(wide.q == 0)
+        return 1;
+    subT(wide, n, a, b, r);
+    return 0;
+}
+
+uint8_t GFRing::reduce(int16_t *a)
+{
+    if(narrow.q == 0)
+        return 1;
+    reduceT(narrow, n, a);
+    return 0;
+}
+
+uint8_t GFRing::reduce(int32_t *a)
+{
+    if(wide.q == 0)
+        return 1;
+    reduceT(wide, n, a);
+    return 0;
+}
+
+uint32_t GFRing::getModulus(void)
+{
+    return q;
+}
+
+uint16_t GFRing::getDegree(void)
+{
+    return n;
+}
+
+uint8_t GFRing::isComplete(void)
+{
+    return complete;
+}
+
+uint8_t GFRing::isNarrow(void)
+{
+    return narrow.q != 0;
+}
+
+uint8_t GFRing::isInitialized(void)
+{
+    return (q == 0);
+}
+
+GFRing::GFRing(uint32_t q, uint16_t n)
+{
+    this->q = 0;
+    this->n = n;
+    levels = 0;
+    complete = 0;
+    narrow.q = 0;
+    wide.q = 0;
+
+    if((n < 32) || (n > GFRING_MAX_DEGREE) || (n & (n - 1)))
+        return;
+    if((q < 3) || (q >= 0x80000000) || ((q & 1) == 0))
+        return;
+    for(uint32_t d = 3; ((uint64_t)d * d) <= q; d += 2)
+    {
+        if((q % d) == 0)
+            return; //not a prime
+    }
+
+    uint8_t lg = 0;
+    while((1 << lg) < n)
+        lg++;
+    if(((q - 1) % (2 * (uint32_t)n)) == 0)
+    {
+        complete = 1;
+        levels = lg;
+    }
+    else if(((q - 1) % n) == 0)
+        levels = lg - 1;
+    else
+        return; //x^n+1 does not split
+    //first slots of inverse butterflies grow up to q*2^levels
+    if(((uint64_t)q << levels) >= 0x80000000)
+        return;
+
+    //smallest primitive 2^(levels+1)-th root of unity, that is psi^(2^levels) = -1
+    uint32_t psi = 0;
+    for(uint32_t c = 2; c < q; c++)
+    {
+        if(powMod(c, (uint64_t)1 << levels, q) == (q - 1))
+        {
+            psi = c;
+            break;
+        }
+    }
+    if(psi == 0)
+        return;
+
+    fillTables(wide, q, n, levels, complete, psi);
+    //16-bit coefficients grow up to (levels+1)*q in forward transform and 4*q before Barrett reduction
+    if((q < 4096) && (((uint32_t)levels + 1) * q < 32768))
+        fillTables(narrow, q, n, levels, complete, psi);
+    this->q = q;
+}
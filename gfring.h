@@ -0,0 +1,206 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gfring.h
+* @brief Polynomial rings Z_q[x]/(x^n+1) with negacyclic number theoretic transform
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef GFRING_H
+#define GFRING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#define GFRING_DEFAULT_DEGREE 256 //default ring degree n
+#define GFRING_MAX_DEGREE 4096 //maximum ring degree n
+
+/**
+ * @brief Ring constants for one coefficient width
+ */
+template <class T> struct GFRingTables
+{
+	T q; //modulus, 0 if this width is not supported
+	T qinv; //q^(-1) mod 2^w
+	T mont; //2^w mod q (Montgomery factor), centered
+	T mont2; //2^2w mod q, centered
+	T scale; //2^w/2^levels mod q, centered, for inverse transform
+	T barrett; //floor(2^shift/q)
+	uint8_t shift; //Barrett shift
+	std::vector<T> zetas; //twiddle factors in Montgomery form, bit-reversed order, centered
+	std::vector<T> izetas; //inverse twiddle factors in Montgomery form
+	std::vector<T> zetasQinv; //zetas * qinv mod 2^w, for SIMD Montgomery multiplication
+	std::vector<T> izetasQinv; //izetas * qinv mod 2^w
+	std::vector<T> lanes; //twiddle factors of in-register layers permuted to SIMD lane order, with their qinv products
+};
+
+/**
+ * @brief This class provides arithmetic in the polynomial ring Z_q[x]/(x^n+1) with the negacyclic NTT
+ *
+ * Polynomials are arrays of n signed coefficients, the lowest degree first, all of them in 0...q-1 when returned.
+ * Input coefficients may be anywhere in -q+1...q-1 unless stated otherwise.
+ * The forward transform evaluates a polynomial at the roots of x^n+1 using Cooley-Tukey butterflies with twiddle factors
+ * in bit-reversed order, so the output is in bit-reversed order too and multiplication in that domain is done by basemul().
+ * If q = 1 mod 2n, x^n+1 splits into linear factors (complete NTT, e.g. q = 8380417 of Dilithium) and basemul() is
+ * a pointwise product. If q = 1 mod n only, the transform stops one level earlier at quadratic factors x^2 - zeta
+ * (e.g. q = 3329 of Kyber) and basemul() multiplies pairs of coefficients modulo them.
+ * Products are reduced with Montgomery multiplication and sums in the inverse transform with Barrett reduction,
+ * with lazy reduction wherever the coefficient bounds allow. Every operation exists for 32-bit coefficients and, if q
+ * is small enough (e.g. 3329), for 16-bit coefficients, which doubles the number of AVX2 lanes.
+ * GFn is limited to 16-bit moduli and its lookup tables do not vectorize, so the ring does its own modular arithmetic.
+ */
+class GFRing
+{
+public:
+	/**
+	 * @brief Forward negacyclic NTT in place
+	 * @param *a Polynomial, replaced with its transform in bit-reversed order
+	 * @return 0 on success, 1 if this coefficient width is not supported
+	 */
+	uint8_t ntt(int16_t *a);
+	uint8_t ntt(int32_t *a);
+
+	/**
+	 * @brief Inverse negacyclic NTT in place
+	 * @param *a Transform in bit-reversed order, replaced with the polynomial
+	 * @return 0 on success, 1 if this coefficient width is not supported
+	 */
+	uint8_t invNtt(int16_t *a);
+	uint8_t invNtt(int32_t *a);
+
+	/**
+	 * @brief Multiply in the NTT domain
+	 * @param *a Transform of multiplicand
+	 * @param *b Transform of multiplier
+	 * @param *r Transform of product, may be the same as a or b
+	 * @return 0 on success, 1 if this coefficient width is not supported
+	 * Pointwise product for complete NTT, products of pairs modulo x^2 - zeta otherwise.
+	 */
+	uint8_t basemul(const int16_t *a, const int16_t *b, int16_t *r);
+	uint8_t basemul(const int32_t *a, const int32_t *b, int32_t *r);
+
+	/**
+	 * @brief Multiply coefficients pointwise
+	 * @param *a Multiplicands
+	 * @param *b Multipliers
+	 * @param *r Products r_i = a_i*b_i mod q, may be the same as a or b
+	 * @return 0 on success, 1 if this coefficient width is not supported
+	 * This is the NTT domain product only for complete NTT (see basemul()).
+	 */
+	uint8_t pointwise(const int16_t *a, const int16_t *b, int16_t *r);
+	uint8_t pointwise(const int32_t *a, const int32_t *b, int32_t *r);
+
+	/**
+	 * @brief Multiply polynomials in the ring
+	 * @param *a Multiplicand
+	 * @param *b Multiplier
+	 * @param *r Product, may be the same as a or b
+	 * @return 0 on success, 1 if this coefficient width is not supported
+	 * Both operands are transformed, multiplied with basemul() and transformed back.
+	 */
+	uint8_t mul(const int16_t *a, const int16_t *b, int16_t *r);
+	uint8_t mul(const int32_t *a, const int32_t *b, int32_t *r);
+
+	/**
+	 * @brief Slow (schoolbook, no NTT) multiplication in the ring
+	 * @param *a Multiplicand
+	 * @param *b Multiplier
+	 * @param *r Product, must not be the same as a or b
+	 * @return 0 on success, 1 if this coefficient width is not supported
+	 */
+	uint8_t slowMul(const int16_t *a, const int16_t *b, int16_t *r);
+	uint8_t slowMul(const int32_t *a, const int32_t *b, int32_t *r);
+
+	/**
+	 * @brief Add polynomials (or transforms)
+	 * @param *a Term 1, coefficients in 0...q-1
+	 * @param *b Term 2, coefficients in 0...q-1
+	 * @param *r Sum, may be the same as a or b
+	 * @return 0 on success, 1 if this coefficient width is not supported
+	 */
+	uint8_t add(const int16_t *a, const int16_t *b, int16_t *r);
+	uint8_t add(const int32_t *a, const int32_t *b, int32_t *r);
+
+	/**
+	 * @brief Subtract polynomials (or transforms)
+	 * @param *a Minuend, coefficients in 0...q-1
+	 * @param *b Subtrahend, coefficients in 0...q-1
+	 * @param *r Difference, may be the same as a or b
+	 * @return 0 on success, 1 if this coefficient width is not supported
+	 */
+	uint8_t sub(const int16_t *a, const int16_t *b, int16_t *r);
+	uint8_t sub(const int32_t *a, const int32_t *b, int32_t *r);
+
+	/**
+	 * @brief Reduce coefficients to 0...q-1
+	 * @param *a Polynomial with any coefficients, reduced in place
+	 * @return 0 on success, 1 if this coefficient width is not supported
+	 */
+	uint8_t reduce(int16_t *a);
+	uint8_t reduce(int32_t *a);
+
+	/**
+	 * @brief Get modulus
+	 * @return q
+	 */
+	uint32_t getModulus(void);
+
+	/**
+	 * @brief Get ring degree
+	 * @return n
+	 */
+	uint16_t getDegree(void);
+
+	/**
+	 * @brief Check if NTT is complete
+	 * @return 1 if x^n+1 is split into linear factors, 0 if into quadratic ones
+	 */
+	uint8_t isComplete(void);
+
+	/**
+	 * @brief Check if 16-bit coefficients are supported
+	 * @return 1 if supported
+	 */
+	uint8_t isNarrow(void);
+
+	/**
+	 * @brief Check if object is initialized
+	 * @return 0 if initialized
+	 */
+	uint8_t isInitialized(void);
+
+	/**
+	 * @brief Initializes polynomial ring
+	 * @param q Prime modulus, q = 1 mod n, object is not initialized otherwise or if coefficients would overflow 32 bits
+	 * @param n Ring degree, power of 2, 32...GFRING_MAX_DEGREE
+	 */
+	GFRing(uint32_t q, uint16_t n = GFRING_DEFAULT_DEGREE);
+
+private:
+	uint32_t q; //modulus, 0 if not initialized
+	uint16_t n; //ring degree
+	uint8_t levels; //number of NTT levels
+	uint8_t complete; //1 if NTT is complete
+	GFRingTables<int16_t> narrow; //16-bit constants
+	GFRingTables<int32_t> wide; //32-bit constants
+};
+
+#endif
@@ -0,0 +1,413 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gfroots.cpp
+* @brief Polynomial factorization and root finding over GF(p) and GF(2^w)
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "gfroots.h"
+
+uint32_t PolyRoots::add(uint32_t x, uint32_t y)
+{
+    if(p)
+        return (uint32_t)(((uint64_t)x + y) % p);
+    return x ^ y;
+}
+
+uint32_t PolyRoots::sub(uint32_t x, uint32_t y)
+{
+    if(p)
+        return (uint32_t)(((uint64_t)x + p - y) % p);
+    return x ^ y;
+}
+
+uint32_t PolyRoots::mul(uint32_t x, uint32_t y)
+{
+    if(p)
+        return (uint32_t)(((uint64_t)x * y) % p);
+    return field.mul(x, y);
+}
+
+uint32_t PolyRoots::inv(uint32_t x)
+{
+    if(p == 0)
+        return field.inv(x);
+    //Fermat's little theorem, x^(p-2) = x^(-1)
+    uint32_t ret = 1;
+    uint32_t e = p - 2;
+    while(e)
+    {
+        if(e & 1)
+            ret = mul(ret, x);
+        x = mul(x, x);
+        e >>= 1;
+    }
+    return ret;
+}
+
+void PolyRoots::trim(Poly &a)
+{
+    while(!a.empty() && (a.back() == 0))
+        a.pop_back();
+}
+
+void PolyRoots::monic(Poly &a)
+{
+    trim(a);
+    if(a.empty() || (a.back() == 1))
+        return;
+    uint32_t c = inv(a.back());
+    for(size_t i = 0; i < a.size(); i++)
+        a[i] = mul(a[i], c);
+}
+
+void PolyRoots::mod(Poly &a, const Poly &f)
+{
+    trim(a);
+    size_t d = f.size() - 1;
+    if(a.size() <= d)
+        return;
+    for(size_t i = a.size() - 1; i >= d; i--)
+    {
+        uint32_t c = a[i];
+        if(c)
+        {
+            //subtract c*x^(i-d)*f, leading term cancels
+            for(size_t j = 0; j < d; j++)
+                a[i - d + j] = sub(a[i - d + j], mul(c, f[j]));
+        }
+        a[i] = 0;
+        if(i == d)
+            break;
+    }
+    a.resize(d);
+    trim(a);
+}
+
+PolyRoots::Poly PolyRoots::div(const Poly &a, const Poly &f)
+{
+    Poly r = a, q;
+    trim(r);
+    size_t d = f.size() - 1;
+    if(r.size() <= d)
+        return q;
+    q.assign(r.size() - d, 0);
+    for(size_t i = r.size() - 1; i >= d; i--)
+    {
+        uint32_t c = r[i];
+        q[i - d] = c;
+        if(c)
+        {
+            for(size_t j = 0; j < d; j++)
+                r[i - d + j] = sub(r[i - d + j], mul(c, f[j]));
+        }
+        if(i == d)
+            break;
+    }
+    trim(q);
+    return q;
+}
+
+PolyRoots::Poly PolyRoots::mulMod(const Poly &a, const Poly &b, const Poly &f)
+{
+    if(a.empty() || b.empty())
+        return Poly();
+    Poly r(a.size() + b.size() - 1, 0);
+    if(p)
+    {
+        //products are reduced, but sums are accumulated in 64 bits and reduced once
+        std::vector<uint64_t> acc(r.size(), 0);
+        for(size_t i = 0; i < a.size(); i++)
+        {
+            if(a[i] == 0)
+                continue;
+            for(size_t j = 0; j < b.size(); j++)
+                acc[i + j] += ((uint64_t)a[i] * b[j]) % p;
+        }
+        for(size_t i = 0; i < r.size(); i++)
+            r[i] = (uint32_t)(acc[i] % p);
+    }
+    else
+    {
+        for(size_t i = 0; i < a.size(); i++)
+        {
+            if(a[i] == 0)
+                continue;
+            for(size_t j = 0; j < b.size(); j++)
+                r[i + j] ^= field.mul(a[i], b[j]);
+        }
+    }
+    mod(r, f);
+    return r;
+}
+
+PolyRoots::Poly PolyRoots::sqrMod(const Poly &a, const Poly &f)
+{
+    if(p)
+        return mulMod(a, a, f);
+    //in characteristic 2 cross terms cancel, so (sum a_i*x^i)^2 = sum a_i^2*x^(2i)
+    if(a.empty())
+        return Poly();
+    Poly r(2 * a.size() - 1, 0);
+    for(size_t i = 0; i < a.size(); i++)
+        r[2 * i] = field.mul(a[i], a[i]);
+    mod(r, f);
+    return r;
+}
+
+PolyRoots::Poly PolyRoots::frobenius(const Poly &a, const Poly &f)
+{
+    if(p == 0)
+    {
+        //q = 2^w, so w squarings
+        Poly r = a;
+        for(uint8_t i = 0; i < w; i++)
+            r = sqrMod(r, f);
+        return r;
+    }
+    Poly r(1, 1), x = a;
+    uint32_t e = p;
+    while(e)
+    {
+        if(e & 1)
+            r = mulMod(r, x, f);
+        e >>= 1;
+        if(e)
+            x = sqrMod(x, f);
+    }
+    return r;
+}
+
+PolyRoots::Poly PolyRoots::gcd(Poly a, Poly b)
+{
+    trim(a);
+    trim(b);
+    while(!b.empty())
+    {
+        monic(b);
+        mod(a, b);
+        a.swap(b);
+    }
+    monic(a);
+    return a;
+}
+
+PolyRoots::Poly PolyRoots::splitter(const Poly &g, uint32_t attempt)
+{
+    if(p)
+    {
+        //Cantor-Zassenhaus: (x+a)^((p-1)/2) is 1 for roots r with r+a being a square and -1 otherwise
+        Poly x(2, 1), r(1, 1);
+        x[0] = (uint32_t)(random.next() % p);
+        uint32_t e = (p - 1) / 2;
+        while(e)
+        {
+            if(e & 1)
+                r = mulMod(r, x, g);
+            e >>= 1;
+            if(e)
+                x = sqrMod(x, g);
+        }
+        if(r.empty())
+            r.push_back(0);
+        r[0] = sub(r[0], 1);
+        trim(r);
+        return r;
+    }
+
+    //Berlekamp trace algorithm: Tr(b*r) is 0 or 1 for every root r, and differs between roots for some basis element b
+    uint32_t b;
+    if(attempt < w)
+        b = (uint32_t)1 << attempt;
+    else
+    {
+        do
+            b = (uint32_t)random.next() & (uint32_t)(((uint64_t)1 << w) - 1);
+        while(b == 0);
+    }
+    Poly t(2, 0);
+    t[1] = b;
+    mod(t, g);
+    Poly acc = t;
+    for(uint8_t i = 1; i < w; i++)
+    {
+        t = sqrMod(t, g);
+        if(acc.size() < t.size())
+            acc.resize(t.size(), 0);
+        for(size_t j = 0; j < t.size(); j++)
+            acc[j] ^= t[j];
+    }
+    trim(acc);
+    return acc;
+}
+
+void PolyRoots::split(const Poly &g, std::vector<uint32_t> &roots)
+{
+    if(g.size() < 2)
+        return;
+    if(g.size() == 2)
+    {
+        roots.push_back(sub(0, g[0])); //x + g_0, g is monic
+        return;
+    }
+    for(uint32_t attempt = 0; ; attempt++)
+    {
+        Poly h = gcd(g, splitter(g, attempt));
+        if((h.size() > 1) && (h.size() < g.size()))
+        {
+            split(h, roots);
+            split(div(g, h), roots);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Find distinct roots of a polynomial
+ * @param &f Polynomial, the lowest degree first
+ * @param &roots Output roots in no particular order
+ * @return Number of distinct roots
+ */
+size_t PolyRoots::roots(const std::vector<uint32_t> &f, std::vector<uint32_t> &roots)
+{
+    roots.clear();
+    Poly g = f;
+    monic(g);
+    if(ready || (g.size() < 2))
+        return 0;
+
+    uint64_t q = p ? p : ((uint64_t)1 << w);
+    if(q <= ROOTS_BRUTE_FORCE)
+    {
+        //small field, just evaluate the polynomial everywhere
+        for(uint32_t x = 0; x < q; x++)
+        {
+            uint32_t acc = 0;
+            for(size_t i = g.size(); i > 0; i--)
+                acc = add(mul(acc, x), g[i - 1]);
+            if(acc == 0)
+                roots.push_back(x);
+        }
+        return roots.size();
+    }
+
+    //product of distinct linear factors, gcd(f, x^q - x)
+    Poly x(2, 0);
+    x[1] = 1;
+    Poly h = frobenius(x, g);
+    if(h.size() < 2)
+        h.resize(2, 0);
+    h[1] = sub(h[1], 1);
+    trim(h);
+    split(gcd(g, h), roots);
+    return roots.size();
+}
+
+/**
+ * @brief Distinct-degree factorization
+ * @param &f Polynomial, the lowest degree first
+ * @param &factors Output, factors[i] is the monic product of all distinct irreducible factors of degree i+1
+ * @return 0 on success, 1 if f is zero or a constant
+ */
+uint8_t PolyRoots::distinctDegree(const std::vector<uint32_t> &f, std::vector<std::vector<uint32_t>> &factors)
+{
+    factors.clear();
+    Poly g = f;
+    monic(g);
+    if(ready || (g.size() < 2))
+        return 1;
+
+    factors.assign(g.size() - 1, Poly(1, 1));
+    Poly x(2, 0);
+    x[1] = 1;
+    Poly h = x;
+    //h = x^(q^i) mod g, and gcd(g, h - x) is the product of irreducible factors with degree dividing i
+    for(size_t i = 1; (2 * i) <= (g.size() - 1); i++)
+    {
+        h = frobenius(h, g);
+        Poly t = h;
+        if(t.size() < 2)
+            t.resize(2, 0);
+        t[1] = sub(t[1], 1);
+        trim(t);
+        Poly d = gcd(g, t);
+        if(d.size() < 2)
+            continue;
+        factors[i - 1] = d;
+        //remove all powers of found factors, so that they are not found again at multiples of i
+        while(d.size() > 1)
+        {
+            g = div(g, d);
+            d = gcd(g, d);
+        }
+        mod(h, g);
+    }
+    if(g.size() > 1)
+        factors[g.size() - 2] = g; //what remains is irreducible
+    return 0;
+}
+
+/**
+ * @brief Check if object is initialized
+ * @return 0 if initialized
+ */
+uint8_t PolyRoots::isInitialized(void)
+{
+    return ready;
+}
+
+/**
+ * @brief Initializes root finder for GF(p)
+ * @param p Field characteristic, must be prime
+ * @param seed Seed for random splitting polynomials
+ */
+PolyRoots::PolyRoots(uint32_t p, uint64_t seed) : field(0), random(seed)
+{
+    this->p = 0;
+    w = 0;
+    ready = 1;
+
+    if(p < 2)
+        return;
+    for(uint32_t i = 2; (uint64_t)i * i <= p; i++)
+    {
+        if((p % i) == 0)
+            return; //not a prime number
+    }
+    this->p = p;
+    ready = 0;
+}
+
+/**
+ * @brief Initializes root finder for GF(2^w)
+ * @param field Field object
+ */
+PolyRoots::PolyRoots(GF2w &field) : field(field), random(1)
+{
+    p = 0;
+    w = 0;
+    ready = 1;
+
+    if(this->field.isInitialized())
+        return;
+    w = this->field.getWidth();
+    ready = 0;
+}
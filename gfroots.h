@@ -0,0 +1,112 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gfroots.h
+* @brief Polynomial factorization and root finding over GF(p) and GF(2^w)
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef GFROOTS_H
+#define GFROOTS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "gf2w.h"
+#include "gfrand.h"
+
+#define ROOTS_BRUTE_FORCE 64 //fields up to this size are searched exhaustively
+
+/**
+ * @brief This class provides root finding for polynomials over large fields, where exhaustive (Chien) search is impractical
+ *
+ * Polynomials are vectors of coefficients, the lowest degree first.
+ * Roots are found in two steps: gcd(f, x^q - x) extracts the product of all distinct linear factors
+ * (the first step of distinct-degree factorization), which is then split recursively:
+ * - for odd p using Cantor-Zassenhaus: gcd(g, (x+a)^((p-1)/2) - 1) for random a,
+ * - for GF(2^w) using Berlekamp trace algorithm: gcd(g, Tr(b*x)) for b going through the polynomial basis.
+ * Cost is polynomial in degree and log(q), independent of the field size.
+ */
+class PolyRoots
+{
+public:
+	/**
+	 * @brief Find distinct roots of a polynomial
+	 * @param &f Polynomial, the lowest degree first
+	 * @param &roots Output roots in no particular order
+	 * @return Number of distinct roots
+	 */
+	size_t roots(const std::vector<uint32_t> &f, std::vector<uint32_t> &roots);
+
+	/**
+	 * @brief Distinct-degree factorization
+	 * @param &f Polynomial, the lowest degree first
+	 * @param &factors Output, factors[i] is the monic product of all distinct irreducible factors of degree i+1
+	 * @return 0 on success, 1 if f is zero or a constant
+	 * Repeated factors are counted once.
+	 */
+	uint8_t distinctDegree(const std::vector<uint32_t> &f, std::vector<std::vector<uint32_t>> &factors);
+
+	/**
+	 * @brief Check if object is initialized
+	 * @return 0 if initialized
+	 */
+	uint8_t isInitialized(void);
+
+	/**
+	 * @brief Initializes root finder for GF(p)
+	 * @param p Field characteristic, must be prime
+	 * @param seed Seed for random splitting polynomials
+	 */
+	PolyRoots(uint32_t p, uint64_t seed = 1);
+
+	/**
+	 * @brief Initializes root finder for GF(2^w)
+	 * @param field Field object
+	 */
+	PolyRoots(GF2w &field);
+
+private:
+	typedef std::vector<uint32_t> Poly;
+
+	GF2w field; //binary field, not initialized in GF(p) mode
+	uint32_t p; //prime field characteristic, 0 in GF(2^w) mode
+	uint8_t w; //binary field width, 0 in GF(p) mode
+	uint8_t ready; //0 if initialized
+	GFRandom random; //source of splitting polynomials
+
+	uint32_t add(uint32_t x, uint32_t y);
+	uint32_t sub(uint32_t x, uint32_t y);
+	uint32_t mul(uint32_t x, uint32_t y);
+	uint32_t inv(uint32_t x);
+
+	void trim(Poly &a); //remove leading zeros
+	void monic(Poly &a); //divide by leading coefficient
+	void mod(Poly &a, const Poly &f); //a = a mod f, f monic
+	Poly div(const Poly &a, const Poly &f); //quotient, f monic
+	Poly mulMod(const Poly &a, const Poly &b, const Poly &f); //a*b mod f
+	Poly sqrMod(const Poly &a, const Poly &f); //a^2 mod f
+	Poly frobenius(const Poly &a, const Poly &f); //a^q mod f, q is the field size
+	Poly gcd(Poly a, Poly b); //monic greatest common divisor
+	Poly splitter(const Poly &g, uint32_t attempt); //polynomial sharing a random part of the roots with g
+	void split(const Poly &g, std::vector<uint32_t> &roots); //find roots of product of distinct linear factors
+};
+
+#endif
@@ -0,0 +1,298 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gfstruct.cpp
+* @brief Structured (Vandermonde and Cauchy) matrix inversion and solving over GF(2^8) and GF(p)
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "gfstruct.h"
+#include <vector>
+
+/**
+ * @brief Solve Vandermonde system V*a = b
+ * @param &gf Field
+ * @param *x n points
+ * @param n Matrix size
+ * @param *b Right-hand side, replaced with solution
+ * @return 0 on success, 1 if points are not distinct
+ */
+template <class F, class T> static uint8_t vandermondeSolveT(F &gf, const T *x, uint16_t n, T *b)
+{
+    //divided differences, every pair of points is used once as a denominator
+    for(uint16_t k = 0; k + 1 < n; k++)
+    {
+        for(uint16_t i = n - 1; i > k; i--)
+        {
+            T d = gf.sub(x[i], x[i - k - 1]);
+            if(d == 0)
+                return 1;
+            b[i] = gf.div(gf.sub(b[i], b[i - 1]), d);
+        }
+    }
+    //Newton form to monomial form
+    for(uint16_t k = n - 1; k-- > 0;)
+    {
+        for(uint16_t i = k; i + 1 < n; i++)
+            b[i] = gf.sub(b[i], gf.mul(x[k], b[i + 1]));
+    }
+    return 0;
+}
+
+/**
+ * @brief Solve transposed Vandermonde system V^T*z = b
+ * @param &gf Field
+ * @param *x n points
+ * @param n Matrix size
+ * @param *b Right-hand side, replaced with solution
+ * @return 0 on success, 1 if points are not distinct
+ */
+template <class F, class T> static uint8_t vandermondeSolveTransposedT(F &gf, const T *x, uint16_t n, T *b)
+{
+    //the same steps as in vandermondeSolveT(), transposed and in reverse order
+    for(uint16_t k = 0; k + 1 < n; k++)
+    {
+        for(uint16_t i = n - 1; i > k; i--)
+            b[i] = gf.sub(b[i], gf.mul(x[k], b[i - 1]));
+    }
+    for(uint16_t k = n - 1; k-- > 0;)
+    {
+        for(uint16_t i = k + 1; i < n; i++)
+        {
+            T d = gf.sub(x[i], x[i - k - 1]);
+            if(d == 0)
+                return 1;
+            b[i] = gf.div(b[i], d);
+        }
+        for(uint16_t i = k; i + 1 < n; i++)
+            b[i] = gf.sub(b[i], b[i + 1]);
+    }
+    return 0;
+}
+
+/**
+ * @brief Calculate barycentric weights of interpolation points
+ * @param &gf Field
+ * @param *x n points
+ * @param n Number of points
+ * @param *w Output weights
+ * @return 0 on success, 1 if points are not distinct
+ */
+template <class F, class T> static uint8_t barycentricWeightsT(F &gf, const T *x, uint16_t n, T *w)
+{
+    for(uint16_t i = 0; i < n; i++)
+    {
+        T d = 1;
+        for(uint16_t k = 0; k < n; k++)
+        {
+            if(k != i)
+                d = gf.mul(d, gf.sub(x[i], x[k]));
+        }
+        if(d == 0)
+            return 1;
+        w[i] = gf.inv(d);
+    }
+    return 0;
+}
+
+/**
+ * @brief Invert Vandermonde matrix
+ * @param &gf Field
+ * @param *x n points
+ * @param n Matrix size
+ * @param *inv Output inverse
+ * @return 0 on success, 1 if points are not distinct
+ */
+template <class F, class T> static uint8_t vandermondeInverseT(F &gf, const T *x, uint16_t n, T *inv)
+{
+    //p(z) = product of (z - x_i), coefficients from the lowest
+    std::vector<T> p(n + 1, 0), q(n);
+    p[0] = 1;
+    for(uint16_t i = 0; i < n; i++)
+    {
+        for(uint16_t j = i + 1; j > 0; j--)
+            p[j] = gf.sub(p[j - 1], gf.mul(x[i], p[j]));
+        p[0] = gf.sub(0, gf.mul(x[i], p[0]));
+    }
+    for(uint16_t i = 0; i < n; i++)
+    {
+        //q(z) = p(z)/(z - x_i) by synthetic division, then L_i(z) = q(z)/q(x_i)
+        q[n - 1] = p[n];
+        for(uint16_t j = n - 1; j > 0; j--)
+            q[j - 1] = gf.add(p[j], gf.mul(x[i], q[j]));
+        T d = 0;
+        for(uint16_t j = n; j-- > 0;)
+            d = gf.add(gf.mul(d, x[i]), q[j]);
+        if(d == 0)
+            return 1;
+        T c = gf.inv(d);
+        for(uint16_t j = 0; j < n; j++)
+            inv[j * n + i] = gf.mul(q[j], c);
+    }
+    return 0;
+}
+
+/**
+ * @brief Calculate factors of Cauchy matrix inverse
+ * @param &gf Field
+ * @param *x n row points
+ * @param *y n column points
+ * @param n Matrix size
+ * @param &u Output u_i = a(y_i)/b_i
+ * @param &v Output v_j = b(x_j)/a_j
+ * @return 0 on success, 1 if points do not define a Cauchy matrix
+ * The inverse is inv_ij = u_i*v_j/(y_i - x_j).
+ */
+template <class F, class T> static uint8_t cauchyFactors(F &gf, const T *x, const T *y, uint16_t n, std::vector<T> &u, std::vector<T> &v)
+{
+    u.assign(n, 1);
+    v.assign(n, 1);
+    std::vector<T> a(n, 1), b(n, 1);
+    for(uint16_t i = 0; i < n; i++)
+    {
+        for(uint16_t k = 0; k < n; k++)
+        {
+            u[i] = gf.mul(u[i], gf.sub(y[i], x[k])); //a(y_i)
+            v[i] = gf.mul(v[i], gf.sub(x[i], y[k])); //b(x_i)
+            if(k != i)
+            {
+                a[i] = gf.mul(a[i], gf.sub(x[i], x[k]));
+                b[i] = gf.mul(b[i], gf.sub(y[i], y[k]));
+            }
+        }
+        if((u[i] == 0) || (v[i] == 0) || (a[i] == 0) || (b[i] == 0))
+            return 1;
+    }
+    for(uint16_t i = 0; i < n; i++)
+    {
+        u[i] = gf.div(u[i], b[i]);
+        v[i] = gf.div(v[i], a[i]);
+    }
+    return 0;
+}
+
+/**
+ * @brief Invert Cauchy matrix
+ * @param &gf Field
+ * @param *x n row points
+ * @param *y n column points
+ * @param n Matrix size
+ * @param *inv Output inverse
+ * @return 0 on success, 1 if points do not define a Cauchy matrix
+ */
+template <class F, class T> static uint8_t cauchyInverseT(F &gf, const T *x, const T *y, uint16_t n, T *inv)
+{
+    std::vector<T> u, v;
+    if(cauchyFactors(gf, x, y, n, u, v))
+        return 1;
+    for(uint16_t i = 0; i < n; i++)
+    {
+        for(uint16_t j = 0; j < n; j++)
+            inv[i * n + j] = gf.div(gf.mul(u[i], v[j]), gf.sub(y[i], x[j]));
+    }
+    return 0;
+}
+
+/**
+ * @brief Solve Cauchy system C*z = b
+ * @param &gf Field
+ * @param *x n row points
+ * @param *y n column points
+ * @param n Matrix size
+ * @param *b Right-hand side, replaced with solution
+ * @return 0 on success, 1 if points do not define a Cauchy matrix
+ */
+template <class F, class T> static uint8_t cauchySolveT(F &gf, const T *x, const T *y, uint16_t n, T *b)
+{
+    std::vector<T> u, v;
+    if(cauchyFactors(gf, x, y, n, u, v))
+        return 1;
+    std::vector<T> w(n);
+    for(uint16_t j = 0; j < n; j++)
+        w[j] = gf.mul(v[j], b[j]);
+    for(uint16_t i = 0; i < n; i++)
+    {
+        T acc = 0;
+        for(uint16_t j = 0; j < n; j++)
+            acc = gf.add(acc, gf.div(w[j], gf.sub(y[i], x[j])));
+        b[i] = gf.mul(u[i], acc);
+    }
+    return 0;
+}
+
+uint8_t StructuredMatrix::vandermondeSolve(GF2 &gf, const uint8_t *x, uint16_t n, uint8_t *b)
+{
+    return vandermondeSolveT(gf, x, n, b);
+}
+
+uint8_t StructuredMatrix::vandermondeSolve(GFn &gf, const uint16_t *x, uint16_t n, uint16_t *b)
+{
+    return vandermondeSolveT(gf, x, n, b);
+}
+
+uint8_t StructuredMatrix::vandermondeSolveTransposed(GF2 &gf, const uint8_t *x, uint16_t n, uint8_t *b)
+{
+    return vandermondeSolveTransposedT(gf, x, n, b);
+}
+
+uint8_t StructuredMatrix::vandermondeSolveTransposed(GFn &gf, const uint16_t *x, uint16_t n, uint16_t *b)
+{
+    return vandermondeSolveTransposedT(gf, x, n, b);
+}
+
+uint8_t StructuredMatrix::barycentricWeights(GF2 &gf, const uint8_t *x, uint16_t n, uint8_t *w)
+{
+    return barycentricWeightsT(gf, x, n, w);
+}
+
+uint8_t StructuredMatrix::barycentricWeights(GFn &gf, const uint16_t *x, uint16_t n, uint16_t *w)
+{
+    return barycentricWeightsT(gf, x, n, w);
+}
+
+uint8_t StructuredMatrix::vandermondeInverse(GF2 &gf, const uint8_t *x, uint16_t n, uint8_t *inv)
+{
+    return vandermondeInverseT(gf, x, n, inv);
+}
+
+uint8_t StructuredMatrix::vandermondeInverse(GFn &gf, const uint16_t *x, uint16_t n, uint16_t *inv)
+{
+    return vandermondeInverseT(gf, x, n, inv);
+}
+
+uint8_t StructuredMatrix::cauchyInverse(GF2 &gf, const uint8_t *x, const uint8_t *y, uint16_t n, uint8_t *inv)
+{
+    return cauchyInverseT(gf, x, y, n, inv);
+}
+
+uint8_t StructuredMatrix::cauchyInverse(GFn &gf, const uint16_t *x, const uint16_t *y, uint16_t n, uint16_t *inv)
+{
+    return cauchyInverseT(gf, x, y, n, inv);
+}
+
+uint8_t StructuredMatrix::cauchySolve(GF2 &gf, const uint8_t *x, const uint8_t *y, uint16_t n, uint8_t *b)
+{
+    return cauchySolveT(gf, x, y, n, b);
+}
+
+uint8_t StructuredMatrix::cauchySolve(GFn &gf, const uint16_t *x, const uint16_t *y, uint16_t n, uint16_t *b)
+{
+    return cauchySolveT(gf, x, y, n, b);
+}
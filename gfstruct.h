@@ -0,0 +1,121 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file gfstruct.h
+* @brief Structured (Vandermonde and Cauchy) matrix inversion and solving over GF(2^8) and GF(p)
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef GFSTRUCT_H
+#define GFSTRUCT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "gf2.h"
+#include "gfn.h"
+
+/**
+ * @brief This class provides O(n^2) inversion and solving of Vandermonde and Cauchy matrices
+ *
+ * General Gauss-Jordan elimination takes O(n^3) operations, but these matrices are defined by n (or 2n) points,
+ * which gives closed-form inverses and Bjorck-Pereyra elimination in O(n^2).
+ * Vandermonde matrix: v_ij = x_i^j. Cauchy matrix: c_ij = 1/(x_i - y_j), which is 1/(x_i + y_j) in GF(2^8).
+ * All matrices are row-major. Every routine exists for GF2 and GFn.
+ */
+class StructuredMatrix
+{
+public:
+	/**
+	 * @brief Solve Vandermonde system V*a = b (polynomial interpolation)
+	 * @param &gf Field
+	 * @param *x n distinct points
+	 * @param n Matrix size
+	 * @param *b Right-hand side, replaced with a: sum of a_j*x_i^j = b_i, so a are coefficients of the interpolating polynomial
+	 * @return 0 on success, 1 if points are not distinct
+	 * Bjorck-Pereyra: Newton divided differences followed by conversion to monomial basis.
+	 */
+	static uint8_t vandermondeSolve(GF2 &gf, const uint8_t *x, uint16_t n, uint8_t *b);
+	static uint8_t vandermondeSolve(GFn &gf, const uint16_t *x, uint16_t n, uint16_t *b);
+
+	/**
+	 * @brief Solve transposed Vandermonde system V^T*z = b
+	 * @param &gf Field
+	 * @param *x n distinct points
+	 * @param n Matrix size
+	 * @param *b Right-hand side, replaced with z: sum of z_i*x_i^j = b_j
+	 * @return 0 on success, 1 if points are not distinct
+	 * For b_j = t^j the solution is the vector of Lagrange basis polynomials evaluated at t.
+	 */
+	static uint8_t vandermondeSolveTransposed(GF2 &gf, const uint8_t *x, uint16_t n, uint8_t *b);
+	static uint8_t vandermondeSolveTransposed(GFn &gf, const uint16_t *x, uint16_t n, uint16_t *b);
+
+	/**
+	 * @brief Calculate barycentric weights of interpolation points
+	 * @param &gf Field
+	 * @param *x n distinct points
+	 * @param n Number of points
+	 * @param *w Output weights, w_i = 1/product of (x_i - x_k) over k other than i
+	 * @return 0 on success, 1 if points are not distinct
+	 * The Lagrange basis polynomial for x_i at t is then L_i(t) = w_i*l(t)/(t - x_i), where l(t) = product of (t - x_k),
+	 * so every further solution of the transposed Vandermonde system with b_j = t^j takes only O(n).
+	 */
+	static uint8_t barycentricWeights(GF2 &gf, const uint8_t *x, uint16_t n, uint8_t *w);
+	static uint8_t barycentricWeights(GFn &gf, const uint16_t *x, uint16_t n, uint16_t *w);
+
+	/**
+	 * @brief Invert Vandermonde matrix
+	 * @param &gf Field
+	 * @param *x n distinct points
+	 * @param n Matrix size
+	 * @param *inv Output n x n inverse. Column i holds coefficients of the Lagrange basis polynomial for x_i
+	 * @return 0 on success, 1 if points are not distinct
+	 */
+	static uint8_t vandermondeInverse(GF2 &gf, const uint8_t *x, uint16_t n, uint8_t *inv);
+	static uint8_t vandermondeInverse(GFn &gf, const uint16_t *x, uint16_t n, uint16_t *inv);
+
+	/**
+	 * @brief Invert Cauchy matrix
+	 * @param &gf Field
+	 * @param *x n distinct row points
+	 * @param *y n distinct column points, different from all row points
+	 * @param n Matrix size
+	 * @param *inv Output n x n inverse
+	 * @return 0 on success, 1 if points do not define a Cauchy matrix
+	 * inv_ij = a(y_i)*b(x_j) / ((y_i - x_j)*a_j*b_i), where a(z) and b(z) are products of (z - x_k) and (z - y_k)
+	 * and a_j, b_i are the products of (x_j - x_k) and (y_i - y_k) over k other than j and i.
+	 */
+	static uint8_t cauchyInverse(GF2 &gf, const uint8_t *x, const uint8_t *y, uint16_t n, uint8_t *inv);
+	static uint8_t cauchyInverse(GFn &gf, const uint16_t *x, const uint16_t *y, uint16_t n, uint16_t *inv);
+
+	/**
+	 * @brief Solve Cauchy system C*z = b
+	 * @param &gf Field
+	 * @param *x n distinct row points
+	 * @param *y n distinct column points, different from all row points
+	 * @param n Matrix size
+	 * @param *b Right-hand side, replaced with z
+	 * @return 0 on success, 1 if points do not define a Cauchy matrix
+	 * The closed-form inverse is applied without storing it.
+	 */
+	static uint8_t cauchySolve(GF2 &gf, const uint8_t *x, const uint8_t *y, uint16_t n, uint8_t *b);
+	static uint8_t cauchySolve(GFn &gf, const uint16_t *x, const uint16_t *y, uint16_t n, uint16_t *b);
+};
+
+#endif
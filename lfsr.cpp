@@ -0,0 +1,313 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file lfsr.cpp
+* @brief Linear feedback shift register sequences with jump-ahead
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "lfsr.h"
+#include <string.h>
+#include <thread>
+
+#if defined(__GNUC__)
+#define LFSR_UNROLL _Pragma("GCC unroll 8") //keep all blocks in registers
+#else
+#define LFSR_UNROLL
+#endif
+
+/**
+ * @brief Reflect bits in every byte of a 64-bit word
+ * @param x Input word
+ * @return Word with reflected bytes
+ */
+static inline uint64_t reflectBytes(uint64_t x)
+{
+    x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    return x;
+}
+
+/**
+ * @brief Reflect lowest bits of a word
+ * @param x Input word
+ * @param bits Number of bits to reflect
+ * @return Reflected value
+ */
+static inline uint64_t reflect(uint64_t x, uint8_t bits)
+{
+    uint64_t ret = 0;
+    for(uint8_t i = 0; i < bits; i++)
+    {
+        ret = (ret << 1) | (x & 1);
+        x >>= 1;
+    }
+    return ret;
+}
+
+/**
+ * @brief Multiply polynomials modulo P
+ * @param x Multiplicand
+ * @param y Multiplier
+ * @return x*y mod P
+ */
+uint64_t LFSR::mulMod(uint64_t x, uint64_t y)
+{
+    uint64_t ret = 0;
+    while(y)
+    {
+        if(y & 1) //if current multiplier is odd
+            ret ^= x; //add multiplicand to the result
+        y >>= 1;
+        uint64_t carry = (x >> (degree - 1)) & 1;
+        x = (x << 1) & mask; //multiply x by x
+        if(carry)
+            x ^= poly; //apply modular reduction, the same as in GF2::slowMul()
+    }
+    return ret;
+}
+
+/**
+ * @brief Calculate x^n mod P using square-and-multiply
+ * @param n Exponent
+ * @return x^n mod P
+ */
+uint64_t LFSR::xPowMod(uint64_t n)
+{
+    uint64_t base = (degree > 1) ? 2 : poly; //x mod P, which is just x unless P is of degree 1
+    uint64_t ret = 1;
+    while(n)
+    {
+        if(n & 1)
+            ret = mulMod(ret, base);
+        base = mulMod(base, base);
+        n >>= 1;
+    }
+    return ret;
+}
+
+/**
+ * @brief Get 64 sequence bits starting from any position
+ * @param t Position, counted from the first bit of the initial register contents
+ * @return Sequence bits, the first one in the LSB
+ */
+uint64_t LFSR::window(uint64_t t)
+{
+    //x^t = sum of c_i*x^i mod P, so every bit u_(t+j) = sum of c_i*u_(i+j), taken from the prefix
+    uint64_t c = xPowMod(t);
+    uint64_t ret = 0;
+    for(uint8_t j = 0; j < 64; j++)
+    {
+        uint64_t bits = j ? ((prefix[0] >> j) | (prefix[1] << (64 - j))) : prefix[0];
+        ret |= (uint64_t)__builtin_parityll(bits & c) << j;
+    }
+    return ret;
+}
+
+/**
+ * @brief Advance block using lookup tables
+ * @param *table Lookup tables, 256 entries per register byte
+ * @param block Current block
+ * @return Block that is a fixed distance ahead
+ */
+inline uint64_t LFSR::advance(const uint64_t *table, uint64_t block)
+{
+    //the next block only depends on the first degree bits, so the matrix is applied byte by byte
+    uint64_t ret = 0;
+    for(uint8_t i = 0; i < tableBytes; i++)
+        ret ^= table[i * 256 + ((block >> (8 * i)) & 0xFF)];
+    return ret;
+}
+
+/**
+ * @brief Generate sequence or scramble data
+ * @param offset Sequence offset in bits
+ * @param *in Input data, nullptr to output the sequence only
+ * @param *out Output buffer, out = in XOR sequence, may be the same as in
+ * @param len Length in bytes
+ */
+void LFSR::generate(uint64_t offset, const uint8_t *in, uint8_t *out, size_t len)
+{
+    if(degree == 0 || len == 0)
+        return;
+
+    uint64_t block[LFSR_BLOCKS];
+    block[0] = window(offset + degree);
+    for(uint8_t i = 1; i < LFSR_BLOCKS; i++)
+        block[i] = advance(advance1.data(), block[i - 1]);
+
+    const uint64_t *table = advanceN.data();
+    while(len >= (8 * LFSR_BLOCKS))
+    {
+        LFSR_UNROLL
+        for(uint8_t i = 0; i < LFSR_BLOCKS; i++)
+        {
+            uint64_t x = msbFirst ? reflectBytes(block[i]) : block[i];
+            if(in)
+            {
+                uint64_t y;
+                memcpy(&y, in + 8 * i, 8);
+                x ^= y;
+            }
+            memcpy(out + 8 * i, &x, 8);
+            block[i] = advance(table, block[i]);
+        }
+        if(in)
+            in += 8 * LFSR_BLOCKS;
+        out += 8 * LFSR_BLOCKS;
+        len -= 8 * LFSR_BLOCKS;
+    }
+
+    for(uint8_t i = 0; len > 0; i++)
+    {
+        uint8_t x[8];
+        uint64_t b = msbFirst ? reflectBytes(block[i]) : block[i];
+        memcpy(x, &b, 8);
+        size_t n = (len < 8) ? len : 8;
+        for(size_t j = 0; j < n; j++)
+            out[j] = (in ? in[j] : 0) ^ x[j];
+        if(in)
+            in += n;
+        out += n;
+        len -= n;
+    }
+}
+
+/**
+ * @brief Generate sequence or scramble data using multiple threads
+ * @param offset Sequence offset in bits
+ * @param *in Input data, nullptr to output the sequence only
+ * @param *out Output buffer, out = in XOR sequence, may be the same as in
+ * @param len Length in bytes
+ * @param threads Number of threads, 0 to use all hardware threads
+ */
+void LFSR::generateParallel(uint64_t offset, const uint8_t *in, uint8_t *out, size_t len, unsigned threads)
+{
+    if(threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if(threads == 0)
+        threads = 1;
+
+    //every thread gets a whole number of steps
+    size_t part = (len + threads - 1) / threads;
+    part = (part + 8 * LFSR_BLOCKS - 1) / (8 * LFSR_BLOCKS) * (8 * LFSR_BLOCKS);
+    std::vector<std::thread> workers;
+    size_t start = 0;
+    while((len - start) > part)
+    {
+        workers.emplace_back(&LFSR::generate, this, offset + 8 * (uint64_t)start, in ? (in + start) : nullptr, out + start, part);
+        start += part;
+    }
+    generate(offset + 8 * (uint64_t)start, in ? (in + start) : nullptr, out + start, len - start);
+    for(size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+}
+
+/**
+ * @brief Get register state at a given offset
+ * @param offset Sequence offset in bits
+ * @return Register contents before output bit s_offset, in the same format as initial state
+ */
+uint64_t LFSR::state(uint64_t offset)
+{
+    if(degree == 0)
+        return 0;
+    //stage k holds the bit output k steps before
+    return reflect(window(offset), degree);
+}
+
+/**
+ * @brief Check if object is initialized
+ * @return 0 if initialized
+ */
+uint8_t LFSR::isInitialized(void)
+{
+    return (degree == 0);
+}
+
+/**
+ * @brief Initializes LFSR
+ * @param degree Generator polynomial degree (register length), 1 to 64
+ * @param poly Generator polynomial without the x^degree term, constant term must be 1
+ * @param init Initial register contents, bit k-1 is stage k
+ * @param msbFirst Put sequence bits into bytes starting from the MSB, otherwise from the LSB
+ */
+LFSR::LFSR(uint8_t degree, uint64_t poly, uint64_t init, bool msbFirst)
+{
+    this->degree = 0;
+    this->msbFirst = msbFirst;
+    prefix[0] = 0;
+    prefix[1] = 0;
+    tableBytes = 0;
+    if((degree < 1) || (degree > 64))
+        return;
+    mask = (degree == 64) ? ~(uint64_t)0 : (((uint64_t)1 << degree) - 1);
+    if(((poly & 1) == 0) || (poly & ~mask))
+        return;
+
+    //s_n = s_(n-degree) + sum of g_k*s_(n-k), so the characteristic polynomial is the reciprocal of the generator
+    this->poly = 1;
+    for(uint8_t k = 1; k < degree; k++)
+    {
+        if((poly >> k) & 1)
+            this->poly |= (uint64_t)1 << (degree - k);
+    }
+    this->degree = degree;
+
+    //the sequence starts with the register contents, the oldest bit (stage degree) first
+    uint64_t w = reflect(init & mask, degree);
+    for(uint8_t t = 0; t < 128; t++)
+    {
+        prefix[t >> 6] |= (w & 1) << (t & 63);
+        uint64_t b = __builtin_parityll(w & this->poly);
+        w = (w >> 1) | (b << (degree - 1));
+    }
+
+    //columns of the block advance matrices: sequence started from a single bit
+    std::vector<uint64_t> col1(degree, 0), colN(degree, 0);
+    for(uint8_t i = 0; i < degree; i++)
+    {
+        w = (uint64_t)1 << i;
+        for(uint32_t t = 0; t < 64 * (LFSR_BLOCKS + 1); t++)
+        {
+            if((t >= 64) && (t < 128))
+                col1[i] |= (w & 1) << (t - 64);
+            if(t >= 64 * LFSR_BLOCKS)
+                colN[i] |= (w & 1) << (t - 64 * LFSR_BLOCKS);
+            uint64_t b = __builtin_parityll(w & this->poly);
+            w = (w >> 1) | (b << (degree - 1));
+        }
+    }
+    tableBytes = (degree + 7) / 8;
+    advance1.assign(tableBytes * 256, 0);
+    advanceN.assign(tableBytes * 256, 0);
+    for(uint8_t i = 0; i < degree; i++)
+    {
+        for(uint16_t v = 0; v < 256; v++)
+        {
+            if((v >> (i & 7)) & 1)
+            {
+                advance1[(i >> 3) * 256 + v] ^= col1[i];
+                advanceN[(i >> 3) * 256 + v] ^= colN[i];
+            }
+        }
+    }
+}
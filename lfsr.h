@@ -0,0 +1,120 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file lfsr.h
+* @brief Linear feedback shift register sequences with jump-ahead
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef LFSR_H
+#define LFSR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+//some commonly used generator polynomials (without the x^degree term)
+#define LFSR_PRBS7 0x41 //x^7 + x^6 + 1, ITU-T O.150 PRBS7
+#define LFSR_PRBS9 0x21 //x^9 + x^5 + 1, PRBS9
+#define LFSR_PRBS15 0x4001 //x^15 + x^14 + 1, PRBS15 and DVB energy dispersal
+#define LFSR_PRBS23 0x40001 //x^23 + x^18 + 1, PRBS23
+#define LFSR_PRBS31 0x10000001 //x^31 + x^28 + 1, PRBS31
+#define LFSR_WIFI 0x11 //x^7 + x^4 + 1, IEEE 802.11 scrambler
+
+#define LFSR_BLOCKS 8 //number of 64-bit blocks generated per step
+
+/**
+ * @brief This class provides generation of LFSR (PRBS, scrambler) sequences from any offset
+ *
+ * The register is a Fibonacci LFSR: stage 1 receives the output bit s_n, which is the sum of stages k
+ * (bits s_(n-k)) for every x^k term of the generator polynomial.
+ * The sequence satisfies a linear recurrence with characteristic polynomial P (reciprocal of the generator polynomial),
+ * so the state at offset N is obtained from x^N mod P, calculated with square-and-multiply in GF(2)[x]
+ * the same way as in GF2::slowMul(). Bulk output advances 64-bit blocks using lookup tables of the precomputed
+ * matrix powers, 512 bits per step, and can be split across threads.
+ */
+class LFSR
+{
+public:
+	/**
+	 * @brief Generate sequence or scramble data
+	 * @param offset Sequence offset in bits
+	 * @param *in Input data, nullptr to output the sequence only
+	 * @param *out Output buffer, out = in XOR sequence, may be the same as in
+	 * @param len Length in bytes
+	 */
+	void generate(uint64_t offset, const uint8_t *in, uint8_t *out, size_t len);
+
+	/**
+	 * @brief Generate sequence or scramble data using multiple threads
+	 * @param offset Sequence offset in bits
+	 * @param *in Input data, nullptr to output the sequence only
+	 * @param *out Output buffer, out = in XOR sequence, may be the same as in
+	 * @param len Length in bytes
+	 * @param threads Number of threads, 0 to use all hardware threads
+	 * Every thread jumps directly to its part of the sequence.
+	 */
+	void generateParallel(uint64_t offset, const uint8_t *in, uint8_t *out, size_t len, unsigned threads = 0);
+
+	/**
+	 * @brief Get register state at a given offset
+	 * @param offset Sequence offset in bits
+	 * @return Register contents before output bit s_offset, in the same format as initial state
+	 */
+	uint64_t state(uint64_t offset);
+
+	/**
+	 * @brief Calculate x^n mod P
+	 * @param n Exponent
+	 * @return x^n mod P, where P is the characteristic polynomial (reciprocal of the generator polynomial)
+	 */
+	uint64_t xPowMod(uint64_t n);
+
+	/**
+	 * @brief Check if object is initialized
+	 * @return 0 if initialized
+	 */
+	uint8_t isInitialized(void);
+
+	/**
+	 * @brief Initializes LFSR
+	 * @param degree Generator polynomial degree (register length), 1 to 64
+	 * @param poly Generator polynomial without the x^degree term, constant term must be 1
+	 * @param init Initial register contents, bit k-1 is stage k
+	 * @param msbFirst Put sequence bits into bytes starting from the MSB (e.g. DVB), otherwise from the LSB (e.g. 802.11)
+	 */
+	LFSR(uint8_t degree, uint64_t poly, uint64_t init, bool msbFirst = false);
+
+private:
+	uint8_t degree; //register length, 0 if not initialized
+	uint64_t poly; //characteristic polynomial without the x^degree term
+	uint64_t mask; //degree-bit mask
+	bool msbFirst; //output bit order
+	uint64_t prefix[2]; //first 128 bits of the sequence, starting from the initial register contents
+	uint8_t tableBytes; //number of bytes of the register in lookup tables
+	std::vector<uint64_t> advance1; //tables advancing a block by 64 bits, 256 entries per register byte
+	std::vector<uint64_t> advanceN; //tables advancing a block by 64*LFSR_BLOCKS bits
+
+	uint64_t mulMod(uint64_t x, uint64_t y); //x*y mod P
+	uint64_t window(uint64_t t); //64 sequence bits starting from t-th bit of prefix
+	uint64_t advance(const uint64_t *table, uint64_t block); //advance block using lookup tables
+};
+
+#endif
@@ -1,10 +1,617 @@
 #include <iostream>
-#include "gf.h"
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <functional>
+#include <algorithm>
+#include "gf2.h"
+#include "ec.h"
+#include "clay.h"
+#include "rs.h"
+#include "sim.h"
+#include "gfn.h"
+#include "eccache.h"
+#include "gfring.h"
 
 using namespace std;
 
-int main()
+/**
+ * @brief Get time in seconds since first call
+ * @return Time in seconds
+ */
+static double now(void)
 {
-    GF gf(11);
+    static const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Compare single node repair of Clay code and plain Reed-Solomon code
+ * @param k Number of data shards
+ * @param m Number of parity shards
+ * @param len Shard length in bytes
+ */
+static void benchRepair(uint8_t k, uint8_t m, size_t len)
+{
+    GF2 gf;
+    ClayCode clay(gf, k, m);
+    ErasureCode rs(gf, k, m);
+    if(clay.isInitialized() || rs.isInitialized())
+    {
+        cout << "repair " << (int)k << "+" << (int)m << ": unsupported parameters" << endl;
+        return;
+    }
+    uint32_t alpha = clay.getSubPacketization();
+    len -= len % alpha;
+    uint16_t n = (uint16_t)k + m;
+
+    vector<vector<uint8_t>> shards(n, vector<uint8_t>(len));
+    vector<const uint8_t*> data(k);
+    vector<uint8_t*> parity(m);
+    for(uint8_t i = 0; i < k; i++)
+    {
+        for(size_t j = 0; j < len; j++)
+            shards[i][j] = (uint8_t)rand();
+        data[i] = shards[i].data();
+    }
+    for(uint8_t i = 0; i < m; i++)
+        parity[i] = shards[k + i].data();
+
+    //both codes repair the first data shard
+    vector<uint8_t> out(len);
+    vector<const uint8_t*> helpers(n);
+    for(uint16_t i = 0; i < n; i++)
+        helpers[i] = shards[i].data();
+    helpers[0] = nullptr;
+    uint8_t wanted = 0;
+    uint8_t *outPtr = out.data();
+
+    clay.encode(data.data(), parity.data(), len);
+    int rounds = 0;
+    double t = now();
+    do
+    {
+        clay.repair(0, helpers.data(), out.data(), len);
+        rounds++;
+    } while((now() - t) < 0.5);
+    double clayTime = (now() - t) / rounds;
+    bool clayOk = (out == shards[0]);
+    vector<uint32_t> layers(alpha);
+    size_t clayRead = (size_t)(n - 1) * clay.repairLayers(0, layers.data()) * (len / alpha);
+
+    rs.encode(data.data(), parity.data(), len);
+    rounds = 0;
+    t = now();
+    do
+    {
+        rs.decode(helpers.data(), &wanted, 1, &outPtr, 0, len);
+        rounds++;
+    } while((now() - t) < 0.5);
+    double rsTime = (now() - t) / rounds;
+    bool rsOk = (out == shards[0]);
+    size_t rsRead = (size_t)k * len;
+
+    cout << "repair " << (int)k << "+" << (int)m << ", shard " << len << " B, alpha " << alpha << endl;
+    cout << "  clay: read " << clayRead << " B (" << (double)clayRead / len << " shards), "
+         << len / clayTime / 1e6 << " MB/s repaired" << (clayOk ? "" : " FAILED") << endl;
+    cout << "  rs:   read " << rsRead << " B (" << (double)rsRead / len << " shards), "
+         << len / rsTime / 1e6 << " MB/s repaired" << (rsOk ? "" : " FAILED") << endl;
+}
+
+/**
+ * @brief Simulate chained partial-sum repair, every helper running in its own thread
+ * @param k Number of data shards
+ * @param m Number of parity shards
+ * @param lost Number of lost data shards
+ * @param len Shard length in bytes
+ * @param chunk Pipelining unit in bytes
+ *
+ * Helper i receives partial sums from helper i-1 chunk by chunk, adds its own terms and forwards them,
+ * so every link carries only lost*len bytes, while a conventional repair node receives k*len bytes.
+ */
+static void benchPartial(uint8_t k, uint8_t m, uint8_t lost, size_t len, size_t chunk)
+{
+    GF2 gf;
+    ErasureCode rs(gf, k, m);
+    if(rs.isInitialized() || (lost > m))
+        return;
+    uint16_t n = (uint16_t)k + m;
+
+    vector<vector<uint8_t>> shards(n, vector<uint8_t>(len));
+    vector<const uint8_t*> data(k);
+    vector<uint8_t*> parity(m);
+    for(uint8_t i = 0; i < k; i++)
+    {
+        for(size_t j = 0; j < len; j++)
+            shards[i][j] = (uint8_t)rand();
+        data[i] = shards[i].data();
+    }
+    for(uint8_t i = 0; i < m; i++)
+        parity[i] = shards[k + i].data();
+    rs.encode(data.data(), parity.data(), len);
+
+    vector<uint8_t> present(n, 1), wanted(lost);
+    for(uint8_t i = 0; i < lost; i++)
+    {
+        wanted[i] = i;
+        present[i] = 0;
+    }
+    //a shard index past k+m-1 must be rejected before any generator row is read
+    bool rangeOk = true;
+    if((n < 256) && (lost > 0))
+    {
+        vector<ECHelper> rejected;
+        vector<uint8_t> outOfRange(wanted);
+        outOfRange[lost - 1] = (uint8_t)n;
+        rangeOk = (rs.repairHelpers(present.data(), outOfRange.data(), lost, rejected) == 1) && rejected.empty();
+    }
+
+    vector<ECHelper> helpers;
+    rs.repairHelpers(present.data(), wanted.data(), lost, helpers);
+    size_t h = helpers.size();
+
+    //every helper owns the outgoing link buffers, the last one holds rebuilt shards
+    vector<vector<vector<uint8_t>>> link(h, vector<vector<uint8_t>>(lost, vector<uint8_t>(len)));
+    vector<vector<uint8_t*>> linkPtr(h, vector<uint8_t*>(lost));
+    for(size_t i = 0; i < h; i++)
+    {
+        for(uint8_t j = 0; j < lost; j++)
+            linkPtr[i][j] = link[i][j].data();
+    }
+    size_t chunks = (len + chunk - 1) / chunk;
+
+    int rounds = 0;
+    double t = now();
+    do
+    {
+        vector<atomic<size_t>> done(h);
+        for(size_t i = 0; i < h; i++)
+            done[i] = 0;
+        vector<thread> threads;
+        for(size_t i = 0; i < h; i++)
+        {
+            threads.emplace_back([&, i]()
+            {
+                vector<const uint8_t*> in(lost);
+                vector<uint8_t*> out(lost);
+                const uint8_t *shard = shards[helpers[i].shard].data();
+                for(size_t c = 0; c < chunks; c++)
+                {
+                    size_t offset = c * chunk;
+                    size_t l = ((len - offset) < chunk) ? (len - offset) : chunk;
+                    if(i > 0)
+                    {
+                        while(done[i - 1].load(memory_order_acquire) <= c)
+                            this_thread::yield(); //wait for upstream chunk
+                    }
+                    for(uint8_t j = 0; j < lost; j++)
+                    {
+                        if(i > 0)
+                            in[j] = linkPtr[i - 1][j] + offset;
+                        out[j] = linkPtr[i][j] + offset;
+                    }
+                    ErasureCode::partialRepair(helpers[i], shard + offset, (i > 0) ? in.data() : nullptr, out.data(), l);
+                    done[i].store(c + 1, memory_order_release);
+                }
+            });
+        }
+        for(size_t i = 0; i < h; i++)
+            threads[i].join();
+        rounds++;
+    } while((now() - t) < 0.5);
+    double chainTime = (now() - t) / rounds;
+    bool ok = true;
+    for(uint8_t j = 0; j < lost; j++)
+        ok &= (link[h - 1][j] == shards[j]);
+
+    vector<const uint8_t*> avail(n);
+    for(uint16_t i = 0; i < n; i++)
+        avail[i] = present[i] ? shards[i].data() : nullptr;
+    vector<vector<uint8_t>> out(lost, vector<uint8_t>(len));
+    vector<uint8_t*> outPtr(lost);
+    for(uint8_t j = 0; j < lost; j++)
+        outPtr[j] = out[j].data();
+    rounds = 0;
+    t = now();
+    do
+    {
+        rs.decode(avail.data(), wanted.data(), lost, outPtr.data(), 0, len);
+        rounds++;
+    } while((now() - t) < 0.5);
+    double rsTime = (now() - t) / rounds;
+
+    cout << "partial " << (int)k << "+" << (int)m << ", " << (int)lost << " lost, shard " << len << " B, chunk " << chunk << " B, "
+         << h << " chained helpers" << (rangeOk ? "" : ", out-of-range index accepted FAILED") << endl;
+    cout << "  chained:      max link/node ingress " << (size_t)lost * len << " B, "
+         << lost * len / chainTime / 1e6 << " MB/s rebuilt" << (ok ? "" : " FAILED") << endl;
+    cout << "  conventional: repair node ingress " << (size_t)k * len << " B, "
+         << lost * len / rsTime / 1e6 << " MB/s rebuilt" << endl;
+}
+
+/**
+ * @brief Compare per-codeword and batched Reed-Solomon decoding
+ * @param n Codeword length
+ * @param nroots Number of parity symbols
+ * @param count Number of codewords
+ *
+ * 80% of codewords are clean, 15% have a single error and 5% have nroots/4 errors.
+ */
+static void benchDecode(uint8_t n, uint8_t nroots, size_t count)
+{
+    GF2 gf;
+    ReedSolomon rs(gf, n, nroots);
+    if(rs.isInitialized())
+        return;
+    uint8_t k = n - nroots;
+
+    vector<uint8_t> codewords(count * n);
+    for(size_t c = 0; c < count; c++)
+    {
+        uint8_t *w = &codewords[c * n];
+        for(uint8_t i = 0; i < k; i++)
+            w[i] = (uint8_t)rand();
+        rs.encode(w, w + k);
+        int r = rand() % 100;
+        uint8_t errors = (r < 80) ? 0 : ((r < 95) ? 1 : nroots / 4);
+        for(uint8_t i = 0; i < errors; i++)
+            w[rand() % n] ^= (uint8_t)(1 + rand() % 255);
+    }
+
+    vector<uint8_t> work;
+    int rounds = 0;
+    double t = now();
+    do
+    {
+        work = codewords;
+        for(size_t c = 0; c < count; c++)
+            rs.decode(&work[c * n]);
+        rounds++;
+    } while((now() - t) < 0.5);
+    double single = (now() - t) / rounds / count;
+
+    rounds = 0;
+    t = now();
+    do
+    {
+        work = codewords;
+        rs.decodeBatch(work.data(), count);
+        rounds++;
+    } while((now() - t) < 0.5);
+    double batch = (now() - t) / rounds / count;
+
+    cout << "rs decode (" << (int)n << "," << (int)k << "): per codeword " << single * 1e9 << " ns, batched "
+         << batch * 1e9 << " ns, speedup " << single / batch << endl;
+}
+
+/**
+ * @brief Simulate frame error rate of a Reed-Solomon code on a binary symmetric channel
+ * @param n Codeword length
+ * @param nroots Number of parity symbols
+ * @param p Bit error probability
+ */
+static void benchSim(uint8_t n, uint8_t nroots, double p)
+{
+    GF2 gf;
+    ReedSolomon rs(gf, n, nroots);
+    if(rs.isInitialized())
+        return;
+    uint8_t k = n - nroots;
+
+    Simulator sim(k, n,
+        [&](const uint8_t *data, uint8_t *codewords, size_t count)
+        {
+            for(size_t c = 0; c < count; c++)
+            {
+                memcpy(&codewords[c * n], &data[c * k], k);
+                rs.encode(&codewords[c * n], &codewords[c * n + k]);
+            }
+        },
+        [&](uint8_t *codewords, const uint8_t *erased, uint8_t *data, size_t count)
+        {
+            (void)erased;
+            rs.decodeBatch(codewords, count);
+            for(size_t c = 0; c < count; c++)
+                memcpy(&data[c * k], &codewords[c * n], k);
+        });
+    sim.setStop(0.1, 100, 10000000);
+    SimResult r = sim.run(p);
+
+    cout << "sim rs (" << (int)n << "," << (int)k << "), bsc p=" << p << ": fer " << r.fer << " [" << r.ferLow << ", " << r.ferHigh
+         << "], ber " << r.ber << ", " << r.frames << " frames, " << r.frames / r.seconds << " frames/s" << endl;
+}
+
+/**
+ * @brief Measure get latency percentiles of a cache for random keys
+ * @param &cache Cache
+ * @param count Number of objects (keys 0...count-1)
+ * @param *label Label printed before results
+ */
+static void cacheLatency(ECCache &cache, size_t count, const char *label)
+{
+    vector<double> lat;
+    vector<uint8_t> data;
+    size_t failed = 0;
+    double t = now();
+    do
+    {
+        double s = now();
+        failed += (cache.get(rand() % count, data) != 0);
+        lat.push_back(now() - s);
+    } while((now() - t) < 0.5);
+    sort(lat.begin(), lat.end());
+    cout << "  " << label << ": p50 " << lat[lat.size() / 2] * 1e6 << " us, p99 " << lat[lat.size() * 99 / 100] * 1e6
+         << " us, p99.9 " << lat[lat.size() * 999 / 1000] * 1e6 << " us";
+    if(failed)
+        cout << ", " << failed << " failed";
+    cout << endl;
+}
+
+/**
+ * @brief Compare get latency and memory overhead of an erasure coded cache with degraded reads and repair
+ * @param k Number of data shards (1 for replication)
+ * @param m Number of parity shards (copies for replication)
+ * @param nodes Number of nodes
+ * @param count Number of objects
+ * @param len Object size in bytes
+ */
+static void benchCache(uint8_t k, uint8_t m, uint8_t nodes, size_t count, size_t len)
+{
+    GF2 gf;
+    ECCache cache(gf, k, m, nodes);
+    if(cache.isInitialized())
+        return;
+    vector<uint8_t> data(len);
+    for(size_t i = 0; i < len; i++)
+        data[i] = (uint8_t)rand();
+    for(size_t i = 0; i < count; i++)
+    {
+        data[0] = (uint8_t)i;
+        cache.put(i, data.data(), len);
+    }
+    ECCacheStats s = cache.getStats();
+    if(k == 1)
+        cout << "cache replication x" << (int)(m + 1);
+    else
+        cout << "cache ec " << (int)k << "+" << (int)m;
+    cout << ", " << (int)nodes << " nodes, " << count << " x " << len << " bytes, memory overhead "
+         << (double)s.storedBytes / s.logicalBytes << "x" << endl;
+
+    cacheLatency(cache, count, "healthy");
+    cache.failNode(0);
+    cacheLatency(cache, count, "1 node down");
+    double t = now();
+    size_t repaired = cache.repair();
+    t = now() - t;
+    cout << "  repair: " << repaired << " shards in " << t * 1e3 << " ms" << endl;
+    cacheLatency(cache, count, "repaired");
+}
+
+/**
+ * @brief Get CPU time of calling thread
+ * @return Time in seconds
+ */
+static double threadTime(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * @brief Evict caches by walking a buffer
+ * @param &buf Buffer, should be larger than the cache level to be evicted
+ */
+static void evict(vector<uint8_t> &buf)
+{
+    for(size_t i = 0; i < buf.size(); i += 64)
+        buf[i]++;
+}
+
+/**
+ * @brief Compare table-based and table-free field arithmetic under cache pressure
+ * @param batch Number of operations between evictions
+ * @param evictBytes Size of the buffer walked between batches
+ * @param corunBytes Size of the buffer walked continuously by a co-running thread
+ * Every strategy is timed with warm caches, with caches evicted before every batch of operations (inputs of the batch
+ * are reloaded after eviction and the eviction itself is not timed, so the difference comes from the lookup tables),
+ * and with a thrashing co-runner thread. GF2 uses 768 bytes of tables, GFn 4*p bytes.
+ */
+static void benchPressure(size_t batch, size_t evictBytes, size_t corunBytes)
+{
+    const size_t count = 4096;
+    GF2 gf2;
+    GFn gfSmall(257), gfLarge(65521);
+    vector<uint8_t> x8(count), y8(count), out8(count);
+    vector<uint16_t> xs(count), ys(count), xl(count), yl(count);
+    for(size_t i = 0; i < count; i++)
+    {
+        x8[i] = (uint8_t)rand();
+        y8[i] = (uint8_t)rand();
+        xs[i] = 1 + rand() % 256;
+        ys[i] = 1 + rand() % 256;
+        xl[i] = 1 + rand() % 65520;
+        yl[i] = 1 + rand() % 65520;
+    }
+    volatile uint32_t sink = 0;
+
+    struct Strategy
+    {
+        const char *name;
+        function<uint32_t(size_t, size_t)> run; //run operations on inputs i0...i0+n-1
+        function<uint32_t(size_t, size_t)> touch; //load inputs i0...i0+n-1
+    };
+    auto touch8 = [&](size_t i0, size_t n) { uint32_t a = 0; for(size_t i = i0; i < i0 + n; i++) a += x8[i] + y8[i]; return a; };
+    auto touchS = [&](size_t i0, size_t n) { uint32_t a = 0; for(size_t i = i0; i < i0 + n; i++) a += xs[i] + ys[i]; return a; };
+    auto touchL = [&](size_t i0, size_t n) { uint32_t a = 0; for(size_t i = i0; i < i0 + n; i++) a += xl[i] + yl[i]; return a; };
+    vector<Strategy> strategies = {
+        {"gf2 mul (log/exp tables)", [&](size_t i0, size_t n) { uint32_t a = 0; for(size_t i = i0; i < i0 + n; i++) a += gf2.mul(x8[i], y8[i]); return a; }, touch8},
+        {"gf2 slowMul (shift and add)", [&](size_t i0, size_t n) { uint32_t a = 0; for(size_t i = i0; i < i0 + n; i++) a += gf2.slowMul(x8[i], y8[i]); return a; }, touch8},
+        {"gf2 mulRegions (SIMD kernel)", [&](size_t i0, size_t n) { gf2.mulRegions(&x8[i0], &y8[i0], &out8[i0], n); return (uint32_t)out8[i0]; }, touch8},
+        {"gf(257) mul (log/exp tables)", [&](size_t i0, size_t n) { uint32_t a = 0; for(size_t i = i0; i < i0 + n; i++) a += gfSmall.mul(xs[i], ys[i]); return a; }, touchS},
+        {"gf(257) slowMul (modulo)", [&](size_t i0, size_t n) { uint32_t a = 0; for(size_t i = i0; i < i0 + n; i++) a += gfSmall.slowMul(xs[i], ys[i]); return a; }, touchS},
+        {"gf(65521) mul (log/exp tables)", [&](size_t i0, size_t n) { uint32_t a = 0; for(size_t i = i0; i < i0 + n; i++) a += gfLarge.mul(xl[i], yl[i]); return a; }, touchL},
+        {"gf(65521) slowMul (modulo)", [&](size_t i0, size_t n) { uint32_t a = 0; for(size_t i = i0; i < i0 + n; i++) a += gfLarge.slowMul(xl[i], yl[i]); return a; }, touchL},
+    };
+
+    if(batch == 0)
+        batch = 1;
+    if(batch > count)
+        batch = count;
+    vector<uint8_t> evictBuf(evictBytes);
+
+    //nanoseconds per operation, optionally with eviction before every batch
+    //the whole loop is timed in thread CPU time when not evicting, so that a time-sliced co-runner is not counted
+    auto measure = [&](Strategy &st, bool flush)
+    {
+        double busy = 0.0;
+        size_t ops = 0, i0 = 0;
+        double t = now();
+        double cpu = threadTime();
+        do
+        {
+            if(flush)
+            {
+                evict(evictBuf);
+                sink += st.touch(i0, batch);
+                double s = now();
+                sink += st.run(i0, batch);
+                busy += now() - s;
+            }
+            else
+                sink += st.run(i0, batch);
+            ops += batch;
+            i0 = (i0 + batch) % (count - batch + 1);
+        } while((now() - t) < 0.3);
+        if(!flush)
+            busy = threadTime() - cpu;
+        return busy / ops * 1e9;
+    };
+
+    cout << "cache pressure: " << batch << " ops per batch, " << (evictBytes >> 10) << " KiB eviction, "
+         << (corunBytes >> 10) << " KiB co-runner" << endl;
+    vector<double> warm, flushed, corun;
+    for(auto &st : strategies)
+    {
+        warm.push_back(measure(st, false));
+        flushed.push_back(measure(st, true));
+    }
+
+    //co-runner shares the last level cache on multicore machines, and all of them when time-sliced on one core
+    atomic<bool> stop(false);
+    thread corunner([&]()
+    {
+        vector<uint8_t> buf(corunBytes);
+        while(!stop.load(memory_order_relaxed))
+            evict(buf);
+    });
+    for(auto &st : strategies)
+        corun.push_back(measure(st, false));
+    stop = true;
+    corunner.join();
+
+    for(size_t i = 0; i < strategies.size(); i++)
+    {
+        cout << "  " << strategies[i].name << ": warm " << warm[i] << " ns/op, evicted " << flushed[i]
+             << " ns/op (" << flushed[i] / warm[i] << "x), co-runner " << corun[i] << " ns/op (" << corun[i] / warm[i] << "x)" << endl;
+    }
+}
+
+/**
+ * @brief Measure polynomial ring operations
+ * @param q Modulus
+ * @param n Ring degree
+ */
+template <class T> static void benchRing(uint32_t q, uint16_t n)
+{
+    GFRing ring(q, n);
+    if(ring.isInitialized())
+        return;
+    vector<T> a(n), b(n), r(n);
+    for(uint16_t i = 0; i < n; i++)
+    {
+        a[i] = (T)(rand() % q);
+        b[i] = (T)(rand() % q);
+    }
+    if(ring.ntt(a.data()))
+        return; //coefficient width not supported
+
+    auto measure = [](function<void(void)> op)
+    {
+        size_t count = 0;
+        double start = now();
+        double elapsed;
+        do
+        {
+            for(uint8_t i = 0; i < 100; i++)
+                op();
+            count += 100;
+            elapsed = now() - start;
+        }
+        while(elapsed < 0.5);
+        return elapsed * 1e9 / count;
+    };
+    double ntt = measure([&]() {ring.ntt(a.data());});
+    double inv = measure([&]() {ring.invNtt(a.data());});
+    double base = measure([&]() {ring.basemul(a.data(), b.data(), r.data());});
+    double mul = measure([&]() {ring.mul(a.data(), b.data(), r.data());});
+    double slow = measure([&]() {ring.slowMul(a.data(), b.data(), r.data());});
+
+    cout << "ring Z_" << q << "[x]/(x^" << n << "+1), " << sizeof(T) * 8 << "-bit, " << (ring.isComplete() ? "complete" : "incomplete")
+         << " NTT: ntt " << ntt << " ns, invNtt " << inv << " ns, basemul " << base << " ns, mul " << mul << " ns, slowMul " << slow << " ns" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    const char *mode = (argc > 1) ? argv[1] : "all";
+    bool all = !strcmp(mode, "all");
+
+    if(all || !strcmp(mode, "repair"))
+    {
+        benchRepair(6, 3, 1 << 20);
+        benchRepair(10, 4, 1 << 20);
+        benchRepair(12, 4, 1 << 20);
+    }
+    if(all || !strcmp(mode, "partial"))
+    {
+        benchPartial(10, 4, 1, 1 << 22, 1 << 16);
+        benchPartial(10, 4, 2, 1 << 22, 1 << 16);
+        benchPartial(6, 3, 1, 1 << 22, 1 << 14);
+    }
+    if(all || !strcmp(mode, "rs"))
+    {
+        benchDecode(255, 32, 10000);
+        benchDecode(204, 16, 10000);
+        benchDecode(64, 8, 10000);
+    }
+    if(all || !strcmp(mode, "sim"))
+    {
+        benchSim(255, 32, 0.004);
+        benchSim(255, 32, 0.005);
+        benchSim(204, 16, 0.002);
+    }
+    if(all || !strcmp(mode, "cache"))
+    {
+        benchCache(4, 2, 8, 2000, 1 << 16);
+        benchCache(8, 3, 12, 2000, 1 << 16);
+        benchCache(1, 2, 8, 2000, 1 << 16);
+    }
+    if(all || !strcmp(mode, "pressure"))
+    {
+        //optional arguments: operations per batch, eviction buffer KiB, co-runner buffer KiB
+        size_t batch = (!all && (argc > 2)) ? strtoul(argv[2], nullptr, 0) : 256;
+        size_t evictKiB = (!all && (argc > 3)) ? strtoul(argv[3], nullptr, 0) : 8192;
+        size_t corunKiB = (!all && (argc > 4)) ? strtoul(argv[4], nullptr, 0) : 8192;
+        benchPressure(batch, evictKiB << 10, corunKiB << 10);
+    }
+    if(all || !strcmp(mode, "ring"))
+    {
+        benchRing<int16_t>(3329, 256);
+        benchRing<int32_t>(3329, 256);
+        benchRing<int32_t>(8380417, 256);
+    }
     return 0;
 }
@@ -0,0 +1,588 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file rebuild.cpp
+* @brief Asynchronous rebuild of erasure coded shard files
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "rebuild.h"
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <chrono>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#define REBUILD_URING
+#endif
+#endif
+
+#ifndef O_DIRECT
+#define O_DIRECT 0
+#endif
+
+/**
+ * @brief Open files and buffers shared by both I/O engines
+ */
+struct RebuildJob
+{
+    std::vector<int> in; //helper file descriptors
+    std::vector<int> out; //output file descriptors
+    std::vector<uint8_t> tables; //region tables, helpers x 32 bytes for every wanted shard
+    uint64_t length; //shard length
+    size_t chunk; //chunk size
+    uint16_t depth; //number of chunk slots
+    uint8_t *arena; //aligned buffers, (helpers + wanted) chunks per slot
+    RebuildStats *stats; //statistics
+    uint64_t depthSum; //sum of queue depth samples
+    uint64_t depthSamples; //number of queue depth samples
+    bool busy; //arena may still be accessed by the kernel, so it must not be freed
+};
+
+/**
+ * @brief Round up to the direct I/O alignment
+ * @param x Value
+ * @return Aligned value
+ */
+static inline uint64_t alignUp(uint64_t x)
+{
+    return (x + REBUILD_ALIGN - 1) & ~(uint64_t)(REBUILD_ALIGN - 1);
+}
+
+/**
+ * @brief Decode one chunk
+ * @param &job Job description
+ * @param *slot Slot buffers
+ * @param len Chunk length in bytes
+ */
+static void decodeChunk(RebuildJob &job, uint8_t *slot, size_t len)
+{
+    uint16_t h = (uint16_t)job.in.size();
+    std::vector<const uint8_t*> src(h);
+    for(uint16_t j = 0; j < h; j++)
+        src[j] = slot + j * job.chunk;
+    for(size_t i = 0; i < job.out.size(); i++)
+        GF2::dotRegion(&job.tables[i * h * 32], src.data(), h, slot + (h + i) * job.chunk, len);
+}
+
+/**
+ * @brief Rebuild using synchronous reads and writes
+ * @param &job Job description
+ * @return 0 on success, 2 on I/O error
+ */
+static uint8_t runSync(RebuildJob &job)
+{
+    uint16_t h = (uint16_t)job.in.size();
+    uint8_t *slot = job.arena;
+    for(uint64_t offset = 0; offset < job.length; offset += job.chunk)
+    {
+        size_t len = ((job.length - offset) < job.chunk) ? (size_t)(job.length - offset) : job.chunk;
+        size_t alen = (size_t)alignUp(len);
+        for(uint16_t j = 0; j < h; j++)
+        {
+            size_t done = 0;
+            while(done < len)
+            {
+                ssize_t r = pread(job.in[j], slot + j * job.chunk + done, alen - done, offset + done);
+                if((r < 0) && (errno == EINTR))
+                    continue;
+                if(r <= 0)
+                    return 2; //error or file too short
+                done += r;
+            }
+            job.stats->bytesRead += len;
+        }
+        job.depthSum++;
+        job.depthSamples++;
+        decodeChunk(job, slot, len);
+        for(size_t i = 0; i < job.out.size(); i++)
+        {
+            size_t done = 0;
+            while(done < alen)
+            {
+                ssize_t r = pwrite(job.out[i], slot + (h + i) * job.chunk + done, alen - done, offset + done);
+                if((r < 0) && (errno == EINTR))
+                    continue;
+                if(r <= 0)
+                    return 2;
+                done += r;
+            }
+            job.stats->bytesWritten += len;
+        }
+    }
+    job.stats->maxDepth = 1;
+    job.stats->engine = REBUILD_SYNC;
+    return 0;
+}
+
+#ifdef REBUILD_URING
+
+/**
+ * @brief Minimal io_uring wrapper using raw system calls
+ */
+class Ring
+{
+public:
+    unsigned entries = 0; //submission queue size
+    unsigned toSubmit = 0; //queued, but not yet submitted entries
+
+    /**
+     * @brief Set up ring
+     * @param n Requested number of entries
+     * @return 0 on success
+     */
+    int setup(unsigned n)
+    {
+        struct io_uring_params p;
+        memset(&p, 0, sizeof(p));
+        fd = (int)syscall(__NR_io_uring_setup, n, &p);
+        if(fd < 0)
+            return -1;
+        entries = p.sq_entries;
+        sqSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cqSize = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+        bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if(single)
+            sqSize = cqSize = (sqSize > cqSize) ? sqSize : cqSize;
+        sqPtr = mmap(nullptr, sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if(sqPtr == MAP_FAILED)
+            return -1;
+        cqPtr = single ? sqPtr : mmap(nullptr, cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if(cqPtr == MAP_FAILED)
+            return -1;
+        sqeSize = p.sq_entries * sizeof(struct io_uring_sqe);
+        sqes = (struct io_uring_sqe*)mmap(nullptr, sqeSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if(sqes == MAP_FAILED)
+            return -1;
+
+        uint8_t *sq = (uint8_t*)sqPtr, *cq = (uint8_t*)cqPtr;
+        sqHead = (unsigned*)(sq + p.sq_off.head);
+        sqTail = (unsigned*)(sq + p.sq_off.tail);
+        sqMask = *(unsigned*)(sq + p.sq_off.ring_mask);
+        sqArray = (unsigned*)(sq + p.sq_off.array);
+        cqHead = (unsigned*)(cq + p.cq_off.head);
+        cqTail = (unsigned*)(cq + p.cq_off.tail);
+        cqMask = *(unsigned*)(cq + p.cq_off.ring_mask);
+        cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+        return 0;
+    }
+
+    /**
+     * @brief Register single fixed buffer
+     * @param *buf Buffer
+     * @param len Buffer length
+     * @return 0 on success
+     */
+    int registerBuffer(void *buf, size_t len)
+    {
+        struct iovec iov;
+        iov.iov_base = buf;
+        iov.iov_len = len;
+        return (int)syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, &iov, 1);
+    }
+
+    /**
+     * @brief Queue read or write
+     * @param opcode IORING_OP_READ(_FIXED) or IORING_OP_WRITE(_FIXED)
+     * @param file File descriptor
+     * @param *buf Buffer
+     * @param len Length
+     * @param offset File offset
+     * @param userData User data returned in completion
+     */
+    void queue(uint8_t opcode, int file, void *buf, unsigned len, uint64_t offset, uint64_t userData)
+    {
+        unsigned tail = *sqTail;
+        unsigned i = tail & sqMask;
+        struct io_uring_sqe *sqe = &sqes[i];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = opcode;
+        sqe->fd = file;
+        sqe->addr = (uint64_t)(uintptr_t)buf;
+        sqe->len = len;
+        sqe->off = offset;
+        sqe->buf_index = 0;
+        sqe->user_data = userData;
+        sqArray[i] = i;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        toSubmit++;
+    }
+
+    /**
+     * @brief Submit queued entries and wait for completions
+     * @param wait Minimum number of completions to wait for
+     * @return 0 on success
+     */
+    int enter(unsigned wait)
+    {
+        while(true)
+        {
+            int r = (int)syscall(__NR_io_uring_enter, fd, toSubmit, wait, wait ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+            if(r >= 0)
+            {
+                toSubmit -= r;
+                return 0;
+            }
+            if((errno != EINTR) && (errno != EAGAIN) && (errno != EBUSY))
+                return -1;
+        }
+    }
+
+    /**
+     * @brief Wait for completions without submitting queued entries
+     * @param count Number of submitted requests still in flight
+     * @return 0 when all of them have completed
+     * Completions are discarded, this is only used to make sure that the kernel no longer accesses the buffers.
+     */
+    int drain(uint64_t count)
+    {
+        while(count)
+        {
+            int r = (int)syscall(__NR_io_uring_enter, fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if((r < 0) && (errno != EINTR) && (errno != EAGAIN) && (errno != EBUSY))
+                return -1;
+            uint64_t userData;
+            int32_t res;
+            while(count && reap(userData, res))
+                count--;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Get next completion
+     * @param &userData Output user data
+     * @param &res Output result
+     * @return true if there was a completion
+     */
+    bool reap(uint64_t &userData, int32_t &res)
+    {
+        unsigned head = *cqHead;
+        if(head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE))
+            return false;
+        struct io_uring_cqe *cqe = &cqes[head & cqMask];
+        userData = cqe->user_data;
+        res = cqe->res;
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    ~Ring()
+    {
+        if(sqes && (sqes != MAP_FAILED))
+            munmap(sqes, sqeSize);
+        if(cqPtr && (cqPtr != MAP_FAILED) && (cqPtr != sqPtr))
+            munmap(cqPtr, cqSize);
+        if(sqPtr && (sqPtr != MAP_FAILED))
+            munmap(sqPtr, sqSize);
+        if(fd >= 0)
+            close(fd);
+    }
+
+private:
+    int fd = -1; //ring file descriptor
+    void *sqPtr = nullptr, *cqPtr = nullptr; //ring mappings
+    size_t sqSize = 0, cqSize = 0, sqeSize = 0; //mapping sizes
+    struct io_uring_sqe *sqes = nullptr; //submission queue entries
+    struct io_uring_cqe *cqes = nullptr; //completion queue entries
+    unsigned *sqHead = nullptr, *sqTail = nullptr, *sqArray = nullptr, *cqHead = nullptr, *cqTail = nullptr;
+    unsigned sqMask = 0, cqMask = 0;
+};
+
+#define SLOT_FREE 0
+#define SLOT_READING 1
+#define SLOT_WRITING 2
+
+/**
+ * @brief Rebuild using io_uring
+ * @param &job Job description
+ * @return 0 on success, 2 on I/O error, 3 if io_uring is not available
+ */
+static uint8_t runUring(RebuildJob &job)
+{
+    uint16_t h = (uint16_t)job.in.size();
+    uint16_t w = (uint16_t)job.out.size();
+    uint16_t perSlot = (h > w) ? h : w;
+
+    //older kernels refuse rings bigger than REBUILD_MAX_OPS, so fewer chunks are kept in flight instead
+    uint16_t depth = job.depth;
+    if(((unsigned)depth * perSlot) > REBUILD_MAX_OPS)
+        depth = REBUILD_MAX_OPS / perSlot;
+    Ring ring;
+    if(ring.setup(depth * perSlot))
+        return 3;
+    //the completion queue is twice as big, so it never overflows as long as the submission queue is not exceeded
+    if(((unsigned)depth * perSlot) > ring.entries)
+        depth = ring.entries / perSlot;
+    bool fixed = !ring.registerBuffer(job.arena, (size_t)job.depth * (h + w) * job.chunk);
+
+    size_t slotSize = (size_t)(h + w) * job.chunk;
+    std::vector<uint8_t> state(depth, SLOT_FREE);
+    std::vector<uint16_t> pending(depth, 0);
+    std::vector<uint64_t> offset(depth, 0);
+    uint64_t next = 0, inFlight = 0;
+    uint8_t err = 0;
+
+    while(true)
+    {
+        //start reading the next chunks into free slots
+        for(uint16_t s = 0; (s < depth) && !err && (next < job.length); s++)
+        {
+            if(state[s] != SLOT_FREE)
+                continue;
+            size_t len = ((job.length - next) < job.chunk) ? (size_t)(job.length - next) : job.chunk;
+            for(uint16_t j = 0; j < h; j++)
+            {
+                ring.queue(fixed ? IORING_OP_READ_FIXED : IORING_OP_READ, job.in[j], job.arena + s * slotSize + j * job.chunk,
+                    (unsigned)alignUp(len), next, (uint64_t)s << 16 | j);
+            }
+            state[s] = SLOT_READING;
+            pending[s] = h;
+            offset[s] = next;
+            inFlight += h;
+            next += len;
+        }
+        if(inFlight == 0)
+            break;
+
+        job.depthSum += inFlight;
+        job.depthSamples++;
+        if(inFlight > job.stats->maxDepth)
+            job.stats->maxDepth = (uint32_t)inFlight;
+        if(ring.enter(1))
+        {
+            err = 2;
+            //requests that have already been submitted may still read into or write from the arena,
+            //closing the ring cancels them asynchronously, so wait for them and keep the arena if that fails too
+            if(ring.drain(inFlight - ring.toSubmit))
+                job.busy = true;
+            break;
+        }
+
+        uint64_t userData;
+        int32_t res;
+        while(ring.reap(userData, res))
+        {
+            uint16_t s = (uint16_t)(userData >> 16);
+            inFlight--;
+            size_t len = ((job.length - offset[s]) < job.chunk) ? (size_t)(job.length - offset[s]) : job.chunk;
+            //short reads can only happen at the end of a file that is too short
+            //short writes (e.g. out of space) would leave a hole that ftruncate() silently fills with zeros
+            if((res < 0) || ((state[s] == SLOT_READING) && ((size_t)res < len)) || ((state[s] == SLOT_WRITING) && ((size_t)res < alignUp(len))))
+                err = 2;
+            else if(state[s] == SLOT_READING)
+                job.stats->bytesRead += len;
+            else
+                job.stats->bytesWritten += len;
+
+            if(--pending[s])
+                continue;
+            if((state[s] == SLOT_READING) && !err)
+            {
+                //all reads of this chunk are complete, decode and write it back while other chunks are still being read
+                uint8_t *slot = job.arena + s * slotSize;
+                decodeChunk(job, slot, len);
+                for(uint16_t i = 0; i < w; i++)
+                {
+                    ring.queue(fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE, job.out[i], slot + (h + i) * job.chunk,
+                        (unsigned)alignUp(len), offset[s], (uint64_t)s << 16 | i);
+                }
+                state[s] = SLOT_WRITING;
+                pending[s] = w;
+                inFlight += w;
+            }
+            else
+                state[s] = SLOT_FREE;
+        }
+    }
+    job.stats->engine = REBUILD_IO_URING;
+    return err;
+}
+
+#endif
+
+/**
+ * @brief Rebuild shard files
+ * @param **paths Paths of all k+m shard files, nullptr for lost shards
+ * @param *wanted Indexes of shards to be rebuilt
+ * @param count Number of wanted shards
+ * @param **outPaths Output file paths for wanted shards, created or truncated
+ * @param *stats Output statistics, may be nullptr
+ * @return 0 on success, 1 if there are less than k shards available or parameters are wrong, 2 on I/O error
+ */
+uint8_t Rebuild::run(const char * const *paths, const uint8_t *wanted, uint8_t count, const char * const *outPaths, RebuildStats *stats)
+{
+    RebuildStats localStats;
+    if(stats == nullptr)
+        stats = &localStats;
+    memset(stats, 0, sizeof(*stats));
+    if((chunk == 0) || (count == 0))
+        return 1;
+
+    //wanted shards are always rebuilt, even if they are given
+    uint16_t n = code.getDataShards() + code.getParityShards();
+    std::vector<uint8_t> present(n);
+    for(uint16_t i = 0; i < n; i++)
+        present[i] = (paths[i] != nullptr);
+    for(uint8_t i = 0; i < count; i++)
+    {
+        if(wanted[i] >= n)
+            return 1;
+        present[wanted[i]] = 0;
+    }
+    std::vector<ECHelper> helpers;
+    if(code.repairHelpers(present.data(), wanted, count, helpers) || helpers.empty())
+        return 1;
+
+    RebuildJob job;
+    uint16_t h = (uint16_t)helpers.size();
+    job.tables.resize((size_t)count * h * 32);
+    for(uint8_t i = 0; i < count; i++)
+    {
+        for(uint16_t j = 0; j < h; j++)
+            memcpy(&job.tables[(i * h + j) * 32], &helpers[j].tables[i * 32], 32);
+    }
+    job.chunk = chunk;
+    job.depth = depth;
+    job.stats = stats;
+    job.depthSum = 0;
+    job.depthSamples = 0;
+    job.arena = nullptr;
+    job.busy = false;
+    stats->direct = 1;
+
+    auto start = std::chrono::steady_clock::now();
+    uint8_t ret = 0;
+    //O_DIRECT is not supported by every filesystem, fall back to buffered I/O then
+    for(uint16_t j = 0; (j < h) && !ret; j++)
+    {
+        int fd = open(paths[helpers[j].shard], O_RDONLY | O_DIRECT);
+        if((fd < 0) && (errno == EINVAL))
+        {
+            fd = open(paths[helpers[j].shard], O_RDONLY);
+            stats->direct = 0;
+        }
+        if(fd < 0)
+            ret = 2;
+        else
+            job.in.push_back(fd);
+    }
+    for(uint8_t i = 0; (i < count) && !ret; i++)
+    {
+        int fd = open(outPaths[i], O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+        if((fd < 0) && (errno == EINVAL))
+        {
+            fd = open(outPaths[i], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            stats->direct = 0;
+        }
+        if(fd < 0)
+            ret = 2;
+        else
+            job.out.push_back(fd);
+    }
+
+    struct stat st;
+    if(!ret && fstat(job.in[0], &st))
+        ret = 2;
+    if(!ret)
+    {
+        job.length = (uint64_t)st.st_size;
+        if(posix_memalign((void**)&job.arena, REBUILD_ALIGN, (size_t)depth * (h + count) * chunk))
+        {
+            job.arena = nullptr;
+            ret = 2;
+        }
+    }
+
+    if(!ret)
+    {
+        ret = 3;
+#ifdef REBUILD_URING
+        if(engine == REBUILD_IO_URING)
+            ret = runUring(job);
+#endif
+        if(ret == 3)
+            ret = runSync(job);
+    }
+
+    //writes are padded to the alignment, so cut the files to the shard length
+    for(size_t i = 0; i < job.out.size(); i++)
+    {
+        if(!ret && (ftruncate(job.out[i], job.length) || fdatasync(job.out[i])))
+            ret = 2;
+        close(job.out[i]);
+    }
+    for(size_t j = 0; j < job.in.size(); j++)
+        close(job.in[j]);
+    if(!job.busy)
+        free(job.arena); //otherwise deliberately leaked, as the kernel may still access it
+
+    stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(stats->seconds > 0.0)
+    {
+        stats->readRate = stats->bytesRead / stats->seconds / 1e6;
+        stats->writeRate = stats->bytesWritten / stats->seconds / 1e6;
+    }
+    if(job.depthSamples)
+        stats->avgDepth = (double)job.depthSum / job.depthSamples;
+    return ret;
+}
+
+/**
+ * @brief Select I/O engine
+ * @param engine REBUILD_IO_URING (default, falls back to synchronous if not available) or REBUILD_SYNC
+ */
+void Rebuild::setEngine(uint8_t engine)
+{
+    this->engine = engine;
+}
+
+/**
+ * @brief Check if object is initialized
+ * @return 0 if initialized
+ */
+uint8_t Rebuild::isInitialized(void)
+{
+    return (chunk == 0);
+}
+
+/**
+ * @brief Initializes rebuild engine
+ * @param &code Erasure code object, copied
+ * @param chunk Chunk size in bytes, must be a multiple of REBUILD_ALIGN
+ * @param depth Number of chunks in flight, limited so that at most REBUILD_MAX_OPS operations are queued with io_uring
+ */
+Rebuild::Rebuild(const ErasureCode &code, size_t chunk, uint16_t depth) : code(code)
+{
+    this->chunk = 0;
+    this->depth = depth;
+    engine = REBUILD_IO_URING;
+    if((chunk == 0) || (chunk % REBUILD_ALIGN) || (chunk > ((size_t)1 << 30)) || (depth == 0) || this->code.isInitialized())
+        return;
+    this->chunk = chunk;
+}
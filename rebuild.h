@@ -0,0 +1,110 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file rebuild.h
+* @brief Asynchronous rebuild of erasure coded shard files
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef REBUILD_H
+#define REBUILD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "ec.h"
+
+#define REBUILD_ALIGN 4096 //buffer, offset and length alignment required by direct I/O
+#define REBUILD_CHUNK (1 << 20) //default chunk size
+#define REBUILD_DEPTH 16 //default number of chunks in flight
+#define REBUILD_MAX_OPS 4096 //maximum number of operations in flight
+
+#define REBUILD_SYNC 0 //synchronous pread/pwrite engine
+#define REBUILD_IO_URING 1 //io_uring engine
+
+/**
+ * @brief Rebuild statistics
+ */
+struct RebuildStats
+{
+	uint64_t bytesRead; //bytes read from surviving shards
+	uint64_t bytesWritten; //bytes written to rebuilt shards
+	double seconds; //total time
+	double readRate; //read throughput in MB/s
+	double writeRate; //write throughput in MB/s
+	double avgDepth; //average number of I/O operations in flight
+	uint32_t maxDepth; //maximum number of I/O operations in flight
+	uint8_t engine; //REBUILD_IO_URING or REBUILD_SYNC
+	uint8_t direct; //non-zero if all files were opened with O_DIRECT
+};
+
+/**
+ * @brief This class provides rebuilding of lost shard files from the surviving ones
+ *
+ * Shard files are processed in chunks. Up to depth chunks are in flight at once: reads from all helper shards
+ * are queued together, a chunk is decoded with GF2::dotRegion() as soon as its last read completes and the rebuilt
+ * chunks are written back asynchronously while the next reads are already running.
+ * I/O goes through io_uring (raw system calls, no liburing needed) with O_DIRECT and a registered buffer arena.
+ * Filesystems without O_DIRECT support are accessed through the page cache, and if io_uring is not available
+ * a synchronous engine is used instead.
+ */
+class Rebuild
+{
+public:
+	/**
+	 * @brief Rebuild shard files
+	 * @param **paths Paths of all k+m shard files, nullptr for lost shards
+	 * @param *wanted Indexes of shards to be rebuilt
+	 * @param count Number of wanted shards
+	 * @param **outPaths Output file paths for wanted shards, created or truncated
+	 * @param *stats Output statistics, may be nullptr
+	 * @return 0 on success, 1 if there are less than k shards available or parameters are wrong, 2 on I/O error
+	 * All shard files must have the same length.
+	 */
+	uint8_t run(const char * const *paths, const uint8_t *wanted, uint8_t count, const char * const *outPaths, RebuildStats *stats = nullptr);
+
+	/**
+	 * @brief Select I/O engine
+	 * @param engine REBUILD_IO_URING (default, falls back to synchronous if not available) or REBUILD_SYNC
+	 */
+	void setEngine(uint8_t engine);
+
+	/**
+	 * @brief Check if object is initialized
+	 * @return 0 if initialized
+	 */
+	uint8_t isInitialized(void);
+
+	/**
+	 * @brief Initializes rebuild engine
+	 * @param &code Erasure code object, copied
+	 * @param chunk Chunk size in bytes, must be a multiple of REBUILD_ALIGN
+	 * @param depth Number of chunks in flight, limited so that at most REBUILD_MAX_OPS operations are queued with io_uring
+	 */
+	Rebuild(const ErasureCode &code, size_t chunk = REBUILD_CHUNK, uint16_t depth = REBUILD_DEPTH);
+
+private:
+	ErasureCode code; //erasure code
+	size_t chunk; //chunk size, 0 if not initialized
+	uint16_t depth; //number of chunks in flight
+	uint8_t engine; //preferred I/O engine
+};
+
+#endif
@@ -0,0 +1,496 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file rs.cpp
+* @brief Reed-Solomon error correcting code over GF(2^8)
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "rs.h"
+#include "transpose.h"
+#include <string.h>
+#include <type_traits>
+
+/**
+ * @brief Standard code parameters
+ */
+static const struct
+{
+    uint16_t poly; //field polynomial
+    uint8_t n; //default codeword length
+    uint8_t nroots; //default number of parity symbols
+    uint8_t fcr; //first consecutive root
+    uint8_t prim; //root step
+    bool dual; //dual basis symbols
+} rsProfiles[RS_PROFILES] =
+{
+    {0x187, 255, 32, 112, 11, true}, //CCSDS 131.0-B
+    {0x11d, 204, 16, 0, 1, false}, //ETSI EN 300 421
+    {0x11d, 26, 7, 0, 1, false}, //ISO/IEC 18004
+    {0x11d, 32, 4, 0, 1, false}, //IEC 60908
+    {0x11d, 28, 4, 0, 1, false}, //IEC 60908
+};
+
+//a polynomial-first call such as ReedSolomon(0x187, 255, 32) must not silently resolve to the profile constructor
+static_assert(!std::is_constructible<ReedSolomon, uint16_t, uint8_t, uint8_t>::value, "polynomial taken for a profile");
+static_assert(!std::is_constructible<ReedSolomon, int, int, int>::value, "integer taken for a profile");
+static_assert(!std::is_convertible<uint16_t, GF2>::value, "implicit polynomial to field conversion");
+static_assert(std::is_constructible<ReedSolomon, RSProfile, uint8_t, uint8_t>::value, "profile constructor");
+static_assert(std::is_constructible<ReedSolomon, GF2, uint8_t, uint8_t>::value, "field constructor");
+
+//CCSDS dual basis: rows of the conventional to dual basis conversion matrix, the most significant bit first
+static const uint8_t ccsdsDual[8] = {0x8d, 0xef, 0xec, 0x86, 0xfa, 0x99, 0xaf, 0x7b};
+
+/**
+ * @brief Calculate parity
+ * @param *data n-nroots data bytes
+ * @param *parity Output nroots parity bytes
+ */
+void ReedSolomon::encode(const uint8_t *data, uint8_t *parity)
+{
+    if(n == 0)
+        return;
+
+    uint8_t k = n - nroots;
+    uint8_t buf[256];
+    if(dual)
+    {
+        fromDual(data, buf, k);
+        data = buf;
+    }
+
+    //parity is the remainder of data*x^nroots divided by the generator polynomial, parity[0] is the highest degree
+    //the feedback products for the whole register are precomputed, so every step is a shift and XOR of a table row
+    uint8_t r[256];
+    memset(r, 0, nroots);
+    for(uint8_t i = 0; i < k; i++)
+    {
+        const uint8_t *row = &feedback[(data[i] ^ r[0]) * nroots];
+        for(uint8_t j = 0; j < (nroots - 1); j++)
+            r[j] = r[j + 1] ^ row[j];
+        r[nroots - 1] = row[nroots - 1];
+    }
+
+    if(dual)
+        toDual(r, parity, nroots);
+    else
+        memcpy(parity, r, nroots);
+}
+
+/**
+ * @brief Correct errors in a codeword
+ * @param *codeword n bytes, corrected in place
+ * @return Number of corrected symbols or RS_UNCORRECTABLE
+ */
+int16_t ReedSolomon::decode(uint8_t *codeword)
+{
+    if(n == 0)
+        return RS_UNCORRECTABLE;
+    if(!dual)
+        return decodeConventional(codeword);
+
+    uint8_t buf[256];
+    fromDual(codeword, buf, n);
+    int16_t r = decodeConventional(buf);
+    if(r > 0)
+        toDual(buf, codeword, n);
+    return r;
+}
+
+/**
+ * @brief Decode codeword in conventional basis
+ * @param *codeword n bytes, corrected in place
+ * @return Number of corrected symbols or RS_UNCORRECTABLE
+ */
+int16_t ReedSolomon::decodeConventional(uint8_t *codeword)
+{
+    //S_j = c(alpha^(prim*(fcr+j))), Horner's scheme
+    uint8_t s[256];
+    for(uint8_t j = 0; j < nroots; j++)
+    {
+        uint8_t root = alphaTo[(prim * (fcr + j)) % 255];
+        uint8_t acc = 0;
+        for(uint8_t i = 0; i < n; i++)
+            acc = gf.mul(acc, root) ^ codeword[i];
+        s[j] = acc;
+    }
+    return correct(codeword, s);
+}
+
+/**
+ * @brief Correct errors in many codewords
+ * @param *codewords count codewords, n bytes each, corrected in place
+ * @param count Number of codewords
+ * @param *result Output number of corrected symbols or RS_UNCORRECTABLE for every codeword, may be nullptr
+ * @return Number of uncorrectable codewords
+ */
+size_t ReedSolomon::decodeBatch(uint8_t *codewords, size_t count, int16_t *result)
+{
+    if(n == 0)
+    {
+        for(size_t i = 0; (result != nullptr) && (i < count); i++)
+            result[i] = RS_UNCORRECTABLE;
+        return count;
+    }
+
+    size_t failed = 0;
+    std::vector<uint8_t> soa(n * RS_BATCH, 0); //symbol i of codeword b is soa[i*RS_BATCH + b]
+    std::vector<uint8_t> syn(nroots * RS_BATCH);
+    uint8_t s[256];
+    for(size_t b = 0; b < count; b += RS_BATCH)
+    {
+        size_t used = ((count - b) < RS_BATCH) ? (count - b) : RS_BATCH;
+        uint8_t *c = codewords + b * n;
+        if(dual)
+            fromDual(c, c, used * n);
+        Transpose::bytes(c, n, soa.data(), RS_BATCH, used, n);
+        for(uint8_t j = 0; j < nroots; j++)
+            GF2::evalRegion(&roots[j * 32], soa.data(), RS_BATCH, n, &syn[j * RS_BATCH], RS_BATCH);
+
+        for(size_t l = 0; l < used; l++)
+        {
+            uint8_t any = 0;
+            for(uint8_t j = 0; j < nroots; j++)
+            {
+                s[j] = syn[j * RS_BATCH + l];
+                any |= s[j];
+            }
+            int16_t r = any ? correct(c + l * n, s) : 0;
+            if(r == RS_UNCORRECTABLE)
+                failed++;
+            if(result != nullptr)
+                result[b + l] = r;
+        }
+        if(dual)
+            toDual(c, c, used * n);
+    }
+    return failed;
+}
+
+/**
+ * @brief Correct codeword with given syndromes
+ * @param *codeword Codeword
+ * @param *s nroots syndromes
+ * @return Number of corrected symbols or RS_UNCORRECTABLE
+ */
+int16_t ReedSolomon::correct(uint8_t *codeword, const uint8_t *s)
+{
+    uint8_t any = 0;
+    for(uint8_t j = 0; j < nroots; j++)
+        any |= s[j];
+    if(any == 0)
+        return 0; //clean codeword
+
+    int16_t r = correctSingle(codeword, s);
+    if(r)
+        return r;
+    return correctGeneral(codeword, s);
+}
+
+/**
+ * @brief Correct single error in closed form
+ * @param *codeword Codeword
+ * @param *s nroots non-zero syndromes
+ * @return 1 if a single error was corrected, 0 if syndromes do not match a single error
+ */
+int16_t ReedSolomon::correctSingle(uint8_t *codeword, const uint8_t *s)
+{
+    //single error of value Y at locator X gives S_j = Y*X^(fcr+j), so S_(j+1) = X*S_j
+    if(s[0] == 0)
+        return 0;
+    uint8_t x = gf.div(s[1], s[0]);
+    if(x == 0)
+        return 0;
+    for(uint8_t j = 1; j < (nroots - 1); j++)
+    {
+        if(s[j + 1] != gf.mul(s[j], x))
+            return 0;
+    }
+    //X = alpha^(prim*position), where position is the power of x
+    uint16_t position = (uint16_t)(((uint32_t)indexOf[x] * iprim) % 255);
+    if(position >= n)
+        return 0; //error in the shortened part, not a single error
+    uint8_t y = gf.div(s[0], alphaTo[((uint32_t)indexOf[x] * fcr) % 255]);
+    codeword[n - 1 - position] ^= y;
+    return 1;
+}
+
+/**
+ * @brief Correct errors using Berlekamp-Massey algorithm, Chien search and Forney algorithm
+ * @param *codeword Codeword
+ * @param *s nroots syndromes
+ * @return Number of corrected symbols or RS_UNCORRECTABLE
+ */
+int16_t ReedSolomon::correctGeneral(uint8_t *codeword, const uint8_t *s)
+{
+    //error locator polynomial, the lowest degree first
+    uint8_t lambda[256] = {1}, b[256] = {1}, t[256];
+    uint8_t l = 0, shift = 1, lastDelta = 1;
+    for(uint8_t r = 0; r < nroots; r++)
+    {
+        uint8_t delta = s[r];
+        for(uint8_t i = 1; i <= l; i++)
+            delta ^= gf.mul(lambda[i], s[r - i]);
+        if(delta == 0)
+        {
+            shift++;
+            continue;
+        }
+        uint8_t f = gf.div(delta, lastDelta);
+        if((2 * l) <= r)
+        {
+            memcpy(t, lambda, nroots + 1);
+            for(uint16_t i = shift; i <= nroots; i++)
+                lambda[i] ^= gf.mul(f, b[i - shift]);
+            l = r + 1 - l;
+            memcpy(b, t, nroots + 1);
+            lastDelta = delta;
+            shift = 1;
+        }
+        else
+        {
+            for(uint16_t i = shift; i <= nroots; i++)
+                lambda[i] ^= gf.mul(f, b[i - shift]);
+            shift++;
+        }
+    }
+    if((2 * l) > nroots)
+        return RS_UNCORRECTABLE;
+    for(uint16_t i = l + 1; i <= nroots; i++)
+    {
+        if(lambda[i])
+            return RS_UNCORRECTABLE;
+    }
+
+    //Chien search: X^-1 is a root of lambda for every error locator X = alpha^(prim*position)
+    uint8_t loc[256], count = 0;
+    for(uint16_t position = 0; (position < n) && (count < l); position++)
+    {
+        uint8_t xInv = alphaTo[(255 - ((uint32_t)prim * position) % 255) % 255];
+        uint8_t acc = 0;
+        for(int16_t i = l; i >= 0; i--)
+            acc = gf.mul(acc, xInv) ^ lambda[i];
+        if(acc == 0)
+            loc[count++] = (uint8_t)position;
+    }
+    if(count != l)
+        return RS_UNCORRECTABLE; //not all roots are in the codeword
+
+    //error evaluator omega = S*lambda mod x^nroots
+    uint8_t omega[256];
+    for(uint8_t i = 0; i < nroots; i++)
+    {
+        uint8_t acc = 0;
+        for(uint8_t j = 0; (j <= i) && (j <= l); j++)
+            acc ^= gf.mul(lambda[j], s[i - j]);
+        omega[i] = acc;
+    }
+
+    //Forney: Y = X^(1-fcr) * omega(X^-1) / lambda'(X^-1)
+    for(uint8_t k = 0; k < count; k++)
+    {
+        uint32_t e = ((uint32_t)prim * loc[k]) % 255; //log X
+        uint8_t xInv = alphaTo[(255 - e) % 255];
+        uint8_t num = 0, den = 0;
+        for(int16_t i = nroots - 1; i >= 0; i--)
+            num = gf.mul(num, xInv) ^ omega[i];
+        //formal derivative keeps odd terms only
+        for(int16_t i = l; i >= 1; i--)
+        {
+            den = gf.mul(den, xInv);
+            if(i & 1)
+                den ^= lambda[i];
+        }
+        if(den == 0)
+            return RS_UNCORRECTABLE;
+        uint8_t scale = alphaTo[(e * (256 - (uint32_t)fcr)) % 255]; //X^(1-fcr)
+        codeword[n - 1 - loc[k]] ^= gf.mul(gf.div(num, den), scale);
+    }
+    return count;
+}
+
+/**
+ * @brief Convert symbols from conventional to dual basis
+ * @param *src Source symbols
+ * @param *dst Destination symbols, may be the same as source
+ * @param len Number of symbols
+ */
+void ReedSolomon::toDual(const uint8_t *src, uint8_t *dst, size_t len)
+{
+    if(dual)
+        GF2::dotRegion(dualTable, &src, 1, dst, len);
+    else if(src != dst)
+        memcpy(dst, src, len);
+}
+
+/**
+ * @brief Convert symbols from dual to conventional basis
+ * @param *src Source symbols
+ * @param *dst Destination symbols, may be the same as source
+ * @param len Number of symbols
+ */
+void ReedSolomon::fromDual(const uint8_t *src, uint8_t *dst, size_t len)
+{
+    if(dual)
+        GF2::dotRegion(dualTable + 32, &src, 1, dst, len);
+    else if(src != dst)
+        memcpy(dst, src, len);
+}
+
+/**
+ * @brief Get codeword length
+ * @return n
+ */
+uint8_t ReedSolomon::getLength(void)
+{
+    return n;
+}
+
+/**
+ * @brief Get number of parity symbols
+ * @return nroots
+ */
+uint8_t ReedSolomon::getParityLength(void)
+{
+    return nroots;
+}
+
+/**
+ * @brief Check if object is initialized
+ * @return 0 if initialized
+ */
+uint8_t ReedSolomon::isInitialized(void)
+{
+    if(n)
+        return 0;
+
+    return 1;
+}
+
+/**
+ * @brief Precompute tables
+ * @param n Codeword length, up to 255
+ * @param nroots Number of parity symbols, 2...n-1
+ * @param fcr First consecutive root exponent
+ * @param prim Root step exponent, coprime with 255
+ */
+void ReedSolomon::setup(uint8_t n, uint8_t nroots, uint8_t fcr, uint8_t prim)
+{
+    this->n = 0;
+    this->nroots = nroots;
+    this->fcr = fcr;
+    this->prim = prim;
+    iprim = 0;
+
+    if(gf.isInitialized() || (nroots < 2) || (nroots >= n) || ((prim % 3) == 0) || ((prim % 5) == 0) || ((prim % 17) == 0))
+        return;
+
+    //power and logarithm tables of alpha = 2
+    uint8_t x = 1;
+    for(uint16_t i = 0; i < 255; i++)
+    {
+        alphaTo[i] = x;
+        indexOf[x] = (uint8_t)i;
+        x = gf.mul(x, 2);
+    }
+    alphaTo[255] = alphaTo[0];
+    indexOf[0] = 0;
+
+    while(((uint16_t)iprim * prim) % 255 != 1)
+        iprim++;
+
+    //g(x) = product of (x - root_i)
+    generator.assign(nroots + 1, 0);
+    generator[0] = 1;
+    roots.resize(nroots * 32);
+    for(uint8_t i = 0; i < nroots; i++)
+    {
+        uint8_t root = alphaTo[((uint32_t)prim * (fcr + i)) % 255];
+        gf.regionTable(root, &roots[i * 32]);
+        for(int16_t j = i + 1; j > 0; j--)
+            generator[j] = generator[j - 1] ^ gf.mul(generator[j], root);
+        generator[0] = gf.mul(generator[0], root);
+    }
+
+    //encoder register cell j receives feedback*g_(nroots-1-j)
+    feedback.resize(256 * nroots);
+    for(uint16_t fb = 0; fb < 256; fb++)
+    {
+        for(uint8_t j = 0; j < nroots; j++)
+            feedback[fb * nroots + j] = gf.mul((uint8_t)fb, generator[nroots - 1 - j]);
+    }
+
+    this->n = n;
+}
+
+/**
+ * @brief Initializes Reed-Solomon code
+ * @param &gf GF(2^8) object, copied
+ * @param n Codeword length, up to 255
+ * @param nroots Number of parity symbols, 2...n-1
+ * @param fcr First consecutive root exponent
+ * @param prim Root step exponent, coprime with 255
+ */
+ReedSolomon::ReedSolomon(const GF2 &gf, uint8_t n, uint8_t nroots, uint8_t fcr, uint8_t prim) : gf(gf)
+{
+    dual = false;
+    setup(n, nroots, fcr, prim);
+}
+
+/**
+ * @brief Initializes Reed-Solomon code from standard profile
+ * @param id Profile (RSProfile::CCSDS, RSProfile::DVB, ...)
+ * @param n Codeword length for shortened or variable length codes, 0 for profile default
+ * @param nroots Number of parity symbols, 0 for profile default
+ */
+ReedSolomon::ReedSolomon(RSProfile id, uint8_t n, uint8_t nroots) : gf(((uint8_t)id < RS_PROFILES) ? rsProfiles[(uint8_t)id].poly : 0)
+{
+    dual = false;
+    this->n = 0;
+    uint8_t profile = (uint8_t)id;
+    if(profile >= RS_PROFILES)
+        return;
+
+    if(rsProfiles[profile].dual)
+    {
+        //conversion matrix is linear, so the table entries are XORs of matrix rows for set bits
+        uint8_t toDual[256], fromDual[256];
+        for(uint16_t i = 0; i < 256; i++)
+        {
+            uint8_t x = 0;
+            for(uint8_t k = 0; k < 8; k++)
+            {
+                if(i & (1 << k))
+                    x ^= ccsdsDual[7 - k];
+            }
+            toDual[i] = x;
+            fromDual[x] = (uint8_t)i;
+        }
+        for(uint8_t i = 0; i < 16; i++)
+        {
+            dualTable[i] = toDual[i];
+            dualTable[16 + i] = toDual[i << 4];
+            dualTable[32 + i] = fromDual[i];
+            dualTable[48 + i] = fromDual[i << 4];
+        }
+        dual = true;
+    }
+    setup(n ? n : rsProfiles[profile].n, nroots ? nroots : rsProfiles[profile].nroots, rsProfiles[profile].fcr, rsProfiles[profile].prim);
+}
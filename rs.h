@@ -0,0 +1,168 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file rs.h
+* @brief Reed-Solomon error correcting code over GF(2^8)
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef RS_H
+#define RS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "gf2.h"
+
+#define RS_BATCH 64 //number of codewords processed in one syndrome pass
+#define RS_UNCORRECTABLE -1 //decoding failure
+
+#define RS_PROFILES 5 //number of standard code profiles
+
+/**
+ * @brief Standard code profiles
+ *
+ * A scoped enumeration, so that a field polynomial passed as the first constructor argument can never be taken
+ * for a profile number.
+ */
+enum class RSProfile : uint8_t
+{
+	CCSDS = 0, //CCSDS (255,223), polynomial 0x187, fcr 112, prim 11, symbols in Berlekamp's dual basis
+	DVB = 1, //DVB-S/DVB-T (204,188), shortened (255,239), polynomial 0x11d
+	QR = 2, //QR code, polynomial 0x11d, default length is version 1-L (26,19)
+	CIRC_C1 = 3, //CD CIRC inner code (32,28), shortened, polynomial 0x11d
+	CIRC_C2 = 4, //CD CIRC outer code (28,24), shortened, polynomial 0x11d
+};
+
+/**
+ * @brief This class provides systematic Reed-Solomon (n, n-nroots) code correcting up to nroots/2 symbol errors
+ *
+ * Codeword byte 0 is the coefficient of x^(n-1), data comes first, then parity.
+ * Generator polynomial roots are alpha^(prim*(fcr+i)) for i = 0...nroots-1, alpha = 2.
+ * Codes with n < 255 are shortened codes, the missing leading symbols are zero and are never processed.
+ * Codes using dual basis representation accept and return dual basis symbols, conversion is done internally.
+ */
+class ReedSolomon
+{
+public:
+	/**
+	 * @brief Calculate parity
+	 * @param *data n-nroots data bytes
+	 * @param *parity Output nroots parity bytes
+	 */
+	void encode(const uint8_t *data, uint8_t *parity);
+
+	/**
+	 * @brief Correct errors in a codeword
+	 * @param *codeword n bytes, corrected in place
+	 * @return Number of corrected symbols or RS_UNCORRECTABLE
+	 */
+	int16_t decode(uint8_t *codeword);
+
+	/**
+	 * @brief Correct errors in many codewords
+	 * @param *codewords count codewords, n bytes each, corrected in place
+	 * @param count Number of codewords
+	 * @param *result Output number of corrected symbols or RS_UNCORRECTABLE for every codeword, may be nullptr
+	 * @return Number of uncorrectable codewords
+	 * Syndromes of RS_BATCH codewords are computed at once with every SIMD lane holding a different codeword.
+	 * Clean codewords and codewords with a single error are then handled in closed form
+	 * and only the remaining ones go through Berlekamp-Massey decoding.
+	 */
+	size_t decodeBatch(uint8_t *codewords, size_t count, int16_t *result = nullptr);
+
+	/**
+	 * @brief Convert symbols from conventional to dual basis
+	 * @param *src Source symbols
+	 * @param *dst Destination symbols, may be the same as source
+	 * @param len Number of symbols
+	 * Conversion is GF(2)-linear, so it is done with the same nibble table lookups as region multiplication.
+	 * Symbols are copied unchanged if the code does not use dual basis.
+	 */
+	void toDual(const uint8_t *src, uint8_t *dst, size_t len);
+
+	/**
+	 * @brief Convert symbols from dual to conventional basis
+	 * @param *src Source symbols
+	 * @param *dst Destination symbols, may be the same as source
+	 * @param len Number of symbols
+	 */
+	void fromDual(const uint8_t *src, uint8_t *dst, size_t len);
+
+	/**
+	 * @brief Get codeword length
+	 * @return n
+	 */
+	uint8_t getLength(void);
+
+	/**
+	 * @brief Get number of parity symbols
+	 * @return nroots
+	 */
+	uint8_t getParityLength(void);
+
+	/**
+	 * @brief Check if object is initialized
+	 * @return 0 if initialized
+	 */
+	uint8_t isInitialized(void);
+
+	/**
+	 * @brief Initializes Reed-Solomon code
+	 * @param &gf GF(2^8) object, copied
+	 * @param n Codeword length, up to 255
+	 * @param nroots Number of parity symbols, 2...n-1
+	 * @param fcr First consecutive root exponent
+	 * @param prim Root step exponent, coprime with 255
+	 */
+	ReedSolomon(const GF2 &gf, uint8_t n, uint8_t nroots, uint8_t fcr = 0, uint8_t prim = 1);
+
+	/**
+	 * @brief Initializes Reed-Solomon code from standard profile
+	 * @param id Profile (RSProfile::CCSDS, RSProfile::DVB, ...)
+	 * @param n Codeword length for shortened or variable length codes, 0 for profile default
+	 * @param nroots Number of parity symbols, 0 for profile default
+	 */
+	ReedSolomon(RSProfile id, uint8_t n = 0, uint8_t nroots = 0);
+
+private:
+	GF2 gf; //field object
+	uint8_t n; //codeword length, 0 if not initialized
+	uint8_t nroots; //number of parity symbols
+	uint8_t fcr; //first consecutive root exponent
+	uint8_t prim; //root step exponent
+	uint8_t iprim; //inverse of prim modulo 255
+	bool dual; //symbols are in dual basis
+	uint8_t dualTable[64]; //conventional to dual, then dual to conventional conversion tables (see GF2::regionTable())
+	uint8_t alphaTo[256]; //alpha^i
+	uint8_t indexOf[256]; //discrete logarithm, indexOf[0] is unused
+	std::vector<uint8_t> generator; //generator polynomial coefficients, the lowest degree first
+	std::vector<uint8_t> roots; //region tables of generator roots, 32 bytes each
+	std::vector<uint8_t> feedback; //256 x nroots table of feedback*generator products, in encoder register order
+
+	void setup(uint8_t n, uint8_t nroots, uint8_t fcr, uint8_t prim); //precompute tables
+	int16_t decodeConventional(uint8_t *codeword); //decode codeword in conventional basis
+
+	int16_t correct(uint8_t *codeword, const uint8_t *s); //correct codeword with given syndromes
+	int16_t correctSingle(uint8_t *codeword, const uint8_t *s); //closed form for a single error, 0 if not applicable
+	int16_t correctGeneral(uint8_t *codeword, const uint8_t *s); //Berlekamp-Massey, Chien search and Forney
+};
+
+#endif
@@ -0,0 +1,231 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file sim.cpp
+* @brief Monte Carlo simulation of code performance
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "sim.h"
+#include "gfrand.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <math.h>
+#include <string.h>
+
+/**
+ * @brief Draw distance to the next event of a Bernoulli process
+ * @param &random Random generator
+ * @param logq log(1-p), where p is event probability
+ * @return Number of trials without event before the next one
+ */
+static inline uint64_t gap(GFRandom &random, double logq)
+{
+    if(logq == 0.0)
+        return UINT64_MAX; //p = 0
+    //geometric distribution by inversion, u is in (0, 1]
+    double u = (double)((random.next() >> 11) + 1) * (1.0 / 9007199254740992.0);
+    double g = floor(log(u) / logq);
+    return (g >= 1.8e19) ? UINT64_MAX : (uint64_t)g;
+}
+
+/**
+ * @brief Calculate Wilson score interval of a proportion
+ * @param x Number of successes
+ * @param n Number of trials
+ * @param z Normal quantile
+ * @param &low Output lower bound
+ * @param &high Output upper bound
+ */
+void Simulator::wilson(uint64_t x, uint64_t n, double z, double &low, double &high)
+{
+    if(n == 0)
+    {
+        low = 0.0;
+        high = 1.0;
+        return;
+    }
+    double nn = (double)n, p = (double)x / nn, z2 = z * z;
+    double center = (p + z2 / (2.0 * nn)) / (1.0 + z2 / nn);
+    double half = z / (1.0 + z2 / nn) * sqrt(p * (1.0 - p) / nn + z2 / (4.0 * nn * nn));
+    low = (center > half) ? (center - half) : 0.0;
+    high = ((center + half) < 1.0) ? (center + half) : 1.0;
+}
+
+/**
+ * @brief Set stop criteria
+ * @param precision Maximum half-width of frame error rate confidence interval relative to the frame error rate
+ * @param minErrors Minimum number of frame errors
+ * @param maxFrames Maximum number of frames
+ * @param z Normal quantile of the confidence level
+ */
+void Simulator::setStop(double precision, uint64_t minErrors, uint64_t maxFrames, double z)
+{
+    this->precision = precision;
+    this->minErrors = minErrors;
+    this->maxFrames = maxFrames;
+    this->z = z;
+}
+
+/**
+ * @brief Run simulation
+ * @param p Channel parameter, see channel types
+ * @param seed Random seed
+ * @param threads Number of threads, 0 to use all hardware threads
+ * @return Simulation result, all zeros if object is not initialized
+ */
+SimResult Simulator::run(double p, uint64_t seed, unsigned threads)
+{
+    SimResult ret;
+    memset(&ret, 0, sizeof(ret));
+    if(dataLength == 0)
+        return ret;
+    if(threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if(threads == 0)
+        threads = 1;
+    if(p < 0.0)
+        p = 0.0;
+    if(p > 1.0)
+        p = 1.0;
+    double logq = (p < 1.0) ? log1p(-p) : -INFINITY;
+
+    std::mutex lock;
+    bool stop = false;
+    auto start = std::chrono::steady_clock::now();
+
+    auto worker = [&](unsigned thread)
+    {
+        GFRandom random(seed, thread); //every thread has its own stream
+        size_t dataSize = SIM_BATCH * dataLength, codeSize = SIM_BATCH * codeLength;
+        std::vector<uint8_t> data(dataSize), codewords(codeSize), erased(codeSize), decoded(dataSize);
+        while(true)
+        {
+            random.fillGF2(data.data(), dataSize);
+            encoder(data.data(), codewords.data(), SIM_BATCH);
+            memset(erased.data(), 0, codeSize);
+
+            //the channel is memoryless (apart from bursts), so events are placed by drawing distances between them
+            uint64_t limit = (channel == SIM_BSC) ? (8 * (uint64_t)codeSize) : codeSize;
+            uint64_t pos = gap(random, logq);
+            while(pos < limit)
+            {
+                if(channel == SIM_BSC)
+                    codewords[pos >> 3] ^= (uint8_t)(1 << (pos & 7));
+                else if(channel == SIM_ERASURE)
+                {
+                    codewords[pos] = 0;
+                    erased[pos] = 1;
+                }
+                else
+                {
+                    uint64_t end = ((limit - pos) > burst) ? (pos + burst) : limit;
+                    for(; pos < end; pos++)
+                    {
+                        uint8_t e;
+                        random.fillGF2(&e, 1, true);
+                        codewords[pos] ^= e;
+                    }
+                    pos--;
+                }
+                uint64_t g = gap(random, logq);
+                pos = ((limit - pos) > g) ? (pos + 1 + g) : limit;
+            }
+
+            decoder(codewords.data(), erased.data(), decoded.data(), SIM_BATCH);
+
+            uint64_t bitErrors = 0, frameErrors = 0;
+            for(size_t f = 0; f < SIM_BATCH; f++)
+            {
+                uint64_t e = 0;
+                for(size_t i = f * dataLength; i < (f + 1) * dataLength; i++)
+                    e += __builtin_popcount(data[i] ^ decoded[i]);
+                bitErrors += e;
+                frameErrors += (e != 0);
+            }
+
+            std::lock_guard<std::mutex> guard(lock);
+            if(stop)
+                return;
+            ret.frames += SIM_BATCH;
+            ret.frameErrors += frameErrors;
+            ret.bitErrors += bitErrors;
+            if(ret.frames >= maxFrames)
+                stop = true;
+            else if(ret.frameErrors >= minErrors)
+            {
+                double low, high;
+                wilson(ret.frameErrors, ret.frames, z, low, high);
+                if((high - low) <= (2.0 * precision * ret.frameErrors / ret.frames))
+                    stop = true;
+            }
+            if(stop)
+                return;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for(unsigned i = 1; i < threads; i++)
+        workers.emplace_back(worker, i);
+    worker(0);
+    for(size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    ret.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ret.bits = ret.frames * dataLength * 8;
+    ret.fer = (double)ret.frameErrors / ret.frames;
+    ret.ber = (double)ret.bitErrors / ret.bits;
+    wilson(ret.frameErrors, ret.frames, z, ret.ferLow, ret.ferHigh);
+    wilson(ret.bitErrors, ret.bits, z, ret.berLow, ret.berHigh);
+    return ret;
+}
+
+/**
+ * @brief Check if object is initialized
+ * @return 0 if initialized
+ */
+uint8_t Simulator::isInitialized(void)
+{
+    return (dataLength == 0);
+}
+
+/**
+ * @brief Initializes simulator
+ * @param dataLength Data frame length in bytes
+ * @param codeLength Codeword length in bytes
+ * @param encoder Encoder function
+ * @param decoder Decoder function
+ * @param channel Channel type, SIM_BSC, SIM_ERASURE or SIM_BURST
+ * @param burst Burst length in symbols for SIM_BURST
+ */
+Simulator::Simulator(size_t dataLength, size_t codeLength, Encoder encoder, Decoder decoder, uint8_t channel, uint32_t burst)
+    : encoder(encoder), decoder(decoder)
+{
+    this->dataLength = 0;
+    this->codeLength = codeLength;
+    this->channel = channel;
+    this->burst = burst;
+    setStop(0.1);
+    if((dataLength == 0) || (codeLength == 0) || !encoder || !decoder || (channel > SIM_BURST) || (burst == 0))
+        return;
+    this->dataLength = dataLength;
+}
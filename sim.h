@@ -0,0 +1,136 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file sim.h
+* @brief Monte Carlo simulation of code performance
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+
+#define SIM_BSC 0 //binary symmetric channel, every bit is flipped with probability p
+#define SIM_ERASURE 1 //erasure channel, every symbol (byte) is erased with probability p
+#define SIM_BURST 2 //burst channel, a burst of corrupted symbols starts at every symbol with probability p
+
+#define SIM_BATCH 256 //number of frames passed to encoder and decoder at once
+#define SIM_Z95 1.959964 //normal quantile for 95% confidence intervals
+#define SIM_MAX_FRAMES 1000000000ULL //default frame limit
+
+/**
+ * @brief Simulation result
+ */
+struct SimResult
+{
+	uint64_t frames; //number of simulated frames
+	uint64_t frameErrors; //number of frames with at least one wrong data bit after decoding
+	uint64_t bits; //number of simulated data bits
+	uint64_t bitErrors; //number of wrong data bits after decoding
+	double fer; //frame error rate
+	double ferLow, ferHigh; //confidence interval of frame error rate
+	double ber; //bit error rate
+	double berLow, berHigh; //confidence interval of bit error rate, assuming independent bit errors
+	double seconds; //simulation time
+};
+
+/**
+ * @brief This class provides multithreaded Monte Carlo simulation of bit and frame error rates of any code
+ *
+ * Every thread draws random frames from its own GFRandom stream, encodes and decodes them in batches
+ * of SIM_BATCH frames using the supplied functions and passes them through the channel in between.
+ * Counters are merged after every batch and the simulation stops when the frame error rate is known
+ * with the requested precision (Wilson score interval), or when the frame limit is reached.
+ * Encoder and decoder are called concurrently from all threads, so they must not modify any shared state.
+ */
+class Simulator
+{
+public:
+	/**
+	 * @brief Encoder function
+	 * @param *data count data frames, dataLength bytes each
+	 * @param *codewords Output count codewords, codeLength bytes each
+	 * @param count Number of frames
+	 */
+	typedef std::function<void(const uint8_t *data, uint8_t *codewords, size_t count)> Encoder;
+
+	/**
+	 * @brief Decoder function
+	 * @param *codewords count received codewords, codeLength bytes each, may be modified
+	 * @param *erased Erasure flags of all codeword symbols, non-zero if symbol is erased (and set to 0)
+	 * @param *data Output count decoded data frames, dataLength bytes each
+	 * @param count Number of frames
+	 */
+	typedef std::function<void(uint8_t *codewords, const uint8_t *erased, uint8_t *data, size_t count)> Decoder;
+
+	/**
+	 * @brief Set stop criteria
+	 * @param precision Maximum half-width of frame error rate confidence interval relative to the frame error rate
+	 * @param minErrors Minimum number of frame errors
+	 * @param maxFrames Maximum number of frames
+	 * @param z Normal quantile of the confidence level
+	 */
+	void setStop(double precision, uint64_t minErrors = 100, uint64_t maxFrames = SIM_MAX_FRAMES, double z = SIM_Z95);
+
+	/**
+	 * @brief Run simulation
+	 * @param p Channel parameter, see channel types
+	 * @param seed Random seed
+	 * @param threads Number of threads, 0 to use all hardware threads
+	 * @return Simulation result, all zeros if object is not initialized
+	 */
+	SimResult run(double p, uint64_t seed = 1, unsigned threads = 0);
+
+	/**
+	 * @brief Check if object is initialized
+	 * @return 0 if initialized
+	 */
+	uint8_t isInitialized(void);
+
+	/**
+	 * @brief Initializes simulator
+	 * @param dataLength Data frame length in bytes
+	 * @param codeLength Codeword length in bytes
+	 * @param encoder Encoder function
+	 * @param decoder Decoder function
+	 * @param channel Channel type, SIM_BSC, SIM_ERASURE or SIM_BURST
+	 * @param burst Burst length in symbols for SIM_BURST, every symbol in burst is XORed with a random non-zero byte
+	 */
+	Simulator(size_t dataLength, size_t codeLength, Encoder encoder, Decoder decoder, uint8_t channel = SIM_BSC, uint32_t burst = 8);
+
+private:
+	size_t dataLength; //data frame length, 0 if not initialized
+	size_t codeLength; //codeword length
+	Encoder encoder; //encoder function
+	Decoder decoder; //decoder function
+	uint8_t channel; //channel type
+	uint32_t burst; //burst length
+	double precision; //relative confidence interval half-width
+	uint64_t minErrors; //minimum number of frame errors
+	uint64_t maxFrames; //maximum number of frames
+	double z; //normal quantile
+
+	static void wilson(uint64_t x, uint64_t n, double z, double &low, double &high); //Wilson score interval
+};
+
+#endif
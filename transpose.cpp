@@ -0,0 +1,368 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file transpose.cpp
+* @brief Matrix transposition kernels for converting between interleaved and shard-major layouts
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#include "transpose.h"
+#include <vector>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define TRANSPOSE_SSE2
+#endif
+
+#if defined(__GNUC__)
+#define TRANSPOSE_UNROLL _Pragma("GCC unroll 16") //keep whole tiles in registers
+#else
+#define TRANSPOSE_UNROLL
+#endif
+
+#define TRANSPOSE_TILE8 16 //byte tile size
+#define TRANSPOSE_TILE16 8 //word tile size
+
+#ifdef TRANSPOSE_SSE2
+/**
+ * @brief Transpose 16x16 byte tile in registers
+ * @param *r 16 rows, replaced with 16 columns
+ * Every round interleaves rows i and i+8, which rotates the 4 bits of row index into column index.
+ */
+static inline void tile8(__m128i *r)
+{
+    __m128i t[16];
+    TRANSPOSE_UNROLL
+    for(uint8_t round = 0; round < 4; round++)
+    {
+        TRANSPOSE_UNROLL
+        for(uint8_t i = 0; i < 8; i++)
+        {
+            t[2 * i] = _mm_unpacklo_epi8(r[i], r[i + 8]);
+            t[2 * i + 1] = _mm_unpackhi_epi8(r[i], r[i + 8]);
+        }
+        TRANSPOSE_UNROLL
+        for(uint8_t i = 0; i < 16; i++)
+            r[i] = t[i];
+    }
+}
+
+/**
+ * @brief Transpose 8x8 word tile in registers
+ * @param *r 8 rows, replaced with 8 columns
+ */
+static inline void tile16(__m128i *r)
+{
+    __m128i t[8];
+    TRANSPOSE_UNROLL
+    for(uint8_t round = 0; round < 3; round++)
+    {
+        TRANSPOSE_UNROLL
+        for(uint8_t i = 0; i < 4; i++)
+        {
+            t[2 * i] = _mm_unpacklo_epi16(r[i], r[i + 4]);
+            t[2 * i + 1] = _mm_unpackhi_epi16(r[i], r[i + 4]);
+        }
+        TRANSPOSE_UNROLL
+        for(uint8_t i = 0; i < 8; i++)
+            r[i] = t[i];
+    }
+}
+
+/**
+ * @brief Transpose one tile
+ * @param *src Source tile
+ * @param srcStride Source row stride in elements
+ * @param *dst Destination tile
+ * @param dstStride Destination row stride in elements
+ */
+static inline void tile(const uint8_t *src, size_t srcStride, uint8_t *dst, size_t dstStride)
+{
+    __m128i r[TRANSPOSE_TILE8];
+    TRANSPOSE_UNROLL
+    for(uint8_t i = 0; i < TRANSPOSE_TILE8; i++)
+        r[i] = _mm_loadu_si128((const __m128i*)(src + i * srcStride));
+    tile8(r);
+    TRANSPOSE_UNROLL
+    for(uint8_t i = 0; i < TRANSPOSE_TILE8; i++)
+        _mm_storeu_si128((__m128i*)(dst + i * dstStride), r[i]);
+}
+
+static inline void tile(const uint16_t *src, size_t srcStride, uint16_t *dst, size_t dstStride)
+{
+    __m128i r[TRANSPOSE_TILE16];
+    TRANSPOSE_UNROLL
+    for(uint8_t i = 0; i < TRANSPOSE_TILE16; i++)
+        r[i] = _mm_loadu_si128((const __m128i*)(src + i * srcStride));
+    tile16(r);
+    TRANSPOSE_UNROLL
+    for(uint8_t i = 0; i < TRANSPOSE_TILE16; i++)
+        _mm_storeu_si128((__m128i*)(dst + i * dstStride), r[i]);
+}
+
+/**
+ * @brief Swap and transpose two tiles, or transpose a diagonal tile in place
+ * @param *a First tile
+ * @param *b Second tile, may be the same as the first one
+ * @param stride Row stride in elements
+ */
+static inline void swapTile(uint8_t *a, uint8_t *b, size_t stride)
+{
+    __m128i x[TRANSPOSE_TILE8], y[TRANSPOSE_TILE8];
+    TRANSPOSE_UNROLL
+    for(uint8_t i = 0; i < TRANSPOSE_TILE8; i++)
+    {
+        x[i] = _mm_loadu_si128((const __m128i*)(a + i * stride));
+        y[i] = _mm_loadu_si128((const __m128i*)(b + i * stride));
+    }
+    tile8(x);
+    tile8(y);
+    TRANSPOSE_UNROLL
+    for(uint8_t i = 0; i < TRANSPOSE_TILE8; i++)
+    {
+        _mm_storeu_si128((__m128i*)(a + i * stride), y[i]);
+        _mm_storeu_si128((__m128i*)(b + i * stride), x[i]);
+    }
+}
+
+static inline void swapTile(uint16_t *a, uint16_t *b, size_t stride)
+{
+    __m128i x[TRANSPOSE_TILE16], y[TRANSPOSE_TILE16];
+    TRANSPOSE_UNROLL
+    for(uint8_t i = 0; i < TRANSPOSE_TILE16; i++)
+    {
+        x[i] = _mm_loadu_si128((const __m128i*)(a + i * stride));
+        y[i] = _mm_loadu_si128((const __m128i*)(b + i * stride));
+    }
+    tile16(x);
+    tile16(y);
+    TRANSPOSE_UNROLL
+    for(uint8_t i = 0; i < TRANSPOSE_TILE16; i++)
+    {
+        _mm_storeu_si128((__m128i*)(a + i * stride), y[i]);
+        _mm_storeu_si128((__m128i*)(b + i * stride), x[i]);
+    }
+}
+#else
+template <typename T, size_t B> static inline void tileScalar(const T *src, size_t srcStride, T *dst, size_t dstStride)
+{
+    for(size_t i = 0; i < B; i++)
+    {
+        for(size_t j = 0; j < B; j++)
+            dst[j * dstStride + i] = src[i * srcStride + j];
+    }
+}
+
+static inline void tile(const uint8_t *src, size_t srcStride, uint8_t *dst, size_t dstStride)
+{
+    tileScalar<uint8_t, TRANSPOSE_TILE8>(src, srcStride, dst, dstStride);
+}
+
+static inline void tile(const uint16_t *src, size_t srcStride, uint16_t *dst, size_t dstStride)
+{
+    tileScalar<uint16_t, TRANSPOSE_TILE16>(src, srcStride, dst, dstStride);
+}
+
+template <typename T, size_t B> static inline void swapTileScalar(T *a, T *b, size_t stride)
+{
+    for(size_t i = 0; i < B; i++)
+    {
+        for(size_t j = ((a == b) ? (i + 1) : 0); j < B; j++)
+        {
+            T t = a[i * stride + j];
+            a[i * stride + j] = b[j * stride + i];
+            b[j * stride + i] = t;
+        }
+    }
+}
+
+static inline void swapTile(uint8_t *a, uint8_t *b, size_t stride)
+{
+    swapTileScalar<uint8_t, TRANSPOSE_TILE8>(a, b, stride);
+}
+
+static inline void swapTile(uint16_t *a, uint16_t *b, size_t stride)
+{
+    swapTileScalar<uint16_t, TRANSPOSE_TILE16>(a, b, stride);
+}
+#endif
+
+/**
+ * @brief Transpose partial tile through a local buffer
+ * @param h Number of source rows, up to B
+ * @param w Number of source columns, up to B
+ * @param limit Number of source elements that can be read from the tile start
+ */
+template <typename T, size_t B> static inline void partialTile(const T *src, size_t srcStride, T *dst, size_t dstStride, size_t h, size_t w, size_t limit)
+{
+    //short pieces are copied element by element, as library calls would cost more than the transposition itself
+    T in[B * B], out[B * B];
+    for(size_t i = 0; i < B; i++)
+    {
+        if((i < h) && ((i * srcStride + B) <= limit))
+            memcpy(in + i * B, src + i * srcStride, B * sizeof(T)); //whole row stays within the matrix, extra columns are not stored
+        else
+        {
+            memset(in + i * B, 0, B * sizeof(T));
+            if(i < h)
+            {
+                for(size_t j = 0; j < w; j++)
+                    in[i * B + j] = src[i * srcStride + j];
+            }
+        }
+    }
+    tile(in, B, out, B);
+    for(size_t j = 0; j < w; j++)
+    {
+        if(h == B)
+            memcpy(dst + j * dstStride, out + j * B, B * sizeof(T));
+        else
+        {
+            for(size_t i = 0; i < h; i++)
+                dst[j * dstStride + i] = out[j * B + i];
+        }
+    }
+}
+
+/**
+ * @brief Transpose matrix out of place using tiles of B x B elements
+ */
+template <typename T, size_t B> static void transpose(const T *src, size_t srcStride, T *dst, size_t dstStride, size_t rows, size_t cols)
+{
+    if((rows == 0) || (cols == 0))
+        return;
+
+    //edges go through a local buffer, so that narrow matrices (few shards) are still transposed in registers
+    size_t total = (rows - 1) * srcStride + cols;
+    for(size_t r = 0; r < rows; r += B)
+    {
+        size_t h = ((rows - r) < B) ? (rows - r) : B;
+        for(size_t c = 0; c < cols; c += B)
+        {
+            size_t w = ((cols - c) < B) ? (cols - c) : B;
+            const T *s = src + r * srcStride + c;
+            if((h == B) && (w == B))
+                tile(s, srcStride, dst + c * dstStride + r, dstStride);
+            else
+                partialTile<T, B>(s, srcStride, dst + c * dstStride + r, dstStride, h, w, total - (r * srcStride + c));
+        }
+    }
+}
+
+/**
+ * @brief Transpose dense matrix in place
+ */
+template <typename T, size_t B> static void transposeInPlace(T *a, size_t rows, size_t cols)
+{
+    if((rows < 2) || (cols < 2))
+        return; //vector, the memory layout does not change
+
+    if(rows == cols)
+    {
+        size_t n = rows, full = n - (n % B);
+        for(size_t i = 0; i < full; i += B)
+        {
+            for(size_t j = i; j < full; j += B)
+                swapTile(a + i * n + j, a + j * n + i, n);
+        }
+        //edge strip
+        for(size_t i = 0; i < n; i++)
+        {
+            for(size_t j = ((i < full) ? full : (i + 1)); j < n; j++)
+            {
+                T t = a[i * n + j];
+                a[i * n + j] = a[j * n + i];
+                a[j * n + i] = t;
+            }
+        }
+        return;
+    }
+
+    //element (r, c) at position p = r*cols + c moves to c*rows + r, the first and the last element stay in place
+    size_t last = rows * cols - 1;
+    std::vector<uint64_t> visited((last + 64) / 64, 0);
+    for(size_t start = 1; start < last; start++)
+    {
+        if(visited[start >> 6] & (1ULL << (start & 63)))
+            continue;
+        T carry = a[start];
+        size_t p = start;
+        do
+        {
+            size_t next = (p % cols) * rows + p / cols;
+            T t = a[next];
+            a[next] = carry;
+            carry = t;
+            visited[next >> 6] |= 1ULL << (next & 63);
+            p = next;
+        } while(p != start);
+    }
+}
+
+/**
+ * @brief Transpose byte matrix out of place
+ * @param *src Source matrix
+ * @param srcStride Source row stride, at least cols
+ * @param *dst Destination matrix, cols x rows, must not overlap source
+ * @param dstStride Destination row stride, at least rows
+ * @param rows Number of source rows
+ * @param cols Number of source columns
+ */
+void Transpose::bytes(const uint8_t *src, size_t srcStride, uint8_t *dst, size_t dstStride, size_t rows, size_t cols)
+{
+    transpose<uint8_t, TRANSPOSE_TILE8>(src, srcStride, dst, dstStride, rows, cols);
+}
+
+/**
+ * @brief Transpose 16-bit word matrix out of place
+ * @param *src Source matrix
+ * @param srcStride Source row stride, at least cols
+ * @param *dst Destination matrix, cols x rows, must not overlap source
+ * @param dstStride Destination row stride, at least rows
+ * @param rows Number of source rows
+ * @param cols Number of source columns
+ */
+void Transpose::words(const uint16_t *src, size_t srcStride, uint16_t *dst, size_t dstStride, size_t rows, size_t cols)
+{
+    transpose<uint16_t, TRANSPOSE_TILE16>(src, srcStride, dst, dstStride, rows, cols);
+}
+
+/**
+ * @brief Transpose densely stored byte matrix in place
+ * @param *a Matrix, rows x cols on input, cols x rows on output
+ * @param rows Number of rows
+ * @param cols Number of columns
+ */
+void Transpose::bytesInPlace(uint8_t *a, size_t rows, size_t cols)
+{
+    transposeInPlace<uint8_t, TRANSPOSE_TILE8>(a, rows, cols);
+}
+
+/**
+ * @brief Transpose densely stored 16-bit word matrix in place
+ * @param *a Matrix, rows x cols on input, cols x rows on output
+ * @param rows Number of rows
+ * @param cols Number of columns
+ */
+void Transpose::wordsInPlace(uint16_t *a, size_t rows, size_t cols)
+{
+    transposeInPlace<uint16_t, TRANSPOSE_TILE16>(a, rows, cols);
+}
@@ -0,0 +1,84 @@
+/*
+    This file is part of simple Galois field library.
+
+    This is a free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    It is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+* @file transpose.h
+* @brief Matrix transposition kernels for converting between interleaved and shard-major layouts
+* @version 1.1
+* @author Piotr Wilkon <sq8vps@gmail.com>
+* @copyright Copyright 2021 Piotr Wilkon, licensed under GNU GPLv3
+**/
+
+#ifndef TRANSPOSE_H
+#define TRANSPOSE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief This class provides transposition of row-major byte and 16-bit word matrices
+ *
+ * Interleaved (codeword-major) data is a len x n matrix, while shard-major data is an n x len matrix,
+ * so converting between them is a transposition. Matrices are processed in 16x16 byte or 8x8 word tiles,
+ * which are transposed in SIMD registers.
+ * Strides are given in elements and allow transposing a part of a wider matrix.
+ */
+class Transpose
+{
+public:
+	/**
+	 * @brief Transpose byte matrix out of place
+	 * @param *src Source matrix
+	 * @param srcStride Source row stride, at least cols
+	 * @param *dst Destination matrix, cols x rows, must not overlap source
+	 * @param dstStride Destination row stride, at least rows
+	 * @param rows Number of source rows
+	 * @param cols Number of source columns
+	 */
+	static void bytes(const uint8_t *src, size_t srcStride, uint8_t *dst, size_t dstStride, size_t rows, size_t cols);
+
+	/**
+	 * @brief Transpose 16-bit word matrix out of place
+	 * @param *src Source matrix
+	 * @param srcStride Source row stride, at least cols
+	 * @param *dst Destination matrix, cols x rows, must not overlap source
+	 * @param dstStride Destination row stride, at least rows
+	 * @param rows Number of source rows
+	 * @param cols Number of source columns
+	 */
+	static void words(const uint16_t *src, size_t srcStride, uint16_t *dst, size_t dstStride, size_t rows, size_t cols);
+
+	/**
+	 * @brief Transpose densely stored byte matrix in place
+	 * @param *a Matrix, rows x cols on input, cols x rows on output
+	 * @param rows Number of rows
+	 * @param cols Number of columns
+	 * Square matrices are transposed by swapping tiles. Other matrices are permuted by following cycles,
+	 * which needs only rows*cols bits of extra memory, but is much slower than out-of-place transposition.
+	 */
+	static void bytesInPlace(uint8_t *a, size_t rows, size_t cols);
+
+	/**
+	 * @brief Transpose densely stored 16-bit word matrix in place
+	 * @param *a Matrix, rows x cols on input, cols x rows on output
+	 * @param rows Number of rows
+	 * @param cols Number of columns
+	 */
+	static void wordsInPlace(uint16_t *a, size_t rows, size_t cols);
+};
+
+#endif